@@ -0,0 +1,124 @@
+#ifndef ACUTE_BASELINE_H
+#define ACUTE_BASELINE_H
+
+/**
+ * @file AcuteBaseline.h
+ * @brief 短期异常 (卡滞) 的自适应基准
+ * @details 位置单位是“下降满速时间”，所以一次归零的期望耗时 = 起点位置 × 上升耗时比。
+ *          按 方向 × 起点区间 维护该比值的 EWMA 均值与方差，
+ *          阈值 = 行程 × (均值 + K·σ) + 余量，在运行开始时算好，
+ *          update() 里只剩一次整数比较。样本不足时退回原来的固定上限；
+ *          下降方向不学习，按行程直接估 (位置单位本身就是下降耗时)。
+ *          均值/方差用定点数 (Q16 / Q24)，系数在编译期换算。
+ */
+
+#include <Arduino.h>
+#include "Config.h"
+#include "FixedPoint.h"
+
+#define BASELINE_DIRECTIONS 2     // 0 = 上升, 1 = 下降
+#define BASELINE_POS_BUCKETS 4    // 起点按 MAX_SAFE_POSITION_MS 均分
+
+class AcuteBaseline {
+private:
+    struct Cell {
+        Q16 mean;        // 耗时 / 行程
+        Q24 variance;    // 比值的方差很小 (σ 约 0.01)，多留小数位
+        uint16_t samples;
+    };
+
+    Cell _cells[BASELINE_DIRECTIONS][BASELINE_POS_BUCKETS];
+    long _limitMs = 0; // 当前这次运行的阈值
+
+    static constexpr Q16 ALPHA = Q16::fromConst(ACUTE_EWMA_ALPHA);
+    static constexpr Q16 SIGMA_K = Q16::fromConst(ACUTE_SIGMA_K);
+
+    static int directionIndex(int direction) { return direction < 0 ? 0 : 1; }
+
+    static int bucketOf(long startPositionMs) {
+        if (startPositionMs < 0) return BASELINE_POS_BUCKETS - 1; // 未知：按最远处理
+        long b = startPositionMs * BASELINE_POS_BUCKETS / (long)MAX_SAFE_POSITION_MS;
+        return b >= BASELINE_POS_BUCKETS ? BASELINE_POS_BUCKETS - 1 : (int)b;
+    }
+
+    // 固定上限：原 BASELINE_DURATION × 1.3
+    static long fallbackLimit() {
+        return (long)(MAINTENANCE_BASELINE_MS * ACUTE_THRESHOLD_RATIO);
+    }
+
+public:
+    void begin() {
+        memset(_cells, 0, sizeof(_cells));
+        _limitMs = fallbackLimit();
+    }
+
+    /**
+     * @brief 用历史全程平均耗时给上升方向的所有区间一个初值
+     */
+    void seed(Q8 meanFullRunMs, uint32_t runs) {
+        if (runs == 0 || meanFullRunMs.raw <= 0) return;
+        Q16 ratio = Q16::ratio(meanFullRunMs.raw, (int64_t)TIME_TO_BOTTOM_MS << Q8::FRAC_BITS);
+        for (int b = 0; b < BASELINE_POS_BUCKETS; b++) {
+            Cell& c = _cells[0][b];
+            c.mean = ratio;
+            c.variance = Q24();
+            c.samples = runs > ACUTE_MIN_SAMPLES ? ACUTE_MIN_SAMPLES : runs;
+        }
+    }
+
+    /**
+     * @brief 学习一次有真实终点的运行 (目前只有上升撞顶)
+     * @param direction -1 上升, +1 下降
+     * @param distanceMs 行程 (位置单位)
+     * @param durationMs 实际耗时
+     */
+    void learn(int direction, long startPositionMs, long distanceMs, long durationMs) {
+        if (distanceMs < ACUTE_MIN_DISTANCE_MS) return; // 行程太短，比值噪声太大
+        Cell& c = _cells[directionIndex(direction)][bucketOf(startPositionMs)];
+        Q16 ratio = Q16::ratio(durationMs, distanceMs);
+
+        if (c.samples == 0) {
+            c.mean = ratio;
+            c.variance = Q24();
+        } else {
+            // 增量 EWMA 均值/方差
+            Q16 diff = ratio - c.mean;
+            Q16 incr = ALPHA * diff;
+            c.mean += incr;
+            c.variance = fixedMul<24>(Q16::fromInt(1) - ALPHA, c.variance + fixedMul<24>(diff, incr));
+        }
+        if (c.samples < 0xFFFF) c.samples++;
+    }
+
+    /**
+     * @brief 运行开始时计算本次阈值
+     * @param startPositionMs 起点，-1 表示未知
+     * @param distanceMs 预计行程
+     */
+    void beginRun(int direction, long startPositionMs, long distanceMs) {
+        const Cell& c = _cells[directionIndex(direction)][bucketOf(startPositionMs)];
+        if (startPositionMs < 0) {
+            _limitMs = fallbackLimit();
+            return;
+        }
+        if (c.samples < ACUTE_MIN_SAMPLES) {
+            // 下降没有学习样本，但位置单位就是下降满速时间：按行程估，另加减速段的慢行
+            long limit = direction > 0
+                ? (long)(distanceMs * ACUTE_THRESHOLD_RATIO) + ACUTE_MARGIN_MS + (long)RAMP_DECEL_MS
+                : fallbackLimit();
+            _limitMs = limit < fallbackLimit() ? limit : fallbackLimit();
+            return;
+        }
+        Q16 ratio = c.mean + SIGMA_K * c.variance.sqrt<16>();
+        long limit = (long)ratio.scale(distanceMs) + ACUTE_MARGIN_MS;
+        // 自适应阈值只会更严格，不会比固定上限宽松
+        _limitMs = limit < fallbackLimit() ? limit : fallbackLimit();
+    }
+
+    // O(1)：每个控制周期调用
+    bool isExceeded(long elapsedMs) const { return elapsedMs > _limitMs; }
+
+    long getLimitMs() const { return _limitMs; }
+};
+
+#endif
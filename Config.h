@@ -10,10 +10,39 @@
 #define PIN_MOTOR_RPWM    18  // 对应用户代码的 RPWM_PIN (Up)
 #define PIN_MOTOR_LPWM    19  // 对应用户代码的 LPWM_PIN (Down)
 
+// BTS7960 电流检测输出 (R_IS / L_IS)，必须接 ADC1 (ADC2 与 Wi-Fi 冲突)
+#define PIN_MOTOR_R_IS    34
+#define PIN_MOTOR_L_IS    35
+
+// 电流采样 (MotorCurrentFilter.h)：ADC 连续模式 (DMA) 交替采两路 IS，
+// 每块 CURRENT_BLOCK_SAMPLES 个样本 (约 5ms) 在电流任务里算 RMS / 峰值，不占控制任务
+const uint32_t CURRENT_SAMPLE_RATE_HZ  = 25600; // 两路合计
+const uint32_t CURRENT_BLOCK_SAMPLES   = 128;
+const uint32_t CURRENT_ADC_FULL_SCALE_MV = 3100; // 12dB 衰减下的满量程 (近似线性换算)
+const uint32_t CURRENT_SENSE_RATIO     = 8500;   // BTS7960 k_ILIS：负载电流 / IS 电流
+const uint32_t CURRENT_SENSE_RESISTOR_OHM = 1000; // IS 对地电阻
+const uint32_t CURRENT_STALL_MA        = 12000;  // RMS 超过该值视为堵转/过流
+const uint8_t  CURRENT_STALL_BLOCKS    = 4;      // 连续超限多少块才判定 (约 20ms)
+const unsigned long CURRENT_INRUSH_BLANK_MS = 300; // 启动冲击电流的屏蔽时间
+const unsigned long CURRENT_STALE_MS   = 50;     // 超过该时间没有新块，结果作废
+const int CURRENT_TASK_PRIORITY        = 3;      // 电流任务与网络任务同在 PRO 核，优先级更高
+
 // Ultrasonic Sensor (HC-SR04)
 #define PIN_ULTRASONIC_TRIG  27
 #define PIN_ULTRASONIC_ECHO  26
 
+// 超声波异步测距参数：定时器发 Trig，中断测 Echo 脉宽
+const unsigned long ULTRASONIC_PERIOD_US       = 60000; // 测量周期 (HC-SR04 建议 >= 60ms)
+const unsigned long ULTRASONIC_ECHO_TIMEOUT_US = 6000;  // 脉宽上限 (~100cm)，超出视为无回波
+const unsigned long ULTRASONIC_STALE_MS        = 200;   // 超过该时间没有新回波，结果作废
+
+// 超声波信号处理 (UltrasonicFilter.h)
+const int32_t ULTRASONIC_OUTLIER_MM        = 80;   // 与中值偏差超过该值视为离群
+const int32_t ULTRASONIC_MAX_SPEED_MM_S    = 500;  // 物理上不可能更快的距离变化率
+const uint8_t ULTRASONIC_MIN_CONFIDENCE    = 50;   // 低于该置信度不判断到顶
+const uint8_t ULTRASONIC_FAR_CYCLES        = 2;    // 连续超量程多少次判定为“远”
+const uint8_t ULTRASONIC_DEAD_CYCLES       = 5;    // 连续无回波多少次判定为传感器故障
+
 // ==========================
 // 2. 机械参数 (Mechanical Params)
 // ==========================
@@ -27,12 +56,76 @@ const unsigned long TIME_TO_BOTTOM_MS = 150*1000; // 顶层 -> 底层 (虚拟底
 // 既然绳子有5-6米，设为 70000ms 比较安全 (比正常行程 60000ms 大)
 const unsigned long MAX_SAFE_POSITION_MS = 160*1000; 
 
+// 运动计时定时器周期：位置积分与到位停机都在该定时器里完成，与 loop() 频率无关
+const unsigned long MOTION_TIMER_PERIOD_US = 500;
+
 // ==========================
 // 3. 速度控制 (PWM)
 // ==========================
 const int PWM_SPEED_UP   = 200; // 0-255，上升通常需要更大扭矩
 const int PWM_SPEED_DOWN = 150; // 下降利用重力，速度可以小一点
 
+// 速度曲线 (MotionProfile.h)：软启动从 MIN_MOTOR_SPEED 升到巡航 PWM，
+// 距目标 RAMP_DECEL_MS (位置单位) 内降到接近速度，停层更准
+const int PWM_APPROACH_UP   = 120;
+const int PWM_APPROACH_DOWN = 100;
+const unsigned long RAMP_ACCEL_MS = 1500; // 加速段时长
+const unsigned long RAMP_DECEL_MS = 3000; // 减速段长度 (位置，ms)
+const int MOTOR_PWM_DEADBAND = 40;        // 低于该 PWM 电机基本不转，用于折算斜坡段位移
+
+// ==========================
+// 3.2 楼层表 (FloorTable.h)
+// ==========================
+// 从顶到底排列，下标即楼层编号；顶层必须是位置 0 (由顶部传感器停准)。
+// 单调性、安全上限和 PWM 范围都在编译期检查。
+enum FloorId : uint8_t {
+    FLOOR_TOP,
+    FLOOR_MIDDLE,
+    FLOOR_BOTTOM,       // 虚拟底部
+    FLOOR_COUNT
+};
+
+struct FloorSpec {
+    const char* name;
+    unsigned long positionMs;   // 距顶部的位置 (下降标称速度下的运行时间)
+    int approachPwmUp;          // 从下方接近该层时减速到的 PWM
+    int approachPwmDown;        // 从上方接近该层时减速到的 PWM
+    unsigned long toleranceMs;  // 与该层相差小于此值视为已到达
+    uint8_t blynkPin;           // APP 中对应的按钮虚拟引脚
+};
+
+constexpr FloorSpec FLOOR_TABLE[] = {
+    // name      position           approach up      approach down      tol  pin
+    { "Top",    0,                 PWM_APPROACH_UP, PWM_APPROACH_DOWN, 200, 23 },
+    { "Middle", TIME_TO_MIDDLE_MS, PWM_APPROACH_UP, PWM_APPROACH_DOWN, 200, 22 },
+    { "Bottom", TIME_TO_BOTTOM_MS, PWM_APPROACH_UP, PWM_APPROACH_DOWN, 200, 21 },
+};
+
+// ==========================
+// 3.1 仿真模式 (Simulation)
+// ==========================
+// 置 1 时用 hardware_sim.cpp 中的物理模型替代真实驱动：
+// 电机/绳索按 PWM 与负载积分位置，超声波距离由模型合成并叠加噪声。
+// 可在没有升降机台架的开发板上跑完整的状态机、调度与维护逻辑。
+// 主机仿真 (sim/Makefile) 在编译命令里置 1，同一个模型跑在虚拟时钟上。
+#ifndef USE_SIMULATED_HARDWARE
+#define USE_SIMULATED_HARDWARE 0
+#endif
+
+const unsigned long SIM_TICK_US      = 1000;   // 模型积分周期 (仿真定时器)
+
+const float SIM_TRAVEL_CM            = 500.0f; // 顶 -> 绳子放尽的行程
+const float SIM_TOP_GAP_CM           = 40.0f;  // 位于顶部时传感器读数
+const float SIM_FULL_SPEED_CM_S      = 4.0f;   // PWM 255、空载时的速度
+const int   SIM_PWM_DEADBAND         = 40;     // 低于该 PWM 电机不转
+const float SIM_LOAD_KG              = 0.0f;   // 模拟负载
+const float SIM_UP_SLOWDOWN_PER_KG   = 0.02f;  // 负载每 kg 使上升变慢的比例
+const float SIM_DOWN_SPEEDUP_PER_KG  = 0.01f;  // 负载每 kg 使下降变快的比例
+const float SIM_SENSOR_NOISE_CM      = 1.0f;   // 超声波读数噪声幅度 (±)
+const uint32_t SIM_CURRENT_NOLOAD_MA = 1500;   // PWM 255、空载时的电流
+const uint32_t SIM_CURRENT_PER_KG_MA = 150;    // 负载每 kg 增加的电流
+const uint32_t SIM_CURRENT_STALL_MA  = 20000;  // 堵转电流 (串口 'x' 模拟卡死)
+
 // 4. 系统状态枚举
 enum SystemState {
     STATE_IDLE,             // 待机
@@ -40,7 +133,8 @@ enum SystemState {
     STATE_MOVING_UP,        // 正常上升
     STATE_MOVING_DOWN,      // 正常下降
     STATE_ERROR,            // 故障/急停
-    STATE_POS_UNKNOWN       // 位置未知（刚开机，必须先归零）
+    STATE_POS_UNKNOWN,      // 位置未知（刚开机，必须先归零）
+    STATE_COUNT             // 状态个数 (转移表的大小)，不是一个状态
 };
 
 // ==========================
@@ -49,6 +143,115 @@ enum SystemState {
 // 维护基准时间 (平均上升时间) - 用于短期异常检测
 // 暂时设为 TIME_TO_BOTTOM_MS (最坏情况), 实际应更短
 const unsigned long MAINTENANCE_BASELINE_MS = TIME_TO_BOTTOM_MS;
+const float ACUTE_THRESHOLD_RATIO = 1.3f; // 固定上限: 基准 +30% (样本不足时使用)
+
+// 自适应基准 (AcuteBaseline.h)：按起点学习“耗时/行程”比
+constexpr float ACUTE_EWMA_ALPHA    = 0.2f;  // EWMA 平滑系数
+constexpr float ACUTE_SIGMA_K       = 4.0f;  // 阈值 = 均值 + K·σ
+const long  ACUTE_MARGIN_MS         = 3000;  // 额外余量，吸收启动/停止的固定开销
+const uint16_t ACUTE_MIN_SAMPLES    = 3;     // 少于该样本数时退回固定上限
+const long  ACUTE_MIN_DISTANCE_MS   = 5000;  // 行程太短的运行不参与学习
+
+// 行程进度检查 (ProgressMonitor.h)：期望位置与超声波 / 顶部传感器实测位置的偏差
+const long  PROGRESS_TOLERANCE_MS       = 2000;  // 允许的偏差 (位置单位 ms)
+constexpr float PROGRESS_TOLERANCE_RATIO = 0.25f; // 另按已走行程放宽 (速度比未学好、负载变化)
+constexpr float PROGRESS_TOLERANCE_RATIO_UP = 0.1f; // 上升、速度比已学到：只剩速度比本身的误差
+                                                    // (学到的比值随起点远近差几个百分点)
+constexpr float PROGRESS_TOLERANCE_RATIO_UNLEARNED = 1.0f; // 上升、速度比还没学到：按标称 1.0 积分，
+                                                           // 实际在 RATE_MIN..RATE_MAX 之间，最多差一倍
+const unsigned long PROGRESS_CONFIRM_MS = 500;   // 持续超限多久才判定卡滞
+const int32_t PROGRESS_MIN_SPAN_MM      = 150;   // 学习 mm -> ms 比例需要的最小读数跨度
+const uint16_t PROGRESS_ANCHOR_SAMPLES  = 8;     // 攒够这么多读数 (约 0.5 s) 才定基准
+constexpr float PROGRESS_EWMA_ALPHA     = 0.3f;
 const double SENSOR_DISTANCE_LIMIT = 50;
 
+// 上升/下降速度比学习 (TravelRateModel.h)
+const float RATE_EWMA_ALPHA       = 0.3f;
+const float RATE_MIN              = 0.5f;  // 超出范围的样本视为异常，不学习
+const float RATE_MAX              = 2.0f;
+const long  RATE_MIN_DISTANCE_MS  = 20000; // 行程太短时比值误差太大
+
+// 定时调度 (SchedulerManager.h)
+const long SCHEDULE_CATCHUP_SEC = 120;          // 错过触发点多久以内仍补触发
+const unsigned long SCHEDULE_RESYNC_MS = 60000; // 最长休眠时间，用于跟随 NTP 校时
+
+// 多目的地停靠 (TripPlanner.h)，每层最多排队一次
+const unsigned long TRIP_REHOME_TRAVEL_MS = 1200*1000; // 累计行程超过该值，下一次下行前先归零消除漂移
+
+// 位置检查点 (PositionCheckpoint.h)：静止后把位置写入 NVS，上电时直接从该位置开始，
+// 记录不可信 (运行中断电、楼层表变化、漂移预算用完) 时才自动归零
+const bool WARM_START_ENABLED = true;
+const unsigned long CHECKPOINT_IDLE_MS = 2000; // 静止这么久才写 Flash，连续指令之间不写
+
+// 运行日志成批落盘 (RunJournal.h)：由网络任务在空闲时写 Flash，攒够条数立即写，否则空闲一段时间后再写
+const int JOURNAL_BATCH_SIZE = 4;
+const unsigned long JOURNAL_IDLE_FLUSH_MS = 5000;
+
+// ==========================
+// 6. 调试与诊断
+// ==========================
+// 状态机调试断言：go<From, To>() 执行时的实际状态必须是 From，否则 assert 失败 (abort 重启)。
+// 现场固件默认关闭；主机仿真 (sim/Makefile) 在编译命令里置 1，回归测试全程检查。
+#ifndef ENABLE_STATE_ASSERTS
+#define ENABLE_STATE_ASSERTS 0
+#endif
+
+// 主循环分段耗时统计 (LoopProfiler.h)，置 0 时统计代码完全不参与编译
+#define ENABLE_LOOP_PROFILER 1
+
+// 二进制遥测 (Telemetry.h)：状态切换、运行记录和周期状态以定长帧写入环形缓冲，
+// 由网络任务非阻塞地发往串口，用 tools/telemetry_decode 还原成文本/CSV。
+// 置 0 时退回逐行打印文本。
+#define ENABLE_BINARY_TELEMETRY 1
+const size_t TELEMETRY_RING_SIZE = 2048;       // 内存缓冲 (2 的幂)
+const size_t TELEMETRY_UART_TX_BUFFER = 1024;  // UART 驱动发送缓冲，后台发出
+const unsigned long TELEMETRY_STATUS_PERIOD_MS = ENABLE_BINARY_TELEMETRY ? 100 : 1000;
+
+// 故障飞行记录 (FlightRecorder.h)：内存环记录每个控制周期 (约 2s)，
+// 进入 ERROR 时按间隔抽取 FLIGHT_SNAPSHOT_SAMPLES 个写入 NVS
+const size_t FLIGHT_RING_SAMPLES = 2048;     // 12 字节/个，2 的幂
+const size_t FLIGHT_SNAPSHOT_SAMPLES = 256;  // 3KB 存入 Flash
+
+// 输入录制 (InputRecorder.h)：把状态机的外部输入 (指令、到顶判断、超声波样本、电流) 以 TLM_INPUT 帧写入遥测流，
+// 用 tools/replay_runner 在主机上重新跑状态机，或用 tools/telemetry_decode --report 直接分析。串口 'R' 切换。
+const bool INPUT_RECORDING_DEFAULT = false;
+const uint32_t INPUT_CURRENT_STEP_MA = 20;   // 电流 RMS 变化超过这么多才记一帧
+
+// 控制路径基准测试 (ControlBenchmark.h)：串口 'B' 触发，电梯静止时在控制任务里运行。
+// 每项按 CPU 周期计数，平均值超过预算即判 FAIL，用来发现让 1kHz 控制周期变慢的改动。
+// 预算按 240MHz 定：整个控制周期是 240000 周期。
+#define ENABLE_CONTROL_BENCHMARK 1
+const int BENCH_ITERATIONS = 1000;
+const uint32_t BENCH_BUDGET_UPDATE_CYCLES = 24000;          // hoist.update()，控制周期的 10%
+const uint32_t BENCH_BUDGET_ACUTE_CYCLES = 200;             // checkAcuteAnomaly()，只是一次比较
+const uint32_t BENCH_BUDGET_SLOPE_CYCLES = 6000;            // calculateSlope()，与历史长度无关
+const uint32_t BENCH_BUDGET_SCHED_IDLE_CYCLES = 400;        // checkTrigger() 未到期 (一次比较)
+const uint32_t BENCH_BUDGET_SCHED_RECOMPUTE_CYCLES = 200000; // checkTrigger() 重算下一个截止时间
+
+// ==========================
+// 7. 任务划分 (FreeRTOS)
+// ==========================
+// 控制任务：状态机 + 传感，固定周期、高优先级，独占 APP 核
+// 网络任务：Blynk / 调度 / 状态上报 / 串口，和 WiFi 协议栈一起放在 PRO 核
+const unsigned long CONTROL_TASK_PERIOD_MS = 1;
+const int CONTROL_TASK_CORE     = 1;
+const int CONTROL_TASK_PRIORITY = 5;
+const int NETWORK_TASK_CORE     = 0;
+const int NETWORK_TASK_PRIORITY = 1;
+const size_t CONTROL_QUEUE_DEPTH = 16;
+
+// 网络连接 (NetworkLink.h)：非阻塞建连，失败后指数退避重试
+// 网络循环单次最长阻塞约为 NET_CLOUD_CONNECT_SLICE_MS 加上一次 TCP 建连的超时
+const uint32_t NET_WIFI_TIMEOUT_MS = 15000;        // 等 Wi-Fi 连上的最长时间
+const uint32_t NET_CLOUD_CONNECT_SLICE_MS = 1000;  // 一次 Blynk.connect 的超时
+const uint32_t NET_BACKOFF_MIN_MS = 1000;
+const uint32_t NET_BACKOFF_MAX_MS = 60000;
+
+// 局域网 UDP 控制 (LocalControl.h / LocalProtocol.h)，客户端见 tools/local_client.cpp
+const uint16_t LOCAL_CONTROL_PORT = 4210;
+const int LOCAL_MAX_SUBSCRIBERS = 4;
+const int LOCAL_MAX_PACKETS_PER_LOOP = 4;               // 每次网络循环最多处理的包数
+const unsigned long LOCAL_STATUS_PERIOD_MS = 100;        // 状态没变化时的推送间隔
+const unsigned long LOCAL_SUBSCRIBE_TIMEOUT_MS = 10000;  // 订阅多久不续订就失效
+
 #endif
\ No newline at end of file
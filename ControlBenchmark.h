@@ -0,0 +1,211 @@
+#ifndef CONTROL_BENCHMARK_H
+#define CONTROL_BENCHMARK_H
+
+/**
+ * @file ControlBenchmark.h
+ * @brief 控制路径基准测试：逐项测量周期数并与 Config.h 中的预算比较
+ * @details 串口 'B' 投递 CMD_RUN_BENCHMARK，由控制任务在两个周期之间执行，
+ *          与状态机同核、同上下文，测到的就是 1kHz 周期里的真实开销。
+ *          - hoist.update()：当前 (静止) 状态下的一次更新
+ *          - 状态分派：DispatchModel 里同一组处理函数分别经 switch (update() 的写法)
+ *            和成员函数指针表 (进入 / 退出处理的写法) 调用，各状态轮流一遍；只作对照，不判定
+ *          - checkAcuteAnomaly() / calculateSlope()：正在使用的维护管理器
+ *          - calculateSlope() 随历史长度：另建一份 RunStatistics，填入 0 / 10 / 100 / 1000 次运行，
+ *            最后与 double 参考实现对比周期数和结果
+ *          - checkTrigger()：另建一个调度器，分别测未到期和重算截止时间两条路径
+ *          电梯运行中拒绝执行 (运行期间不能停掉控制周期)。
+ *          每项取 BENCH_ITERATIONS 次的平均周期数判定，最大值受中断影响只作参考。
+ *          主机上由 tools/control_bench 在仿真里调用同一个 run()，用于比较改动前后的相对变化；
+ *          tools/dispatch_bench 逐个状态、加大次数比较两种分派。
+ */
+
+#include <Arduino.h>
+#include "Config.h"
+#include "HoistStateMachine.h"
+#include "MaintenanceManager.h"
+#include "RunStatistics.h"
+#include "SchedulerManager.h"
+
+#if ENABLE_CONTROL_BENCHMARK
+
+/**
+ * @brief 状态分派的两种写法，处理函数相同
+ * tickSwitch() 与 HoistStateMachine::update() 的周期处理一样用 switch，tickTable() 查成员函数指针表
+ * (进入 / 退出处理的写法)。主机上 switch 约 4.5 周期/次、表约 6.5，所以每周期都走的分派用 switch。
+ * 每个处理函数只做几次整数运算 (与 tickIdle / tickError 的量级相当)，测到的主要是分派本身。
+ */
+class DispatchModel {
+private:
+    typedef void (DispatchModel::*Handler)(unsigned long now);
+    static const Handler TABLE[STATE_COUNT];
+    uint32_t _acc[STATE_COUNT] = {}; // 每个状态一份，结果能看出每个处理函数各被调用了多少
+
+    void tickIdle(unsigned long now) { _acc[STATE_IDLE] += now & 1; }
+    void tickCalibrating(unsigned long now) { _acc[STATE_CALIBRATING] ^= (uint32_t)now; }
+    void tickMovingUp(unsigned long now) { _acc[STATE_MOVING_UP] -= (uint32_t)now >> 3; }
+    void tickMovingDown(unsigned long now) { _acc[STATE_MOVING_DOWN] += (uint32_t)now >> 2; }
+    void tickError(unsigned long now) { _acc[STATE_ERROR] = (_acc[STATE_ERROR] << 1) | (now & 1); }
+    void tickUnknown(unsigned long) { _acc[STATE_POS_UNKNOWN]++; }
+
+public:
+    void tickTable(SystemState state, unsigned long now) { (this->*TABLE[state])(now); }
+
+    void tickSwitch(SystemState state, unsigned long now) {
+        switch (state) {
+            case STATE_IDLE:        tickIdle(now); break;
+            case STATE_CALIBRATING: tickCalibrating(now); break;
+            case STATE_MOVING_UP:   tickMovingUp(now); break;
+            case STATE_MOVING_DOWN: tickMovingDown(now); break;
+            case STATE_ERROR:       tickError(now); break;
+            case STATE_POS_UNKNOWN: tickUnknown(now); break;
+            default: break;
+        }
+    }
+
+    bool sameAs(const DispatchModel& other) const { return memcmp(_acc, other._acc, sizeof(_acc)) == 0; }
+    uint32_t result() const { return _acc[STATE_IDLE] ^ _acc[STATE_CALIBRATING] ^ _acc[STATE_MOVING_UP]; }
+};
+
+inline const DispatchModel::Handler DispatchModel::TABLE[STATE_COUNT] = {
+    &DispatchModel::tickIdle, &DispatchModel::tickCalibrating, &DispatchModel::tickMovingUp,
+    &DispatchModel::tickMovingDown, &DispatchModel::tickError, &DispatchModel::tickUnknown,
+};
+
+class ControlBenchmark {
+private:
+    RunStatistics _stats;        // 历史长度扫描用，不影响真实历史
+    SchedulerManager _scheduler; // 不调用 begin()，不碰 NTP
+    uint32_t _overheadCycles = 0;
+    int _failures = 0;
+    volatile int32_t _sinkQ = 0; // 结果写到这里，防止调用被优化掉
+    volatile double _sinkD = 0;
+    volatile int _sinkI = 0;
+    DispatchModel _dispatch;
+    volatile uint8_t _dispatchState = 0; // 运行时才知道的状态，编译器不能把分派折叠掉
+
+    // budget 为 0 表示只是对照项 (如浮点参考实现)，不参与判定
+    template <typename F>
+    void measure(const char* name, uint32_t budget, F fn) {
+        uint32_t minC = UINT32_MAX, maxC = 0;
+        uint64_t total = 0;
+        for (int i = 0; i < BENCH_ITERATIONS; i++) {
+            uint32_t start = ESP.getCycleCount();
+            fn();
+            uint32_t cycles = ESP.getCycleCount() - start;
+            cycles = cycles > _overheadCycles ? cycles - _overheadCycles : 0;
+            total += cycles;
+            if (cycles < minC) minC = cycles;
+            if (cycles > maxC) maxC = cycles;
+        }
+        uint32_t avg = (uint32_t)(total / BENCH_ITERATIONS);
+        if (budget == 0) {
+            Serial.printf("[Bench] %-28s %8lu %8lu %8lu %8s  ref\n", name, (unsigned long)minC,
+                          (unsigned long)avg, (unsigned long)maxC, "-");
+            return;
+        }
+        bool pass = avg <= budget;
+        if (!pass) _failures++;
+        Serial.printf("[Bench] %-28s %8lu %8lu %8lu %8lu  %s\n", name, (unsigned long)minC,
+                      (unsigned long)avg, (unsigned long)maxC, (unsigned long)budget, pass ? "ok" : "FAIL");
+    }
+
+    // 空测量的开销 (读两次周期计数器)，从每个结果里减掉
+    void calibrate() {
+        uint32_t best = UINT32_MAX;
+        for (int i = 0; i < 100; i++) {
+            uint32_t start = ESP.getCycleCount();
+            uint32_t cycles = ESP.getCycleCount() - start;
+            if (cycles < best) best = cycles;
+        }
+        _overheadCycles = best;
+    }
+
+public:
+    /**
+     * @brief 运行全部测量 (控制任务调用)
+     * @return true 表示全部在预算内
+     */
+    bool run(HoistStateMachine& hoist, MaintenanceManager& maintenance) {
+        SystemState state = hoist.getState();
+        if (state == STATE_MOVING_UP || state == STATE_MOVING_DOWN || state == STATE_CALIBRATING) {
+            Serial.println("[Bench] Refused: hoist is moving.");
+            return false;
+        }
+
+        calibrate();
+        _failures = 0;
+        char name[40];
+        Serial.printf("[Bench] %d iterations, %lu MHz, overhead %lu cycles\n", BENCH_ITERATIONS,
+                      (unsigned long)getCpuFrequencyMhz(), (unsigned long)_overheadCycles);
+        Serial.println("[Bench] function                          min      avg      max   budget");
+
+        snprintf(name, sizeof(name), "update() [%s]", hoist.getStateName());
+        measure(name, BENCH_BUDGET_UPDATE_CYCLES, [&]() { hoist.update(); });
+
+        // 状态分派：每次把全部状态各分派一次
+        measure("dispatch table x6", 0, [&]() {
+            for (int i = 0; i < STATE_COUNT; i++) {
+                _dispatch.tickTable((SystemState)((_dispatchState + i) % STATE_COUNT), i);
+            }
+        });
+        measure("dispatch switch x6", 0, [&]() {
+            for (int i = 0; i < STATE_COUNT; i++) {
+                _dispatch.tickSwitch((SystemState)((_dispatchState + i) % STATE_COUNT), i);
+            }
+        });
+        _sinkQ = (int32_t)_dispatch.result();
+
+        long limitMs = maintenance.getAcuteLimitMs();
+        measure("checkAcuteAnomaly()", BENCH_BUDGET_ACUTE_CYCLES,
+                [&]() { _sinkI = maintenance.checkAcuteAnomaly(limitMs); });
+
+        static const char* const windowNames[WINDOW_COUNT] = { "short", "medium", "all" };
+        for (int w = 0; w < WINDOW_COUNT; w++) {
+            snprintf(name, sizeof(name), "calculateSlope(%s)", windowNames[w]);
+            measure(name, BENCH_BUDGET_SLOPE_CYCLES,
+                    [&]() { _sinkQ = maintenance.calculateSlope((StatsWindow)w).raw; });
+        }
+
+        // 历史长度扫描：斜率由累加和直接算出，耗时不应随 n 增长
+        static const int historySizes[] = { 0, 10, 100, 1000 };
+        int filled = 0;
+        _stats = RunStatistics();
+        for (int size : historySizes) {
+            for (; filled < size; filled++) _stats.add(TIME_TO_BOTTOM_MS + filled % 50);
+            snprintf(name, sizeof(name), "slope(all) n=%d", size);
+            measure(name, BENCH_BUDGET_SLOPE_CYCLES, [&]() { _sinkQ = _stats.slope(WINDOW_ALL).raw; });
+        }
+        // 对照：同样的累加和用原来的 double 公式 (ESP32 上是软件浮点)
+        measure("slope(all) double ref", 0, [&]() { _sinkD = _stats.slopeReference(WINDOW_ALL); });
+        Serial.printf("[Bench] slope(all) fixed %.4f / double %.4f ms per run\n",
+                      _stats.slope(WINDOW_ALL).toFloat(), _stats.slopeReference(WINDOW_ALL));
+
+        // 调度器：reset() 后第一次调用走重算路径，之后都是未到期的快速路径
+        _scheduler.reset();
+        _sinkI = _scheduler.checkTrigger();
+        measure("checkTrigger() not due", BENCH_BUDGET_SCHED_IDLE_CYCLES,
+                [&]() { _sinkI = _scheduler.checkTrigger(); });
+        measure("checkTrigger() recompute", BENCH_BUDGET_SCHED_RECOMPUTE_CYCLES, [&]() {
+            _scheduler.reset();
+            _sinkI = _scheduler.checkTrigger();
+        });
+
+        Serial.printf("[Bench] %s (%d over budget)\n", _failures ? "FAIL" : "PASS", _failures);
+        return _failures == 0;
+    }
+};
+
+#else
+
+// 关闭时保留同样的接口，调用点无需 #if
+class ControlBenchmark {
+public:
+    bool run(HoistStateMachine&, MaintenanceManager&) {
+        Serial.println("[Bench] Disabled (ENABLE_CONTROL_BENCHMARK = 0)");
+        return true;
+    }
+};
+
+#endif // ENABLE_CONTROL_BENCHMARK
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef CONTROL_CHANNEL_H
+#define CONTROL_CHANNEL_H
+
+/**
+ * @file ControlChannel.h
+ * @brief 控制任务与网络任务之间的通信通道
+ * @details 网络任务 (Blynk / 调度 / 串口) 只通过这里下发指令、读取状态，
+ *          不再直接调用 HoistStateMachine。
+ *          - 指令：单生产者/单消费者无锁环形队列，满了就丢弃并返回 false
+ *          - 急停：不进队列，单独一个原子标志，不会因队列满而丢失；
+ *            控制任务每个周期先检查它，再处理队列
+ *          - 状态：单写者 seqlock 快照，读者拿到的永远是一致的最新值
+ */
+
+#include <Arduino.h>
+#include <atomic>
+#include "Config.h"
+#include "Seqlock.h"
+
+enum HoistCommandType : uint8_t {
+    CMD_GO_FLOOR,       // arg = 楼层下标 (FloorTable.h)
+    CMD_EMERGENCY_STOP, // 不经队列 (requestEmergencyStop)，保留编号用于输入录制
+    CMD_DEMO_START,     // 清空历史并生成 Demo 剧本
+    CMD_DEMO_INJECT,    // arg = Demo 数据下标
+    CMD_SET_RECORDING,  // arg = 1 开始 / 0 停止录制状态机输入
+    CMD_RUN_BENCHMARK   // 静止时运行控制路径基准测试 (ControlBenchmark.h)
+};
+
+struct HoistCommand {
+    HoistCommandType type;
+    int16_t arg;
+};
+
+/**
+ * @brief 控制任务发布的状态快照
+ */
+struct HoistStatus {
+    SystemState state;
+    const char* stateName;
+    long positionMs;
+    bool topLimit;
+    uint8_t pendingStops;    // 排队中的楼层数
+    uint8_t targetFloor;     // 当前行程的目标楼层，FLOOR_NONE 表示没有
+    uint8_t duty;            // 实际输出到电机的 PWM
+    long lastRunMs;          // 最近一次全程耗时
+    float slope;             // 老化斜率 (ms / 次)
+    long meanCurrentMa;      // 最近几次全程的平均电流 (0 表示还没有电流数据)
+    float currentSlope;      // 平均电流的趋势 (mA / 次)，同样时长下电流上升说明摩擦变大
+    uint32_t historyVersion; // 维护历史每变化一次 +1
+};
+
+/**
+ * @brief 单生产者/单消费者环形队列，容量为 N-1
+ */
+template <typename T, size_t N>
+class SpscQueue {
+private:
+    T _items[N];
+    std::atomic<size_t> _head{0}; // 消费者读取位置
+    std::atomic<size_t> _tail{0}; // 生产者写入位置
+
+public:
+    bool push(const T& item) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        size_t next = (tail + 1) % N;
+        if (next == _head.load(std::memory_order_acquire)) return false; // 满
+        _items[tail] = item;
+        _tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) return false; // 空
+        item = _items[head];
+        _head.store((head + 1) % N, std::memory_order_release);
+        return true;
+    }
+};
+
+class ControlChannel {
+private:
+    SpscQueue<HoistCommand, CONTROL_QUEUE_DEPTH> _commands;
+    SeqlockMailbox<HoistStatus> _status;
+    std::atomic<bool> _emergencyStop{false};
+
+public:
+    // --- 网络任务侧 ---
+
+    // 急停请求，任意任务可调用，不会失败
+    void requestEmergencyStop() { _emergencyStop.store(true, std::memory_order_release); }
+
+    bool post(HoistCommandType type, int16_t arg = 0) {
+        HoistCommand cmd = { type, arg };
+        if (!_commands.push(cmd)) {
+            Serial.printf("[Channel] Command queue full, dropped cmd %d\n", type);
+            return false;
+        }
+        return true;
+    }
+
+    bool readStatus(HoistStatus& out) const { return _status.read(out); }
+
+    // --- 控制任务侧 ---
+
+    // 取走急停请求 (每个周期最先调用)
+    bool takeEmergencyStop() { return _emergencyStop.exchange(false, std::memory_order_acquire); }
+
+    bool take(HoistCommand& cmd) { return _commands.pop(cmd); }
+
+    void publishStatus(const HoistStatus& status) { _status.publish(status); }
+};
+
+#endif
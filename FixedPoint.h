@@ -0,0 +1,136 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+/**
+ * @file FixedPoint.h
+ * @brief Q 格式定点数 (32 位有符号，小数位数由模板参数决定)
+ * @details ESP32 的 FPU 只有单精度，double 全部是软件模拟；维护统计和基准计算改用定点数。
+ *          - Fixed<F>：raw / 2^F，乘法用 64 位中间值并四舍五入 (EWMA 反复相乘不会单向漂移)，
+ *            溢出时饱和而不是回绕
+ *          - Fixed<F>::ratio(num, den)：两个 64 位整数之比，商与余数分开算，不会在放大时溢出
+ *          - 常量用 constexpr fromConst() 在编译期换算，运行时不出现浮点
+ *          不同量纲选不同的 F：比值/斜率用 Q16，毫秒级均值用 Q8，方差这类很小的量用 Q24。
+ *          本文件只依赖 <stdint.h>，主机上可以直接编译。
+ */
+
+#include <stdint.h>
+
+// 64 位整数平方根 (逐位法，无除法)
+inline uint32_t fixedIsqrt(uint64_t v) {
+    uint64_t r = 0, bit = (uint64_t)1 << 62;
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)r;
+}
+
+template <int F>
+class Fixed {
+    static_assert(F > 0 && F < 31, "Fixed<F>: F must be 1..30");
+
+public:
+    int32_t raw = 0;
+
+    static constexpr int FRAC_BITS = F;
+    static constexpr int64_t ONE = (int64_t)1 << F;
+
+    constexpr Fixed() = default;
+
+    static constexpr Fixed fromRaw(int64_t r) {
+        return Fixed(r > INT32_MAX ? INT32_MAX : (r < INT32_MIN ? INT32_MIN : (int32_t)r));
+    }
+    static constexpr Fixed fromInt(int64_t v) { return fromRaw(v * ONE); }
+
+    // 只用于编译期常量 (Config.h 里的系数)，四舍五入
+    static constexpr Fixed fromConst(double v) {
+        return fromRaw((int64_t)(v * ONE + (v >= 0 ? 0.5 : -0.5)));
+    }
+
+    /**
+     * @brief num / den，四舍五入；den 为 0 时返回 0
+     * 商和余数分开放大；余数放大会溢出时先把分子分母一起右移 (只损失 den 的低位)
+     */
+    static Fixed ratio(int64_t num, int64_t den) {
+        if (den == 0) return Fixed();
+        if (den < 0) {
+            num = -num;
+            den = -den;
+        }
+        while (den > ((int64_t)1 << (62 - F))) {
+            num >>= 1;
+            den >>= 1;
+        }
+        int64_t q = num / den;
+        int64_t r = num % den;
+        if (q > (INT32_MAX >> F) || q < (INT32_MIN >> F)) return fromRaw(q > 0 ? INT64_MAX : INT64_MIN);
+        int64_t frac = ((r << F) + (r >= 0 ? den / 2 : -den / 2)) / den;
+        return fromRaw(q * ONE + frac);
+    }
+
+    // 换成另一种 Q 格式 (截断多余的小数位)
+    template <int G>
+    constexpr Fixed<G> as() const {
+        return G >= F ? Fixed<G>::fromRaw((int64_t)raw << (G >= F ? G - F : 0))
+                      : Fixed<G>::fromRaw((int64_t)raw >> (G >= F ? 0 : F - G));
+    }
+
+    // 乘以整数后取整 (如 行程 × 比值)，四舍五入
+    constexpr int64_t scale(int64_t v) const {
+        return ((int64_t)raw * v + (ONE >> 1)) >> F;
+    }
+
+    constexpr int32_t toInt() const { return (int32_t)(((int64_t)raw + (ONE >> 1)) >> F); }
+    constexpr float toFloat() const { return (float)raw * (1.0f / (float)ONE); }
+
+    constexpr Fixed operator+(Fixed o) const { return fromRaw((int64_t)raw + o.raw); }
+    constexpr Fixed operator-(Fixed o) const { return fromRaw((int64_t)raw - o.raw); }
+    constexpr Fixed operator-() const { return fromRaw(-(int64_t)raw); }
+    constexpr Fixed operator*(Fixed o) const { return fromRaw(((int64_t)raw * o.raw + (ONE >> 1)) >> F); }
+    Fixed& operator+=(Fixed o) { return *this = *this + o; }
+    Fixed& operator-=(Fixed o) { return *this = *this - o; }
+
+    constexpr bool operator<(Fixed o) const { return raw < o.raw; }
+    constexpr bool operator>(Fixed o) const { return raw > o.raw; }
+    constexpr bool operator<=(Fixed o) const { return raw <= o.raw; }
+    constexpr bool operator>=(Fixed o) const { return raw >= o.raw; }
+    constexpr bool operator==(Fixed o) const { return raw == o.raw; }
+
+    /**
+     * @brief 平方根，直接给出 Q(R)：sqrt(raw · 2^(2R−F)) = sqrt(x) · 2^R；负数返回 0
+     */
+    template <int R>
+    Fixed<R> sqrt() const {
+        static_assert(2 * R - F <= 32, "sqrt: result precision too high for a 64-bit radicand");
+        if (raw <= 0) return Fixed<R>();
+        uint64_t v = (uint64_t)raw;
+        v = (2 * R >= F) ? v << (2 * R >= F ? 2 * R - F : 0) : v >> (2 * R >= F ? 0 : F - 2 * R);
+        return Fixed<R>::fromRaw(fixedIsqrt(v));
+    }
+
+private:
+    constexpr explicit Fixed(int32_t r) : raw(r) {}
+    template <int> friend class Fixed;
+};
+
+/**
+ * @brief 不同 Q 格式相乘，结果直接给出 Q(R)，中间值 64 位，四舍五入
+ */
+template <int R, int A, int B>
+constexpr Fixed<R> fixedMul(Fixed<A> a, Fixed<B> b) {
+    return (A + B > R) ? Fixed<R>::fromRaw(((int64_t)a.raw * b.raw + ((int64_t)1 << (A + B > R ? A + B - R - 1 : 0)))
+                                           >> (A + B > R ? A + B - R : 0))
+                       : Fixed<R>::fromRaw(((int64_t)a.raw * b.raw) << (A + B > R ? 0 : R - A - B));
+}
+
+typedef Fixed<8> Q8;    // 毫秒 / 毫安级的均值 (范围约 ±8.3e6)
+typedef Fixed<16> Q16;  // 比值、斜率 (范围约 ±32767)
+typedef Fixed<24> Q24;  // 方差等很小的量 (范围约 ±127)
+
+#endif
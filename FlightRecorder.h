@@ -0,0 +1,147 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+/**
+ * @file FlightRecorder.h
+ * @brief 故障飞行记录仪：内存里循环记录每个控制周期，出错时把最后一段存进 Flash
+ * @details - record()：控制任务每周期调用一次，只是往环形数组写 12 字节，无锁无分支
+ *          - snapshot()：进入 ERROR 时由控制任务调用，把环里最近的数据按固定间隔抽样拷进暂存区，
+ *            只是 3KB 内存拷贝，不碰 Flash
+ *          - service()：网络任务调用，把暂存区连同出错原因写入 NVS，重启后仍可读取
+ *          - dump()：串口 'F' 指令 (网络任务)，把 NVS 里的快照以遥测帧输出，用 tools/telemetry_decode 还原
+ *          环形数组只有控制任务写。暂存区由 _buffer 状态交接：控制任务只在 BUFFER_FREE 时占用，
+ *          上一份还没写完 (或正在导出) 时新的快照放弃，保留先出现的故障。
+ */
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <atomic>
+#include "Config.h"
+#include "Telemetry.h"
+
+static_assert((FLIGHT_RING_SAMPLES & (FLIGHT_RING_SAMPLES - 1)) == 0, "FLIGHT_RING_SAMPLES must be a power of two");
+static_assert(FLIGHT_RING_SAMPLES % FLIGHT_SNAPSHOT_SAMPLES == 0, "Snapshot must sample the ring evenly");
+
+#define FLIGHT_PREF_NAMESPACE "flightrec"
+
+class FlightRecorder {
+private:
+    static const uint16_t STRIDE = FLIGHT_RING_SAMPLES / FLIGHT_SNAPSHOT_SAMPLES;
+
+    // 暂存区的归属
+    enum BufferState : uint8_t {
+        BUFFER_FREE,      // 空闲
+        BUFFER_CAPTURE,   // 控制任务正在拷贝
+        BUFFER_PENDING,   // 等网络任务写 Flash
+        BUFFER_EXPORT     // 网络任务正在导出
+    };
+
+    FlightSample _ring[FLIGHT_RING_SAMPLES];
+    uint32_t _next = 0;                          // 下一个写入位置 (只增不减)
+    FlightSample _snapshot[FLIGHT_SNAPSHOT_SAMPLES]; // 写 Flash / 导出时的暂存
+    FlightHeader _header;                        // 与 _snapshot 一起交接
+    std::atomic<uint8_t> _buffer{BUFFER_FREE};
+    Preferences _prefs;
+
+    bool claim(uint8_t to) {
+        uint8_t expected = BUFFER_FREE;
+        return _buffer.compare_exchange_strong(expected, to, std::memory_order_acquire);
+    }
+
+public:
+    void begin() {
+        _prefs.begin(FLIGHT_PREF_NAMESPACE, false);
+        FlightHeader hdr;
+        if (_prefs.getBytes("hdr", &hdr, sizeof(hdr)) == sizeof(hdr)) {
+            Serial.printf("[Flight] Snapshot of a %s error at %lu ms stored ('F' to dump)\n",
+                          telemetryReasonName(hdr.reason), (unsigned long)hdr.triggerMs);
+        }
+    }
+
+    /**
+     * @brief 记录一个控制周期 (控制任务调用)
+     */
+    inline void record(uint8_t state, long positionMs, int32_t distanceMm, int duty) {
+        FlightSample& s = _ring[_next & (FLIGHT_RING_SAMPLES - 1)];
+        s.timestampMs = millis();
+        s.positionMs = (int32_t)positionMs;
+        s.distanceMm = (int16_t)distanceMm;
+        s.state = state;
+        s.duty = (uint8_t)duty;
+        _next++;
+    }
+
+    /**
+     * @brief 把最近 FLIGHT_RING_SAMPLES 个周期抽样拷进暂存区，由 service() 写入 Flash (控制任务调用)
+     * @param reason 出错原因 (TelemetryReason)
+     * @param fromState 出错前的状态
+     */
+    void snapshot(uint8_t reason, uint8_t fromState) {
+        if (!claim(BUFFER_CAPTURE)) return; // 上一份还没写完
+
+        uint32_t available = _next < FLIGHT_RING_SAMPLES ? _next : FLIGHT_RING_SAMPLES;
+        uint16_t count = available / STRIDE;
+        // 从最旧到最新，最后一个采样就是刚进入 ERROR 的那个周期
+        uint32_t newest = _next - 1;
+        for (uint16_t i = 0; i < count; i++) {
+            uint32_t idx = newest - (uint32_t)(count - 1 - i) * STRIDE;
+            _snapshot[i] = _ring[idx & (FLIGHT_RING_SAMPLES - 1)];
+        }
+        _header = { (uint32_t)millis(), reason, fromState, count, STRIDE };
+        _buffer.store(BUFFER_PENDING, std::memory_order_release);
+    }
+
+    /**
+     * @brief 把待写的快照存入 Flash，覆盖上一次的快照 (网络任务每轮调用)
+     */
+    void service() {
+        if (_buffer.load(std::memory_order_acquire) != BUFFER_PENDING) return;
+        _prefs.putBytes("samples", _snapshot, sizeof(FlightSample) * _header.count);
+        _prefs.putBytes("hdr", &_header, sizeof(_header)); // 头最后写：写到一半断电时不会读到残缺快照
+        telemetry.event(EVENT_FLIGHT_SAVED, _header.reason, _header.count);
+        _buffer.store(BUFFER_FREE, std::memory_order_release);
+    }
+
+    /**
+     * @brief 串口导出快照 (网络任务调用，逐帧阻塞写出)
+     */
+    void dump() {
+        service(); // 刚出的故障先落盘，导出的就是它
+        if (!claim(BUFFER_EXPORT)) {
+            Serial.println("[Flight] Snapshot being captured, try again.");
+            return;
+        }
+        FlightHeader hdr;
+        if (_prefs.getBytes("hdr", &hdr, sizeof(hdr)) != sizeof(hdr)) {
+            Serial.println("[Flight] No snapshot stored.");
+            _buffer.store(BUFFER_FREE, std::memory_order_release);
+            return;
+        }
+        if (hdr.count > FLIGHT_SNAPSHOT_SAMPLES) hdr.count = FLIGHT_SNAPSHOT_SAMPLES;
+        _prefs.getBytes("samples", _snapshot, sizeof(FlightSample) * hdr.count);
+
+#if ENABLE_BINARY_TELEMETRY
+        uint8_t frame[TLM_MAX_FRAME];
+        uint8_t seq = 0;
+        Serial.write(frame, telemetryEncode(frame, TLM_FLIGHT_HEADER, seq++, hdr.triggerMs, &hdr, sizeof(hdr)));
+        for (uint16_t i = 0; i < hdr.count; i++) {
+            uint32_t size = telemetryEncode(frame, TLM_FLIGHT_SAMPLE, seq++, _snapshot[i].timestampMs,
+                                            &_snapshot[i], sizeof(FlightSample));
+            Serial.write(frame, size);
+        }
+#else
+        Serial.printf("[Flight] %s error at %lu ms, %u samples every %u cycles\n",
+                      telemetryReasonName(hdr.reason), (unsigned long)hdr.triggerMs,
+                      hdr.count, hdr.strideCycles);
+        Serial.println("timestamp_ms,state,position_ms,distance_mm,duty");
+        for (uint16_t i = 0; i < hdr.count; i++) {
+            const FlightSample& s = _snapshot[i];
+            Serial.printf("%lu,%s,%ld,%d,%u\n", (unsigned long)s.timestampMs, telemetryStateName(s.state),
+                          (long)s.positionMs, s.distanceMm, s.duty);
+        }
+#endif
+        _buffer.store(BUFFER_FREE, std::memory_order_release);
+    }
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef FLOOR_TABLE_H
+#define FLOOR_TABLE_H
+
+/**
+ * @file FloorTable.h
+ * @brief 楼层表的编译期校验与查表接口
+ * @details 楼层数据在 Config.h 的 FLOOR_TABLE 中定义。这里用 static_assert 保证：
+ *          表项数量与 FloorId 一致、顶层在 0、位置严格递增且相邻楼层的容差不重叠、
+ *          最低层在 MAX_SAFE_POSITION_MS 之内、接近 PWM 在电机可用范围内。
+ *          运行时只有下标查表，没有任何解析。
+ */
+
+#include <Arduino.h>
+#include "Config.h"
+
+constexpr uint8_t FLOOR_NONE = 0xFF;
+
+constexpr bool floorTableAscending() {
+    for (int i = 1; i < FLOOR_COUNT; i++) {
+        if (FLOOR_TABLE[i].positionMs <=
+            FLOOR_TABLE[i - 1].positionMs + FLOOR_TABLE[i - 1].toleranceMs + FLOOR_TABLE[i].toleranceMs) {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr bool floorPwmUsable(int pwm) {
+    return pwm > MOTOR_PWM_DEADBAND && pwm <= 255;
+}
+
+constexpr bool floorTablePwmValid() {
+    for (int i = 0; i < FLOOR_COUNT; i++) {
+        if (!floorPwmUsable(FLOOR_TABLE[i].approachPwmUp) ||
+            !floorPwmUsable(FLOOR_TABLE[i].approachPwmDown)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(sizeof(FLOOR_TABLE) / sizeof(FLOOR_TABLE[0]) == FLOOR_COUNT,
+              "FLOOR_TABLE must have one entry per FloorId");
+static_assert(FLOOR_COUNT >= 2 && FLOOR_COUNT <= 32, "Floor set must fit in a 32-bit mask");
+static_assert(FLOOR_TABLE[FLOOR_TOP].positionMs == 0, "Top floor must be the sensor zero point");
+static_assert(floorTableAscending(), "Floor positions must increase from top to bottom without overlapping tolerances");
+static_assert(FLOOR_TABLE[FLOOR_COUNT - 1].positionMs < MAX_SAFE_POSITION_MS,
+              "Lowest floor must stay under MAX_SAFE_POSITION_MS");
+static_assert(floorTablePwmValid(), "Approach PWM must be above the motor deadband");
+
+inline const FloorSpec& floorSpec(uint8_t floor) { return FLOOR_TABLE[floor]; }
+inline long floorPositionMs(uint8_t floor) { return (long)FLOOR_TABLE[floor].positionMs; }
+
+/**
+ * @brief 分段开关 (V20) 的取值：1 = 最低层 ... FLOOR_COUNT = 顶层
+ */
+constexpr uint8_t floorFromSelector(int value) {
+    return (value >= 1 && value <= FLOOR_COUNT) ? (uint8_t)(FLOOR_COUNT - value) : FLOOR_NONE;
+}
+
+/**
+ * @brief 按钮虚拟引脚 -> 楼层，FLOOR_NONE 表示不是楼层按钮
+ */
+inline uint8_t floorFromBlynkPin(uint8_t pin) {
+    for (uint8_t i = 0; i < FLOOR_COUNT; i++) {
+        if (FLOOR_TABLE[i].blynkPin == pin) return i;
+    }
+    return FLOOR_NONE;
+}
+
+#endif
@@ -2,8 +2,14 @@
 #define HOIST_STATE_MACHINE_H_
 #include "Config.h"
 #include "hardware_controller.h" // 引入硬件接口
+#include "motion_timer.h"        // 定时器驱动的位置积分
 #include "MaintenanceManager.h"  // 引入维护管理器
+#include "TripPlanner.h"         // 多目的地停靠队列
+#include "Telemetry.h"           // 二进制遥测 (状态切换原因)
+#include "HoistTransitions.h"    // 编译期转移表
+#include "ProgressMonitor.h"     // 期望位置 vs 实测位置 (卡滞检测)
 #include <Arduino.h>
+#include <assert.h>
 
 // 注意：这里我们不 include blynk_manager.h，避免循环引用。
 // 如果状态机需要发数据给Blynk，通常用回调或者简单的全局标志，
@@ -12,242 +18,508 @@
 class HoistStateMachine {
 private:
     SystemState _currentState;
-    long _currentPositionMs;
     long _targetPositionMs;
-    unsigned long _lastUpdateTimestamp;
+    uint8_t _targetFloor;        // 当前行程的目标楼层 (FloorTable.h)，FLOOR_NONE 表示没有
     unsigned long _runStartTime; // 记录动作开始时间，用于 AI 统计
     bool _isFullRunMeasuring;    // 标记是否为“全程运行”（从底到顶），只有这种情况才记录数据
+    long _runStartPositionMs;    // 本段行程起点，-1 表示未知；归零时用于学习短期异常基准
+    TripPlanner _trips;          // 排队中的停点，当前行程结束后按 SCAN 顺序执行
+    long _travelSinceHomeMs;     // 上次归零以来的累计行程，用于判断漂移是否需要重新归零
+    TelemetryReason _lastReason = REASON_NONE; // 最近一次状态切换的原因，供飞行记录使用
+    uint64_t _runCurrentSumMa = 0;   // 本段行程每周期 RMS 电流之和，用于算平均电流
+    uint32_t _runCurrentSamples = 0;
+    bool _runCurrentLost = false;    // 本段已报告过电流样本中断
+    ProgressMonitor _progress;       // 本段行程的进度检查
     
     MaintenanceManager* _maintenanceMgr = nullptr; // 维护管理器指针
 
-    // --- 硬件控制封装 (现在调用 HAL 接口) ---
+    // --- 硬件控制封装 (经由运动计时核心调用 HAL 接口) ---
+    // 位置积分和到位停机由 motion_timer 的定时器完成，这里只负责启停。
     
     void motorStopWrapper() {
-        stopMotor(); // 调用 hardware_controller 的函数
+        motionStop();
     }
 
-    void motorUpWrapper() {
-        // 使用 Config.h 里定义的 PWM 值
-        motorGoUp(PWM_SPEED_UP); 
+    void motorUpWrapper(int64_t targetUs, int approachPwm = PWM_APPROACH_UP) {
+        // 上升位置按当前 PWM 下学到的速度比积分 (负载自适应)
+        if (_maintenanceMgr) motionSetUpRateQ16(_maintenanceMgr->getUpRateQ16(PWM_SPEED_UP));
+        // 使用 Config.h 里定义的 PWM 值，接近速度由目标楼层决定
+        motionStart(-1, PWM_SPEED_UP, targetUs, approachPwm);
     }
 
-    void motorDownWrapper() {
-        motorGoDown(PWM_SPEED_DOWN);
+    void motorDownWrapper(int64_t targetUs, int approachPwm = PWM_APPROACH_DOWN) {
+        motionStart(1, PWM_SPEED_DOWN, targetUs, approachPwm);
+    }
+
+    // 向目标楼层出发，按方向取该层的接近速度
+    void motorTowardFloor(int direction, uint8_t floor) {
+        const FloorSpec& spec = floorSpec(floor);
+        int64_t targetUs = (int64_t)spec.positionMs * 1000;
+        if (direction > 0) {
+            motorDownWrapper(targetUs, spec.approachPwmDown);
+        } else {
+            motorUpWrapper(targetUs, spec.approachPwmUp);
+        }
     }
 
     bool checkTopSensor() {
         return isTopLimitPressed(); // 调用 hardware_controller 的函数
     }
 
-public:
-    void bindMaintenanceManager(MaintenanceManager* mgr) {
-        _maintenanceMgr = mgr;
+    // --- 每个状态的进入 / 退出，按 SystemState 下标查表调用 (表在类定义之后) ---
+    // 周期处理在 update() 里用 switch 分派：每个周期都走，switch 比经成员函数指针的间接调用便宜
+    // (tools/dispatch_bench：主机上每次少 1.5~2 个周期)；进入 / 退出只在切换时走，查表即可
+    struct StateHandlers {
+        void (HoistStateMachine::*onEnter)();
+        void (HoistStateMachine::*onExit)();
+    };
+    static const StateHandlers HANDLERS[STATE_COUNT];
+
+    // 状态切换统一经过这里：退出旧状态、写一帧遥测 (不阻塞，取代逐行打印)、进入新状态
+    // 切换到自身不执行进入/退出
+    void transition(SystemState next, TelemetryReason reason, long detail) {
+        if (next == _currentState) return;
+        (this->*HANDLERS[_currentState].onExit)();
+        telemetry.stateChange(_currentState, next, reason, _targetFloor, getCurrentPosition(), detail);
+        _lastReason = reason;
+        _currentState = next;
+        (this->*HANDLERS[next].onEnter)();
     }
 
-    void begin() {
-        _currentState = STATE_POS_UNKNOWN;
-        _currentPositionMs = -1;
-        _isFullRunMeasuring = false;
-        _lastUpdateTimestamp = millis();
+    // 调用点的当前状态是确定的：表里不允许的切换编译不过
+    // 调试构建再确认调用点写的 From 就是实际状态 (静态检查只保证 From -> To 本身合法)
+    template <SystemState From, SystemState To>
+    void go(TelemetryReason reason, long detail = 0) {
+        static_assert(transitionLegal(From, To), "illegal SystemState transition (see HoistTransitions.h)");
+#if ENABLE_STATE_ASSERTS
+        assert(_currentState == From);
+#endif
+        transition(To, reason, detail);
+    }
+
+    // 调用点的当前状态只知道范围 (指令入口)：整个范围都必须合法，运行时再确认一次
+    template <uint8_t FromMask, SystemState To>
+    bool goFrom(TelemetryReason reason, long detail = 0) {
+        static_assert(transitionsLegal(FromMask, To), "illegal SystemState transition (see HoistTransitions.h)");
+        if (!(FromMask & stateBit(_currentState))) {
+            telemetry.event(EVENT_TRANSITION_REJECTED, _currentState, To);
+            return false;
+        }
+        transition(To, reason, detail);
+        return true;
+    }
+
+    void noop() {}
+
+    // 离开运行状态 (归零 / 上升 / 下降) 一律先停机
+    void exitRun() { motorStopWrapper(); }
+
+    // 进入故障：停机，排队的行程全部作废
+    void enterError() {
         motorStopWrapper();
+        _trips.clear();
     }
 
-    void update() {
-        unsigned long now = millis();
-        long deltaTime = now - _lastUpdateTimestamp;
-        _lastUpdateTimestamp = now;
-
-        // 1. 全局安全检查：撞顶保护
-        // 只有在非下降状态下检测到撞顶，才认为是需要强制停止的紧急情况。
-        if (checkTopSensor() && _currentState != STATE_MOVING_DOWN) {
-            // 除了 IDLE(这种状态下撞顶是正常情况)
-            if (_currentState != STATE_IDLE ) {
-                motorStopWrapper();
-                _currentState = STATE_ERROR; // 标记为错误状态，需要人工干预
-                
-                static unsigned long lastErrorPrintTime = 0;
-                if (millis() - lastErrorPrintTime > 1000) {
-                    Serial.println("⚠️ Limit Hit! Force Stop (Unexpected).");
-                    lastErrorPrintTime = millis();
-                }
+    // 运行中每周期调用：累计本段平均电流；电流持续超限 (堵转 / 卡死) 时停机进入 ERROR，
+    // 几十毫秒内生效，不等耗时检查。启动冲击电流在 CURRENT_INRUSH_BLANK_MS 内不算。
+    // 电机在转却没有新的电流样本 (采样任务卡住 / ADC 出错) 时过流保护失效，每段报告一次，
+    // 仍由耗时和进度检查兜底
+    template <SystemState From>
+    bool stopOnOverCurrent(unsigned long now) {
+        MotorCurrentState current;
+        if (!getMotorCurrent(current)) {
+            if (!_runCurrentLost && now - _runStartTime > CURRENT_INRUSH_BLANK_MS) {
+                _runCurrentLost = true;
+                telemetry.event(EVENT_CURRENT_LOST, From, 0, (int32_t)(now - _runStartTime));
             }
-            _currentPositionMs = 0; // 只要撞顶，物理位置就是0
+            return false;
         }
+        _runCurrentSumMa += current.rmsMa;
+        _runCurrentSamples++;
+        if (now - _runStartTime <= CURRENT_INRUSH_BLANK_MS || !current.overCurrent) return false;
 
-        // 2. 状态机逻辑
-        switch (_currentState) {
-            case STATE_POS_UNKNOWN:
-                // 等待校准指令，不做任何事
-                break;
-
-            case STATE_CALIBRATING:
-                // Safety: Calibration Timeout
-                if (now - _runStartTime > MAX_SAFE_POSITION_MS) {
-                     motorStopWrapper();
-                     _currentState = STATE_ERROR;
-                     Serial.println("⚠️ Calibration Timeout! Sensor failure likely. Force Stop.");
-                     return;
-                }
-
-                // 维护检查：短期异常 (Acute Check) - 仅限全程运行
-                if (_maintenanceMgr && _isFullRunMeasuring) {
-                   long runDuration = now - _runStartTime;
-                   if (_maintenanceMgr->checkAcuteAnomaly(runDuration)) {
-                       motorStopWrapper();
-                       _currentState = STATE_ERROR;
-                       Serial.printf("⚠️ Acute Anomaly! Duration: %ld ms. Force Stop.\n", runDuration);
-                       return;
-                   }
-                }
-
-                if (checkTopSensor()) {
-                    motorStopWrapper();
-                    
-                    // 记录运行数据 (仅在全程且成功时)
-                    if (_maintenanceMgr && _isFullRunMeasuring) {
-                        long duration = now - _runStartTime;
-                        _maintenanceMgr->recordRun(duration);
-                        Serial.printf("📊 Maintenance: Full Run recorded (%ld ms)\n", duration);
-                    } else if (_isFullRunMeasuring) {
-                        // 理论上不会进这里，除非逻辑有误
-                    } else {
-                        Serial.println("ℹ️ Calibration Done (Partial run, no stats recorded).");
-                    }
-
-                    _isFullRunMeasuring = false; // 结束测量
-                    _currentState = STATE_IDLE;
-                    _currentPositionMs = 0;
-                } else {
-                    motorUpWrapper();
-                }
-                break;
-
-            case STATE_MOVING_DOWN:
-                // Safety: Max Position Limit
-                if (_currentPositionMs >= (long)MAX_SAFE_POSITION_MS) {
-                    motorStopWrapper();
-                    _currentState = STATE_ERROR;
-                    Serial.println("⚠️ Max Safe Position Exceeded! Force Stop.");
-                    return;
-                }
-
-                // 软限位：到了虚拟底部？
-                if (_currentPositionMs >= TIME_TO_BOTTOM_MS) {
-                    motorStopWrapper();
-                    _currentState = STATE_IDLE;
-                    Serial.println("🛑 Virtual Bottom Reached.");
-                } 
-                // 到了目标？
-                else if (_currentPositionMs >= _targetPositionMs) {
-                    motorStopWrapper();
-                    _currentState = STATE_IDLE;
-                    Serial.println("✅ Target Reached (Down).");
-                } 
-                else {
-                    motorDownWrapper();
-                    _currentPositionMs += deltaTime; // 积分
-                }
-                break;
-
-            case STATE_MOVING_UP:
-                // 维护检查：短期异常 (Acute Check) - 仅限全程运行
-                if (_maintenanceMgr && _isFullRunMeasuring) {
-                   long runDuration = now - _runStartTime;
-                   if (_maintenanceMgr->checkAcuteAnomaly(runDuration)) {
-                       motorStopWrapper();
-                       _currentState = STATE_ERROR;
-                       Serial.printf("⚠️ Acute Anomaly! Duration: %ld ms. Force Stop.\n", runDuration);
-                       return;
-                   }
-                }
-
-                // 到了目标？
-                if (_currentPositionMs <= _targetPositionMs) {
-                    motorStopWrapper();
-                    _currentState = STATE_IDLE;
-                    Serial.println("✅ Target Reached (Up).");
-                } 
-                else {
-                    motorUpWrapper();
-                    _currentPositionMs -= deltaTime; // 积分
-                    if (_currentPositionMs < 0) _currentPositionMs = 0;
-                }
-                break;
-
-            case STATE_IDLE:
-            case STATE_ERROR:
-                motorStopWrapper();
-                break;
+        go<From, STATE_ERROR>(REASON_OVERCURRENT, current.peakMa);
+        return true;
+    }
+
+    // 维护检查：短期异常 (Acute Check)
+    // 阈值按起点位置和学到的基准在运行开始时算好，这里只比较
+    template <SystemState From>
+    bool stopOnAcuteAnomaly(unsigned long now) {
+        if (!_maintenanceMgr) return false;
+        long runDuration = now - _runStartTime;
+        if (!_maintenanceMgr->checkAcuteAnomaly(runDuration)) return false;
+
+        go<From, STATE_ERROR>(REASON_ACUTE, runDuration);
+        return true;
+    }
+
+    // 卡滞检查：期望位置与超声波 / 顶部传感器实测的位置偏差持续超限，几秒内停机
+    template <SystemState From>
+    bool stopOnStall(unsigned long now) {
+        UltrasonicState sensor;
+        bool haveSensor = getUltrasonicState(sensor);
+        if (!_progress.update(now, getCurrentPosition(), haveSensor ? &sensor : nullptr, checkTopSensor())) {
+            return false;
         }
+        go<From, STATE_ERROR>(REASON_STALL, _progress.getDivergenceMs());
+        return true;
     }
 
-    // --- 指令接口 ---
+    // 上升的期望位置要用学到的速度比，没学到之前进度检查按最宽的比例放宽
+    bool upRateKnown() {
+        return _maintenanceMgr && _maintenanceMgr->isUpRateLearned();
+    }
+
+    void resetRunCurrent() {
+        _runCurrentSumMa = 0;
+        _runCurrentSamples = 0;
+        _runCurrentLost = false;
+    }
+
+    uint32_t getRunMeanCurrentMa() {
+        return _runCurrentSamples ? (uint32_t)(_runCurrentSumMa / _runCurrentSamples) : 0;
+    }
+
+    // 传感器连续无回波：归零时不能再等超时，立即停机
+    bool isTopSensorDead() {
+        UltrasonicState sensor;
+        return getUltrasonicState(sensor) && sensor.health == SENSOR_DEAD;
+    }
+
+    // 等待校准指令，不做任何事
+    void tickUnknown(unsigned long) {}
+
+    void tickIdle(unsigned long) { motorStopWrapper(); }
+
+    void tickError(unsigned long) { motorStopWrapper(); }
+
+    void tickCalibrating(unsigned long now) {
+        // Safety: Calibration Timeout
+        if (now - _runStartTime > MAX_SAFE_POSITION_MS) {
+            go<STATE_CALIBRATING, STATE_ERROR>(REASON_CALIB_TIMEOUT, now - _runStartTime);
+            return;
+        }
+
+        // Safety: 传感器掉线时向上运行等于盲撞，不等超时
+        if (isTopSensorDead()) {
+            go<STATE_CALIBRATING, STATE_ERROR>(REASON_SENSOR_DEAD);
+            return;
+        }
+
+        // Safety: 电流持续超限 (堵转)
+        if (stopOnOverCurrent<STATE_CALIBRATING>(now)) return;
+
+        // 维护检查：短期异常，阈值在 beginHoming() 时按起点算好
+        if (stopOnAcuteAnomaly<STATE_CALIBRATING>(now)) return;
+
+        // Safety: 期望位置与实测位置偏差超限 (卡滞)
+        if (stopOnStall<STATE_CALIBRATING>(now)) return;
+
+        if (checkTopSensor()) {
+            motorStopWrapper(); // 先停机，下面的学习要用到本段最终行程
+
+            // 起点可信的归零都是一次带真实终点的样本，用来更新基准 (故障后的恢复归零起点为 -1)
+            if (_maintenanceMgr && _runStartPositionMs > 0) {
+                _maintenanceMgr->learnRun(-1, _runStartPositionMs, _runStartPositionMs,
+                                          now - _runStartTime);
+                // 同时标定上升/下降速度比，修正之后从下方到达中层的停点
+                _maintenanceMgr->learnTravelRate(PWM_SPEED_UP, (int64_t)_runStartPositionMs * 1000,
+                                                 motionGetRunTravelUs());
+            }
+
+            // 记录运行数据 (仅在全程且成功时)，recordRun 自己会写一帧 TLM_RUN
+            bool recorded = _maintenanceMgr && _isFullRunMeasuring;
+            if (recorded) {
+                _maintenanceMgr->recordRun(now - _runStartTime, getRunMeanCurrentMa());
+            }
+
+            _isFullRunMeasuring = false; // 结束测量
+            motionSetPositionUs(0);
+            go<STATE_CALIBRATING, STATE_IDLE>(REASON_HOMED, recorded ? 1 : 0);
+        } else if (!motionIsRunning()) {
+            motorUpWrapper(MOTION_NO_TARGET); // 一直向上直到限位
+        }
+    }
+
+    void tickMovingDown(unsigned long now) {
+        // Safety: Max Position Limit
+        if (getCurrentPosition() >= (long)MAX_SAFE_POSITION_MS) {
+            go<STATE_MOVING_DOWN, STATE_ERROR>(REASON_MAX_POSITION);
+            return;
+        }
+
+        // Safety: 电流持续超限 (绳子卡住 / 堵转)
+        if (stopOnOverCurrent<STATE_MOVING_DOWN>(now)) return;
+
+        // Safety: 卡滞 (量程内按实测进度，量程外按耗时上限)
+        if (stopOnStall<STATE_MOVING_DOWN>(now)) return;
+        if (stopOnAcuteAnomaly<STATE_MOVING_DOWN>(now)) return;
+
+        // 到了目标？(定时器已在到位瞬间停机，这里只做状态切换)
+        if (motionConsumeTargetReached() || !motionIsRunning()) {
+            _travelSinceHomeMs += abs(getCurrentPosition() - _runStartPositionMs);
+            // 最低一层就是虚拟底部
+            go<STATE_MOVING_DOWN, STATE_IDLE>(_targetFloor == FLOOR_COUNT - 1 ? REASON_VIRTUAL_BOTTOM
+                                                                             : REASON_TARGET_REACHED);
+        }
+    }
 
-    void commandGoTop() {
+    void tickMovingUp(unsigned long now) {
+        // Safety: 电流持续超限 (卡滞 / 堵转)
+        if (stopOnOverCurrent<STATE_MOVING_UP>(now)) return;
+
+        // Safety: 卡滞 (量程内按实测进度，量程外按耗时上限)
+        if (stopOnStall<STATE_MOVING_UP>(now)) return;
+        if (stopOnAcuteAnomaly<STATE_MOVING_UP>(now)) return;
+
+        // 到了目标？(定时器已在到位瞬间停机，这里只做状态切换)
+        if (motionConsumeTargetReached() || !motionIsRunning()) {
+            _travelSinceHomeMs += abs(getCurrentPosition() - _runStartPositionMs);
+            go<STATE_MOVING_UP, STATE_IDLE>(REASON_TARGET_REACHED);
+        }
+    }
+
+    // --- 行程规划 (只由指令接口和 update() 调用) ---
+
+    /**
+     * @brief 向上运行直到顶部传感器，重新建立零点 (原 commandGoTop 的行为)
+     */
+    void beginHoming() {
+        _targetFloor = FLOOR_TOP;
         _targetPositionMs = 0;
-        _currentState = STATE_CALIBRATING; 
         _runStartTime = millis(); // Always reset start time for safety timeout check
+        resetRunCurrent();
+        long positionMs = getCurrentPosition();
+        // 故障后的位置不可信 (卡滞 / 打滑时实际位置和积分出来的不一样)：
+        // 恢复归零按起点未知处理：只用固定耗时上限，不做进度检查 (否则会一直判卡滞、永远归不了零)，
+        // 到顶后也不学习基准 / 速度比、不计入全程统计 (起点是错的，样本会污染历史)
+        _runStartPositionMs = _currentState == STATE_ERROR ? -1 : positionMs;
+        if (_maintenanceMgr) {
+            _maintenanceMgr->beginRun(-1, _runStartPositionMs, positionMs);
+        }
+        _progress.beginRun(-1, _runStartPositionMs, true, upRateKnown());
         
         // 逻辑修正：只在从底部出发时，才开始计时统计
         // 判断当前是否在底部 (允许 500ms 误差)
-        if (_currentPositionMs >= (TIME_TO_BOTTOM_MS - 500)) {
-            _isFullRunMeasuring = true;
-            Serial.println("CMD: Go Top (FULL RUN - Stats Enabled)");
-        } else {
-            _isFullRunMeasuring = false;
-            Serial.println("CMD: Go Top (Partial Run - Stats Ignored)");
+        // 遥测的 detail = 1 表示本次归零会计入统计
+        _isFullRunMeasuring = _runStartPositionMs >= floorPositionMs(FLOOR_COUNT - 1) - 500;
+        // 运行中不能改成归零：顶层请求只会在停下后从队列取出
+        if (!goFrom<stateBits(STATE_IDLE, STATE_POS_UNKNOWN, STATE_ERROR, STATE_CALIBRATING), STATE_CALIBRATING>(
+                REASON_COMMAND, _isFullRunMeasuring ? 1 : 0)) {
+            return;
         }
+        motorUpWrapper(MOTION_NO_TARGET);
     }
 
-    void commandGoMiddle() {
+    /**
+     * @brief 把一个楼层加入队列；空闲时立即出发，运行中若顺路则改为先停这里
+     */
+    void requestFloor(uint8_t floor) {
+        // 位置未知时定时器不会积分，也就无法到位停机，必须先归零
+        // (正在归零时可以排队，归零完成后再执行)
         if (_currentState == STATE_POS_UNKNOWN) return;
-        _targetPositionMs = TIME_TO_MIDDLE_MS;
-        decideDirection();
+        if (getCurrentPosition() < 0 && _currentState != STATE_CALIBRATING) return;
+
+        // 故障状态下的新指令视为人工恢复：丢弃旧队列，从这里重新开始
+        if (_currentState == STATE_ERROR) {
+            _trips.clear();
+            go<STATE_ERROR, STATE_IDLE>(REASON_COMMAND);
+        }
+
+        bool traveling = _currentState != STATE_IDLE;
+        if (_trips.request(floor, traveling ? _targetFloor : FLOOR_NONE) == TRIP_MERGED) return;
+
+        if (!traveling) {
+            startNextTrip();
+        } else if (_currentState == STATE_MOVING_UP || _currentState == STATE_MOVING_DOWN) {
+            retargetOnTheWay();
+        }
     }
 
-    void commandGoBottom() {
-        if (_currentState == STATE_POS_UNKNOWN) return;
-        _targetPositionMs = TIME_TO_BOTTOM_MS;
+    /**
+     * @brief 从队列取下一个楼层并出发
+     */
+    void startNextTrip() {
+        long from = getCurrentPosition();
+        uint8_t floor = _trips.takeNext(from);
+        if (floor == FLOOR_NONE) return;
+
+        // 漂移预算用完：下行之前先归零，原楼层放回队列
+        if (floorPositionMs(floor) > from && _travelSinceHomeMs > (long)TRIP_REHOME_TRAVEL_MS) {
+            _trips.request(floor);
+            telemetry.event(EVENT_REHOME_FIRST, floor, 0, _travelSinceHomeMs);
+            floor = FLOOR_TOP;
+        }
+
+        if (floor == FLOOR_TOP) {
+            beginHoming(); // 顶部只能靠传感器停准，到顶即重新归零
+            return;
+        }
+        _targetFloor = floor;
+        _targetPositionMs = floorPositionMs(floor);
         decideDirection();
     }
-    
-    void emergencyStop() {
-        _currentState = STATE_ERROR;
-        motorStopWrapper();
-    }
-    
-    SystemState getState() {
-        return _currentState;
-    }
 
-    // --- 辅助方法 ---
+    /**
+     * @brief 运行中出现顺路楼层：原目标放回队列，改为先停顺路的楼层
+     * 同方向重新 motionStart 不会重新软启动，只是换了减速点
+     */
+    void retargetOnTheWay() {
+        uint8_t floor = _trips.takeOnTheWay(getCurrentPosition(), _targetPositionMs);
+        if (floor == FLOOR_NONE) return;
+        _trips.request(_targetFloor);
+        telemetry.event(EVENT_STOP_ON_THE_WAY, floor, _targetFloor);
+        _targetFloor = floor;
+        _targetPositionMs = floorPositionMs(floor);
 
+        motorTowardFloor(_currentState == STATE_MOVING_DOWN ? 1 : -1, floor);
+    }
+
+    // 只在 IDLE 下调用 (startNextTrip)
     void decideDirection() {
         // 普通移动指令不参与全程统计
         _isFullRunMeasuring = false;
+        _runStartPositionMs = getCurrentPosition();
+        _runStartTime = millis(); // 电流检查按本段行程屏蔽启动冲击
+        resetRunCurrent();
+
+        // 目标来自编译期校验过的楼层表，不会超过虚拟底部
+        long diff = _targetPositionMs - getCurrentPosition();
+        int direction = diff > 0 ? 1 : -1;
+        if (_maintenanceMgr) _maintenanceMgr->beginRun(direction, _runStartPositionMs, abs(diff));
+        _progress.beginRun(direction, _runStartPositionMs, false, upRateKnown());
 
-        long diff = _targetPositionMs - _currentPositionMs;
-        if (abs(diff) < 200) {
-            _currentState = STATE_IDLE;
+        if (abs(diff) < (long)floorSpec(_targetFloor).toleranceMs) {
+            motorStopWrapper();
+            go<STATE_IDLE, STATE_IDLE>(REASON_TARGET_REACHED);
         } else if (diff > 0) {
-            _currentState = STATE_MOVING_DOWN;
+            _trips.setSweep(1);
+            go<STATE_IDLE, STATE_MOVING_DOWN>(REASON_COMMAND);
+            motorTowardFloor(1, _targetFloor);
         } else {
-            _currentState = STATE_MOVING_UP;
+            _trips.setSweep(-1);
+            go<STATE_IDLE, STATE_MOVING_UP>(REASON_COMMAND);
+            motorTowardFloor(-1, _targetFloor);
         }
     }
 
-    const char* getStateName() {
-        switch(_currentState) {
-            case STATE_IDLE: return "IDLE";
-            case STATE_MOVING_UP: return "UP";
-            case STATE_MOVING_DOWN: return "DOWN";
-            case STATE_POS_UNKNOWN: return "UNKNOWN";
-            case STATE_CALIBRATING: return "CALIB";
-            case STATE_ERROR: return "ERROR";
-            default: return "???";
+public:
+    void bindMaintenanceManager(MaintenanceManager* mgr) {
+        _maintenanceMgr = mgr;
+    }
+
+    void begin() {
+        _currentState = STATE_POS_UNKNOWN;
+        _isFullRunMeasuring = false;
+        _runStartPositionMs = -1;
+        _targetFloor = FLOOR_NONE;
+        _travelSinceHomeMs = 0;
+        _trips.clear();
+        motorStopWrapper();
+        motionSetPositionUs(MOTION_POS_UNKNOWN);
+    }
+
+    /**
+     * @brief 上电时从位置检查点恢复，不归零直接进入 IDLE (begin() 之后调用)
+     */
+    void warmStart(long positionMs, long travelSinceHomeMs) {
+        motionSetPositionUs((int64_t)positionMs * 1000);
+        _travelSinceHomeMs = travelSinceHomeMs;
+        go<STATE_POS_UNKNOWN, STATE_IDLE>(REASON_WARM_START, travelSinceHomeMs);
+    }
+
+    void update() {
+        unsigned long now = millis();
+
+        // 1. 全局安全检查：撞顶保护，各状态的处理方式见 STATE_RULES
+        // 下降中不检查；IDLE 和归零时撞顶是正常情况 (归零由状态逻辑收尾)，其余状态撞顶即故障
+        TopLimitPolicy top = STATE_RULES[_currentState].topLimit;
+        if (top != TOP_IGNORE && checkTopSensor()) {
+            if (top == TOP_FAULT) {
+                goFrom<statesWithTopPolicy(TOP_FAULT), STATE_ERROR>(REASON_LIMIT_HIT); // 需要人工干预
+            }
+            motionSetPositionUs(0); // 只要撞顶，物理位置就是0
+            _travelSinceHomeMs = 0;
+        }
+
+        // 2. 状态机逻辑
+        switch (_currentState) {
+            case STATE_IDLE:        tickIdle(now); break;
+            case STATE_CALIBRATING: tickCalibrating(now); break;
+            case STATE_MOVING_UP:   tickMovingUp(now); break;
+            case STATE_MOVING_DOWN: tickMovingDown(now); break;
+            case STATE_ERROR:       tickError(now); break;
+            case STATE_POS_UNKNOWN: tickUnknown(now); break;
+            default: break;
+        }
+
+        // 3. 当前行程结束：按 SCAN 顺序取下一个停点
+        if (_currentState == STATE_IDLE && !_trips.isEmpty()) {
+            startNextTrip();
         }
     }
+
+    // --- 指令接口 ---
+    // 指令只是把楼层加入停靠队列，不会打断当前行程；同一楼层的请求合并为一个
+
+    /**
+     * @brief 前往楼层 (FloorTable.h 中的下标，FLOOR_TOP 即归零)
+     */
+    void commandGoFloor(uint8_t floor) {
+        if (floor >= FLOOR_COUNT) return;
+
+        // 顶层：位置未知或故障后立即归零，之前排队的行程作废
+        if (floor == FLOOR_TOP &&
+            (_currentState == STATE_POS_UNKNOWN || _currentState == STATE_ERROR ||
+             getCurrentPosition() < 0)) {
+            _trips.clear();
+            beginHoming();
+            return;
+        }
+        requestFloor(floor);
+    }
+    
+    // 停机和清空队列由进入 ERROR (enterError) 完成；已在 ERROR 时电机本来就是停的、队列为空
+    void emergencyStop() {
+        goFrom<STATES_ALL, STATE_ERROR>(REASON_EMERGENCY_STOP);
+    }
+    
+    SystemState getState() {
+        return _currentState;
+    }
+
+    uint8_t getPendingStops() { return _trips.count(); }
+    uint8_t getTargetFloor() { return _targetFloor; }
+    TelemetryReason getLastReason() { return _lastReason; }
+    long getTravelSinceHomeMs() { return _travelSinceHomeMs; }
+
+    const char* getStateName() {
+        return telemetryStateName(_currentState);
+    }
     
-    long getCurrentPosition() { return _currentPositionMs; }
+    /**
+     * @brief 当前位置 (ms)，-1 表示未校准
+     */
+    long getCurrentPosition() {
+        int64_t us = motionGetPositionUs();
+        if (us == MOTION_POS_UNKNOWN) return -1;
+        return (long)(us / 1000);
+    }
+
+    /**
+     * @brief 当前位置 (us 分辨率)，MOTION_POS_UNKNOWN 表示未校准
+     */
+    int64_t getCurrentPositionUs() { return motionGetPositionUs(); }
+};
+
+// 按 SystemState 顺序：{ 进入, 退出 }
+inline const HoistStateMachine::StateHandlers HoistStateMachine::HANDLERS[STATE_COUNT] = {
+    /* STATE_IDLE        */ { &HoistStateMachine::noop, &HoistStateMachine::noop },
+    /* STATE_CALIBRATING */ { &HoistStateMachine::noop, &HoistStateMachine::exitRun },
+    /* STATE_MOVING_UP   */ { &HoistStateMachine::noop, &HoistStateMachine::exitRun },
+    /* STATE_MOVING_DOWN */ { &HoistStateMachine::noop, &HoistStateMachine::exitRun },
+    /* STATE_ERROR       */ { &HoistStateMachine::enterError, &HoistStateMachine::noop },
+    /* STATE_POS_UNKNOWN */ { &HoistStateMachine::noop, &HoistStateMachine::noop },
 };
-#endif HOIST_STATE_MACHINE_H_
\ No newline at end of file
+#endif // HOIST_STATE_MACHINE_H_
\ No newline at end of file
@@ -0,0 +1,76 @@
+#ifndef HOIST_TRANSITIONS_H
+#define HOIST_TRANSITIONS_H
+
+/**
+ * @file HoistTransitions.h
+ * @brief SystemState 的转移表 (编译期常量)
+ * @details 每个状态一行：允许切换到哪些状态、撞顶时怎么处理。
+ *          状态机里的每次切换都写成 go<From, To>() / goFrom<FromMask, To>()，
+ *          用 static_assert 对照这张表，表里没有的切换编译不过。
+ *          - 上升/下降之间不能直接反向，必须先停到 IDLE
+ *          - 运行中不能改成归零 (顶层请求排队，停下后再出发)
+ *          - 没有任何状态能回到 POS_UNKNOWN (只有 begin() 会设置)
+ *          本文件只依赖 Config.h，主机上可以直接编译。
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "Config.h"
+
+// 撞顶 (顶部传感器触发) 时的处理方式
+enum TopLimitPolicy : uint8_t {
+    TOP_IGNORE,   // 不检查 (下降中离开顶部，传感器可能还没释放)
+    TOP_REZERO,   // 正常情况：位置清零
+    TOP_FAULT     // 不应该到顶：停机进入 ERROR，同时清零
+};
+
+constexpr uint8_t stateBit(SystemState s) { return (uint8_t)(1u << s); }
+
+constexpr uint8_t stateBits(SystemState a) { return stateBit(a); }
+template <typename... Rest>
+constexpr uint8_t stateBits(SystemState a, Rest... rest) { return stateBit(a) | stateBits(rest...); }
+
+constexpr uint8_t STATES_ALL = (uint8_t)((1u << STATE_COUNT) - 1);
+
+struct StateRule {
+    SystemState state;
+    TopLimitPolicy topLimit;
+    uint8_t allowedTo; // 可以切换到的状态 (stateBit 的组合)，包括自身
+};
+
+// 按 SystemState 的顺序排列，用状态直接下标
+constexpr StateRule STATE_RULES[STATE_COUNT] = {
+    { STATE_IDLE,        TOP_REZERO, stateBits(STATE_IDLE, STATE_CALIBRATING, STATE_MOVING_UP,
+                                               STATE_MOVING_DOWN, STATE_ERROR) },
+    { STATE_CALIBRATING, TOP_REZERO, stateBits(STATE_CALIBRATING, STATE_IDLE, STATE_ERROR) },
+    { STATE_MOVING_UP,   TOP_FAULT,  stateBits(STATE_MOVING_UP, STATE_IDLE, STATE_ERROR) },
+    { STATE_MOVING_DOWN, TOP_IGNORE, stateBits(STATE_MOVING_DOWN, STATE_IDLE, STATE_ERROR) },
+    { STATE_ERROR,       TOP_FAULT,  stateBits(STATE_ERROR, STATE_IDLE, STATE_CALIBRATING) },
+    { STATE_POS_UNKNOWN, TOP_FAULT,  stateBits(STATE_POS_UNKNOWN, STATE_CALIBRATING, STATE_IDLE,
+                                               STATE_ERROR) },
+};
+
+constexpr bool stateRulesOrdered(int i = 0) {
+    return i == STATE_COUNT || (STATE_RULES[i].state == (SystemState)i && stateRulesOrdered(i + 1));
+}
+static_assert(stateRulesOrdered(), "STATE_RULES must be listed in SystemState order");
+static_assert(STATE_COUNT <= 8, "state masks are 8 bits wide");
+
+constexpr bool transitionLegal(SystemState from, SystemState to) {
+    return (STATE_RULES[from].allowedTo & stateBit(to)) != 0;
+}
+
+// fromMask 里的每个状态都可以切换到 to
+constexpr bool transitionsLegal(uint8_t fromMask, SystemState to, int i = 0) {
+    return i == STATE_COUNT ||
+           ((!(fromMask & (1u << i)) || transitionLegal((SystemState)i, to)) && transitionsLegal(fromMask, to, i + 1));
+}
+
+// 撞顶处理方式为 policy 的所有状态
+constexpr uint8_t statesWithTopPolicy(TopLimitPolicy policy, int i = 0) {
+    return i == STATE_COUNT ? 0
+                            : (uint8_t)((STATE_RULES[i].topLimit == policy ? (1u << i) : 0) |
+                                        statesWithTopPolicy(policy, i + 1));
+}
+
+#endif
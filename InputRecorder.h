@@ -0,0 +1,92 @@
+#ifndef INPUT_RECORDER_H
+#define INPUT_RECORDER_H
+
+/**
+ * @file InputRecorder.h
+ * @brief 录制模式：把状态机的全部外部输入以 TLM_INPUT 帧写入遥测流，供 tools/replay_runner 回放
+ * @details 状态机除时间外只从这几处取输入：指令、isTopLimitPressed()、getUltrasonicState()、
+ *          getMotorCurrent()。控制任务每个周期开头 (处理指令之前) 调用 observe()，只记录变化：
+ *          - 到顶判断的每个边沿
+ *          - 超声波的每个新样本 (按时间戳区分；状态机只在新样本上更新进度检查)
+ *          - 电流：有无有效样本、过流标志变化，或 RMS 变化超过 INPUT_CURRENT_STEP_MA
+ *          回放时在同一毫秒先应用传感器输入、再应用指令，与这里的顺序一致。
+ *          电流按步长量化，回放的单次运行平均电流 (只用于统计) 会有小于步长的偏差。
+ *          硬件上回波 / 电流在 observe() 之后、同一周期的 update() 之前发布时，
+ *          回放晚一个周期看到该样本。
+ */
+
+#include <Arduino.h>
+#include "Config.h"
+#include "hardware_controller.h"
+#include "Telemetry.h"
+
+class InputRecorder {
+private:
+    bool _enabled = false;
+    bool _topLimit = false;
+    bool _haveSensor = false;
+    unsigned long _sensorMs = 0;
+    SensorHealth _health = SENSOR_NOISY;
+    uint8_t _currentFlags = 0;
+    uint32_t _rmsMa = 0;
+
+    static int16_t clamp16(long v) {
+        return v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : (int16_t)v);
+    }
+
+    void observeCurrent() {
+        MotorCurrentState current;
+        bool have = getMotorCurrent(current);
+        uint8_t flags = (have ? 1 : 0) | (have && current.overCurrent ? 2 : 0);
+        uint32_t rms = have ? current.rmsMa : 0;
+        uint32_t step = rms > _rmsMa ? rms - _rmsMa : _rmsMa - rms;
+        if (flags == _currentFlags && step < INPUT_CURRENT_STEP_MA) return;
+        _currentFlags = flags;
+        _rmsMa = rms;
+        telemetry.input(INPUT_CURRENT, flags, clamp16(rms), have ? (int32_t)current.peakMa : 0);
+    }
+
+public:
+    /**
+     * @brief 开始 / 停止录制；开始时把当前输入全部重新记一遍，回放从这里拿到完整的初值
+     */
+    void setEnabled(bool enabled) {
+        if (enabled && !_enabled) {
+            _topLimit = false;
+            _haveSensor = false;
+            _currentFlags = 0;
+            _rmsMa = 0;
+        }
+        _enabled = enabled;
+    }
+
+    bool isEnabled() const { return _enabled; }
+
+    void command(uint8_t type, int16_t arg) {
+        if (_enabled) telemetry.input(INPUT_COMMAND, type, arg);
+    }
+
+    /**
+     * @brief 记录本周期的传感器输入 (控制任务在处理指令之前调用)
+     * @param topLimit 本周期的 isTopLimitPressed()
+     * @param sensor 本周期的 getUltrasonicState()，nullptr 表示还没有样本
+     */
+    void observe(bool topLimit, const UltrasonicState* sensor) {
+        if (!_enabled) return;
+        long distanceMm = sensor ? sensor->distanceMm : -1;
+        if (sensor && (!_haveSensor || sensor->timestampMs != _sensorMs || sensor->health != _health)) {
+            _haveSensor = true;
+            _sensorMs = sensor->timestampMs;
+            _health = sensor->health;
+            telemetry.input(INPUT_SENSOR, sensor->health, clamp16((long)(millis() - sensor->timestampMs)),
+                            distanceMm);
+        }
+        if (topLimit != _topLimit) {
+            _topLimit = topLimit;
+            telemetry.input(INPUT_TOP_LIMIT, topLimit, 0, distanceMm);
+        }
+        observeCurrent();
+    }
+};
+
+#endif
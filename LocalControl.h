@@ -0,0 +1,175 @@
+#ifndef LOCAL_CONTROL_H
+#define LOCAL_CONTROL_H
+
+/**
+ * @file LocalControl.h
+ * @brief 局域网 UDP 控制端点：不经云端直接下发楼层 / 急停，并推送状态
+ * @details 网络任务每次循环调用 service()：
+ *          - 非阻塞地读完已到达的包 (每次最多 LOCAL_MAX_PACKETS_PER_LOOP 个)，
+ *            转换成与 Blynk 相同的 ControlChannel 指令，立即应答
+ *          - 状态、目标楼层或电机输出变化时立即推送给订阅者，否则每 LOCAL_STATUS_PERIOD_MS 推送一次
+ *          Wi-Fi 断开时关闭端口，重新连上后再绑定。协议见 LocalProtocol.h。
+ */
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include "Config.h"
+#include "ControlChannel.h"
+#include "FloorTable.h"
+#include "LocalProtocol.h"
+
+// 共享密钥，在 secrets.h 里定义；没有定义 (为 0) 时拒绝楼层指令，只接受急停和订阅
+#ifndef LOCAL_CONTROL_KEY
+#define LOCAL_CONTROL_KEY 0
+#endif
+
+extern ControlChannel controlChannel;
+
+class LocalControl {
+private:
+    struct Subscriber {
+        IPAddress ip;
+        uint16_t port;          // 0 表示空位
+        unsigned long lastSeen;
+    };
+
+    WiFiUDP _udp;
+    bool _bound = false;
+    Subscriber _subs[LOCAL_MAX_SUBSCRIBERS] = {};
+    uint8_t _pushSeq = 0;
+    unsigned long _lastPushMs = 0;
+    LocalStatusPush _last = {};  // 上一次推送的内容，用于判断是否变化
+
+    void reply(uint8_t seq, uint8_t result) {
+        LocalAck ack;
+        localHeader(ack.header, LOCAL_ACK, seq);
+        ack.result = result;
+        ack.reserved = 0;
+        ack.deviceMs = millis();
+        _udp.beginPacket(_udp.remoteIP(), _udp.remotePort());
+        _udp.write((const uint8_t*)&ack, sizeof(ack));
+        _udp.endPacket();
+    }
+
+    Subscriber* findSubscriber(const IPAddress& ip, uint16_t port) {
+        for (Subscriber& s : _subs) {
+            if (s.port == port && s.ip == ip) return &s;
+        }
+        return nullptr;
+    }
+
+    uint8_t subscribe(const IPAddress& ip, uint16_t port) {
+        Subscriber* s = findSubscriber(ip, port);
+        for (int i = 0; !s && i < LOCAL_MAX_SUBSCRIBERS; i++) {
+            if (_subs[i].port == 0) s = &_subs[i];
+        }
+        if (!s) return LOCAL_NO_SLOT;
+        s->ip = ip;
+        s->port = port;
+        s->lastSeen = millis();
+        _lastPushMs = 0; // 新订阅者马上收到一次完整状态
+        return LOCAL_OK;
+    }
+
+    uint8_t execute(const LocalCommand& cmd) {
+        switch (cmd.header.type) {
+            case LOCAL_GO_FLOOR:
+                if (cmd.arg < 0 || cmd.arg >= FLOOR_COUNT) return LOCAL_BAD_ARG;
+                Serial.printf("[Local] CMD: Go %s\n", floorSpec(cmd.arg).name);
+                return controlChannel.post(CMD_GO_FLOOR, cmd.arg) ? LOCAL_OK : LOCAL_QUEUE_FULL;
+            case LOCAL_EMERGENCY_STOP:
+                Serial.println("[Local] 🚨 EMERGENCY STOP Triggered!");
+                controlChannel.requestEmergencyStop();
+                return LOCAL_OK;
+            case LOCAL_SUBSCRIBE:
+                return subscribe(_udp.remoteIP(), _udp.remotePort());
+            case LOCAL_UNSUBSCRIBE: {
+                Subscriber* s = findSubscriber(_udp.remoteIP(), _udp.remotePort());
+                if (s) s->port = 0;
+                return LOCAL_OK;
+            }
+            default:
+                return LOCAL_BAD_PACKET;
+        }
+    }
+
+    void receive() {
+        for (int i = 0; i < LOCAL_MAX_PACKETS_PER_LOOP; i++) {
+            int size = _udp.parsePacket();
+            if (size <= 0) return;
+
+            LocalCommand cmd = {};
+            int len = _udp.read((uint8_t*)&cmd, sizeof(cmd));
+            if (len < (int)sizeof(LocalHeader) || !localHeaderValid(cmd.header)) continue; // 不是本协议，不应答
+            if (len != (int)sizeof(cmd)) {
+                reply(cmd.header.seq, LOCAL_BAD_PACKET);
+            } else if (LOCAL_CONTROL_KEY == 0 && cmd.header.type == LOCAL_GO_FLOOR) {
+                reply(cmd.header.seq, LOCAL_NO_KEY); // 局域网里任何人都能让电梯动，不允许
+            } else if (LOCAL_CONTROL_KEY != 0 && cmd.key != (uint32_t)LOCAL_CONTROL_KEY) {
+                reply(cmd.header.seq, LOCAL_BAD_KEY);
+            } else {
+                reply(cmd.header.seq, execute(cmd));
+            }
+        }
+    }
+
+    void push(const HoistStatus& status) {
+        LocalStatusPush msg;
+        localHeader(msg.header, LOCAL_STATUS, 0);
+        msg.deviceMs = millis();
+        msg.state = status.state;
+        msg.targetFloor = status.targetFloor;
+        msg.pendingStops = status.pendingStops;
+        msg.topLimit = status.topLimit;
+        msg.duty = status.duty;
+        msg.reserved = 0;
+        msg.positionMs = status.positionMs;
+
+        bool changed = msg.state != _last.state || msg.targetFloor != _last.targetFloor ||
+                       msg.pendingStops != _last.pendingStops || (msg.duty != 0) != (_last.duty != 0) ||
+                       msg.topLimit != _last.topLimit;
+        if (!changed && msg.deviceMs - _lastPushMs < LOCAL_STATUS_PERIOD_MS) return;
+
+        msg.header.seq = _pushSeq++;
+        for (Subscriber& s : _subs) {
+            if (s.port == 0) continue;
+            if (msg.deviceMs - s.lastSeen > LOCAL_SUBSCRIBE_TIMEOUT_MS) {
+                s.port = 0; // 客户端没有续订，视为已离开
+                continue;
+            }
+            _udp.beginPacket(s.ip, s.port);
+            _udp.write((const uint8_t*)&msg, sizeof(msg));
+            _udp.endPacket();
+        }
+        _last = msg;
+        _lastPushMs = msg.deviceMs;
+    }
+
+public:
+    /**
+     * @brief 网络任务每次循环调用
+     * @param status 控制任务最新发布的状态
+     * @param wifiUp Wi-Fi 是否已连接 (与云端是否在线无关)
+     */
+    void service(const HoistStatus& status, bool wifiUp) {
+        if (!wifiUp) {
+            if (_bound) {
+                _udp.stop();
+                _bound = false;
+            }
+            return;
+        }
+        if (!_bound) {
+            _bound = _udp.begin(LOCAL_CONTROL_PORT);
+            if (!_bound) return;
+            Serial.printf("[Local] Listening on %s:%u\n", WiFi.localIP().toString().c_str(), LOCAL_CONTROL_PORT);
+            if (LOCAL_CONTROL_KEY == 0) Serial.println("[Local] ⚠️ LOCAL_CONTROL_KEY not set, floor commands refused");
+        }
+
+        receive();
+        push(status);
+    }
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef LOCAL_PROTOCOL_H
+#define LOCAL_PROTOCOL_H
+
+/**
+ * @file LocalProtocol.h
+ * @brief 局域网 UDP 控制协议 (固件 LocalControl.h 与 tools/local_client.cpp 共用)
+ * @details 每个 UDP 包一条消息，小端，以 LocalHeader 开头：
+ *          - 客户端 -> 设备：LocalCommand (楼层 / 急停 / 订阅)，设备立即回 LocalAck (seq 相同)
+ *          - 设备 -> 订阅者：LocalStatusPush，状态、目标或电机输出变化时立即推送，否则定期推送
+ *          订阅在 LOCAL_SUBSCRIBE_TIMEOUT_MS 内没有刷新就失效，客户端需要定期重发 LOCAL_SUBSCRIBE。
+ *          指令经由 ControlChannel 下发，与 Blynk / 串口走同一个入口。
+ *          本文件只依赖 <stdint.h>，主机上可以直接编译。
+ */
+
+#include <stdint.h>
+
+#define LOCAL_MAGIC 0x5A
+#define LOCAL_VERSION 1
+
+enum LocalPacketType : uint8_t {
+    LOCAL_GO_FLOOR = 1,         // arg = 楼层下标 (FloorTable.h)
+    LOCAL_EMERGENCY_STOP = 2,
+    LOCAL_SUBSCRIBE = 3,        // 开始 / 续订状态推送
+    LOCAL_UNSUBSCRIBE = 4,
+    LOCAL_ACK = 0x81,
+    LOCAL_STATUS = 0x82
+};
+
+enum LocalResult : uint8_t {
+    LOCAL_OK,
+    LOCAL_BAD_PACKET,           // 长度 / 版本不对
+    LOCAL_BAD_KEY,
+    LOCAL_BAD_ARG,
+    LOCAL_QUEUE_FULL,           // 指令队列满，没有执行
+    LOCAL_NO_SLOT,              // 订阅者已满
+    LOCAL_NO_KEY                // 固件没有配置密钥，不接受楼层指令
+};
+
+#pragma pack(push, 1)
+
+struct LocalHeader {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;               // LocalPacketType
+    uint8_t seq;                // 指令由客户端编号，应答原样带回；推送由设备编号
+};
+
+struct LocalCommand {
+    LocalHeader header;
+    uint32_t key;               // 与固件的 LOCAL_CONTROL_KEY 一致才执行
+    int16_t arg;
+};
+
+struct LocalAck {
+    LocalHeader header;
+    uint8_t result;             // LocalResult
+    uint8_t reserved;
+    uint32_t deviceMs;          // 设备收到指令时的 millis()
+};
+
+struct LocalStatusPush {
+    LocalHeader header;
+    uint32_t deviceMs;
+    uint8_t state;              // SystemState
+    uint8_t targetFloor;        // 0xFF 表示无
+    uint8_t pendingStops;
+    uint8_t topLimit;
+    uint8_t duty;               // 实际输出到电机的 PWM，0 表示停止
+    uint8_t reserved;
+    int32_t positionMs;         // -1 表示未知
+};
+
+#pragma pack(pop)
+
+inline void localHeader(LocalHeader& h, uint8_t type, uint8_t seq) {
+    h.magic = LOCAL_MAGIC;
+    h.version = LOCAL_VERSION;
+    h.type = type;
+    h.seq = seq;
+}
+
+inline bool localHeaderValid(const LocalHeader& h) {
+    return h.magic == LOCAL_MAGIC && h.version == LOCAL_VERSION;
+}
+
+inline const char* localResultName(uint8_t result) {
+    static const char* const names[] = { "ok", "bad_packet", "bad_key", "bad_arg", "queue_full", "no_slot", "no_key" };
+    return result < sizeof(names) / sizeof(names[0]) ? names[result] : "?";
+}
+
+#endif
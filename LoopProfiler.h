@@ -0,0 +1,143 @@
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+/**
+ * @file LoopProfiler.h
+ * @brief 主循环分段耗时统计 (min / max / avg / p99)
+ * @details 每个阶段用 CPU 周期计数器测量，结果落到固定大小的 log2 直方图桶里，
+ *          记录只有几次加法，无内存分配、无锁（每个阶段只有一个写者）。
+ *          清零也由写者自己做：其他任务只能 requestReset()，各阶段的写者下一次记录时
+ *          看到请求位再清掉自己的统计，控制任务写 STAGE_HOIST 时不会被网络任务改写。
+ *          ENABLE_LOOP_PROFILER 为 0 时宏全部展开为空。
+ */
+
+#include <Arduino.h>
+#include <atomic>
+#include "Config.h"
+
+enum ProfileStage {
+    STAGE_BLYNK,      // runBlynk()
+    STAGE_HOIST,      // 控制任务一个周期 (指令 + hoist.update() + 状态发布)
+    STAGE_SCHEDULER,  // scheduler.checkTrigger() 及其动作
+    STAGE_STATUS,     // 1s 状态上报块
+    STAGE_LOOP,       // 网络任务一次完整循环
+    STAGE_COUNT
+};
+
+#if ENABLE_LOOP_PROFILER
+
+// 桶 k 覆盖 [2^k, 2^(k+1)) us，24 个桶覆盖到约 16s
+#define PROFILE_HIST_BUCKETS 24
+
+class LoopProfiler {
+private:
+    struct StageStats {
+        uint32_t count;
+        uint32_t minUs;
+        uint32_t maxUs;
+        uint64_t totalUs;
+        uint32_t buckets[PROFILE_HIST_BUCKETS];
+    };
+
+    StageStats _stats[STAGE_COUNT];
+    uint32_t _cyclesPerUs = 240;
+    std::atomic<uint32_t> _resetPending{0}; // 每个阶段一位：等待写者清零
+
+    void clearStage(int stage) {
+        memset(&_stats[stage], 0, sizeof(StageStats));
+        _stats[stage].minUs = UINT32_MAX;
+    }
+
+    static int bucketOf(uint32_t us) {
+        int k = 0;
+        while (us > 1 && k < PROFILE_HIST_BUCKETS - 1) {
+            us >>= 1;
+            k++;
+        }
+        return k;
+    }
+
+public:
+    // 任务启动前调用，此时没有写者
+    void begin() {
+        _cyclesPerUs = getCpuFrequencyMhz();
+        for (int i = 0; i < STAGE_COUNT; i++) clearStage(i);
+        _resetPending.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 请求开始新的统计窗口 (任意任务)；各阶段在下一次 record() 时由写者清零
+     */
+    void requestReset() {
+        _resetPending.store((1u << STAGE_COUNT) - 1, std::memory_order_relaxed);
+    }
+
+    void record(ProfileStage stage, uint32_t cycles) {
+        uint32_t bit = 1u << stage;
+        if (_resetPending.load(std::memory_order_relaxed) & bit) {
+            clearStage(stage);
+            _resetPending.fetch_and(~bit, std::memory_order_relaxed);
+        }
+        uint32_t us = cycles / _cyclesPerUs;
+        StageStats& s = _stats[stage];
+        s.count++;
+        s.totalUs += us;
+        if (us < s.minUs) s.minUs = us;
+        if (us > s.maxUs) s.maxUs = us;
+        s.buckets[bucketOf(us)]++;
+    }
+
+    uint32_t getCount(ProfileStage stage) { return _stats[stage].count; }
+    uint32_t getMaxUs(ProfileStage stage) { return _stats[stage].maxUs; }
+
+    /**
+     * @brief 从直方图估计 p99 (取所在桶的上界，偏保守)
+     */
+    uint32_t getP99Us(ProfileStage stage) {
+        const StageStats& s = _stats[stage];
+        if (s.count == 0) return 0;
+        uint32_t target = s.count - s.count / 100;
+        uint32_t seen = 0;
+        for (int k = 0; k < PROFILE_HIST_BUCKETS; k++) {
+            seen += s.buckets[k];
+            if (seen >= target) return (2u << k) - 1;
+        }
+        return s.maxUs;
+    }
+
+    void dump() {
+        static const char* names[STAGE_COUNT] = { "blynk", "hoist", "sched", "status", "loop" };
+        Serial.println("[Profiler] stage     count      min(us)   avg(us)   p99(us)   max(us)");
+        for (int i = 0; i < STAGE_COUNT; i++) {
+            const StageStats& s = _stats[i];
+            if (s.count == 0) continue;
+            Serial.printf("[Profiler] %-8s %8lu %10lu %9lu %9lu %9lu\n", names[i],
+                          (unsigned long)s.count, (unsigned long)s.minUs,
+                          (unsigned long)(s.totalUs / s.count),
+                          (unsigned long)getP99Us((ProfileStage)i), (unsigned long)s.maxUs);
+        }
+    }
+};
+
+#define PROFILE_BEGIN(stage) uint32_t _profStart_##stage = ESP.getCycleCount()
+#define PROFILE_END(stage)   profiler.record(stage, ESP.getCycleCount() - _profStart_##stage)
+
+#else
+
+// 关闭时保留同样的接口，调用点无需 #if
+class LoopProfiler {
+public:
+    void begin() {}
+    void requestReset() {}
+    uint32_t getCount(ProfileStage) { return 0; }
+    uint32_t getMaxUs(ProfileStage) { return 0; }
+    uint32_t getP99Us(ProfileStage) { return 0; }
+    void dump() { Serial.println("[Profiler] Disabled (ENABLE_LOOP_PROFILER = 0)"); }
+};
+
+#define PROFILE_BEGIN(stage)
+#define PROFILE_END(stage)
+
+#endif // ENABLE_LOOP_PROFILER
+
+#endif
@@ -3,121 +3,240 @@
 
 #include <Arduino.h>
 #include <Preferences.h>
+#include <atomic>
 #include "Config.h"
+#include "ControlChannel.h"
+#include "RunJournal.h"
+#include "RunStatistics.h"
+#include "AcuteBaseline.h"
+#include "TravelRateModel.h"
+#include "Telemetry.h"
 
-// Max history size for long-term analysis
+// Short regression window / demo scenario length
 #define MAX_HISTORY_SIZE 10
 // NVS Namespace
 #define PREF_NAMESPACE "smart_elevator"
 
+// A page that fills up waits in RAM for the next commit; a batch must commit before the next page fills
+static_assert(JOURNAL_BATCH_SIZE < JOURNAL_RECORDS_PER_PAGE, "journal batch must be smaller than a page");
+
+// Persisted with each journal commit: all-time sums up to lastSeq
+struct StatsCheckpoint {
+    RegressionSums sums;
+    uint32_t lastSeq;
+};
+
+// A recorded run on its way from the control task to the journal, with the
+// all-time sums that include it (so the checkpoint matches the journal)
+struct PendingRun {
+    int32_t durationMs;
+    uint32_t meanCurrentMa;
+    RegressionSums allTime;
+};
+
 class MaintenanceManager {
 private:
     Preferences prefs;
-    long history[MAX_HISTORY_SIZE];
-    int historyIndex = 0;
-    int historyCount = 0;
+    RunJournal journal;                // 持久化：追加式日志，成批落盘 (begin() 之后只由网络任务访问)
+    unsigned long lastAppendTime = 0;
+    RegressionSums journalSums = {};   // all-time sums of the newest journaled run (network task)
+    RunStatistics stats;               // 流式统计：10 / 100 / 全部 三个窗口
+    RunStatistics currentStats;        // 每次全程的平均电流 (mA)，第二个磨损指标 (10mA 分辨率)；只恢复滑动窗口
+    long lastRunMs = 0;
+    uint32_t revision = 0; // 历史每变化一次 +1，供状态快照判断是否需要重算
 
     // Baseline for short-term check (Standard Full Rise Time)
-    // In a real scenario, this might be dynamic. For now, we use the config max time.
+    // Used for the demo scenario; the acute check itself uses the learned baseline.
     const long BASELINE_DURATION = TIME_TO_BOTTOM_MS; 
-    const float ACUTE_THRESHOLD_RATIO = 1.3f; // +30%
+    AcuteBaseline acuteBaseline;
+    TravelRateModel travelRates;       // 上升/下降速度比，按 PWM 学习
+    bool travelRatesDirty = false;
+
+    // Control task -> network task: flash is only written from service()
+    SpscQueue<PendingRun, JOURNAL_RECORDS_PER_PAGE> pendingRuns;
+    std::atomic<bool> hoistIdle{true};
+    std::atomic<bool> ratesReady{false};   // ratesCopy waiting; only service() reads it while set
+    TravelRateModel ratesCopy;
 
 public:
     void begin() {
         prefs.begin(PREF_NAMESPACE, false);
-        // Load history count and index if needed, or just start fresh/circular in RAM
-        // For simplicity and robustness, we can just load/save the array index.
-        // But for MVP, let's keep it in RAM and maybe load only necessary stats.
-        // Actually directive says: "Must store history... to Flash".
-        
-        historyIndex = prefs.getInt("h_idx", 0);
-        historyCount = prefs.getInt("h_cnt", 0);
-        
-        // Load array
-        if (historyCount > 0) {
-            prefs.getBytes("history", history, sizeof(history));
-        } else {
-            memset(history, 0, sizeof(history));
+        // Directive: "Must store history... to Flash".
+        // History lives in the run journal; only the newest records are read back.
+        journal.begin(&prefs);
+        migrateLegacyHistory();
+
+        // All-time sums come from the checkpoint; the windows are refilled from
+        // the newest journal records. Records newer than the checkpoint also
+        // go into the all-time sums.
+        StatsCheckpoint ckpt = {};
+        prefs.getBytes("s_all", &ckpt, sizeof(ckpt));
+        stats.restoreAllTime(ckpt.sums);
+
+        JournalRecord recent[RunStatistics::MEDIUM_WINDOW_SIZE];
+        int n = journal.readRecent(recent, RunStatistics::MEDIUM_WINDOW_SIZE);
+        for (int i = 0; i < n; i++) {
+            if (recent[i].seq > ckpt.lastSeq) {
+                stats.add(recent[i].durationMs);
+            } else {
+                stats.addToWindows(recent[i].durationMs);
+            }
+            // 日志的 aux 字段存平均电流，没有电流检测时为 0
+            if (recent[i].aux != 0) currentStats.addToWindows(recent[i].aux);
         }
+        if (n > 0) lastRunMs = recent[n - 1].durationMs;
+
+        travelRates.reset();
+        prefs.getBytes("rates", travelRates.raw(), TravelRateModel::rawSize());
+
+        // Seed the acute baseline from the recorded full runs
+        acuteBaseline.begin();
+        acuteBaseline.seed(stats.mean(WINDOW_SHORT), stats.count(WINDOW_SHORT));
         
         Serial.println("[Maintenance] System Initialized.");
-        Serial.printf("[Maintenance] History Count: %d\n", historyCount);
+        Serial.printf("[Maintenance] History Count: %lu (all-time %lu)\n",
+                      (unsigned long)stats.count(WINDOW_MEDIUM), (unsigned long)stats.count(WINDOW_ALL));
     }
 
     /**
-     * @brief Record a run duration into history and NVS
+     * @brief Record a run duration into history and queue it for the journal
+     * Never touches flash; service() journals it from the network task.
      * @param durationMs Time taken to reach top
+     * @param meanCurrentMa Average motor current over the run, 0 if not measured
      */
-    void recordRun(long durationMs) {
-        history[historyIndex] = durationMs;
-        historyIndex = (historyIndex + 1) % MAX_HISTORY_SIZE;
-        if (historyCount < MAX_HISTORY_SIZE) historyCount++;
-
-        // Save to NVS
-        prefs.putInt("h_idx", historyIndex);
-        prefs.putInt("h_cnt", historyCount);
-        prefs.putBytes("history", history, sizeof(history));
-        
-        Serial.printf("[Maintenance] Recorded Run: %ld ms. History Size: %d\n", durationMs, historyCount);
+    void recordRun(long durationMs, uint32_t meanCurrentMa = 0) {
+        stats.add(durationMs); // O(1) update of every window
+        if (meanCurrentMa != 0) currentStats.add(meanCurrentMa);
+        lastRunMs = durationMs;
+        revision++;
+
+        PendingRun run = { (int32_t)durationMs, meanCurrentMa, stats.allTime() };
+        if (!pendingRuns.push(run)) Serial.println("[Maintenance] Journal queue full, run not journaled");
+
+        telemetry.run(durationMs, stats.count(WINDOW_ALL), acuteBaseline.getLimitMs(), meanCurrentMa);
+        reportWear();
+    }
+
+    /**
+     * @brief Hand idle state and learned rates to the network task. Call every control cycle.
+     * Only copies into RAM; flash is written by service().
+     * @param isIdle true if the hoist is not moving
+     */
+    void update(bool isIdle) {
+        hoistIdle.store(isIdle, std::memory_order_release);
+        if (isIdle && travelRatesDirty && !ratesReady.load(std::memory_order_acquire)) {
+            ratesCopy = travelRates;
+            ratesReady.store(true, std::memory_order_release);
+            travelRatesDirty = false;
+        }
+    }
+
+    /**
+     * @brief Group commit for the journal. Call from the network task loop.
+     * Journals the runs queued by recordRun() and commits them once a batch is
+     * full or the hoist has been idle for a while. Flash is only written while
+     * the hoist is idle: an NVS write stalls the caches of both cores, so it
+     * would stall the control task on a moving hoist too.
+     */
+    void service() {
+        PendingRun run;
+        while (pendingRuns.pop(run)) {
+            journal.append(run.durationMs, run.meanCurrentMa);
+            journalSums = run.allTime;
+            lastAppendTime = millis();
+        }
+
+        if (!hoistIdle.load(std::memory_order_acquire)) return;
+        if (ratesReady.load(std::memory_order_acquire)) {
+            prefs.putBytes("rates", ratesCopy.raw(), TravelRateModel::rawSize());
+            ratesReady.store(false, std::memory_order_release);
+        }
+
+        uint8_t pending = journal.getPendingCount();
+        if (pending == 0) return;
+        if (pending >= JOURNAL_BATCH_SIZE || millis() - lastAppendTime > JOURNAL_IDLE_FLUSH_MS) {
+            journal.flush();
+
+            // All-time sums are checkpointed with the same commit
+            StatsCheckpoint ckpt = { journalSums, journal.getLastSeq() };
+            prefs.putBytes("s_all", &ckpt, sizeof(ckpt));
+        }
+    }
+
+    /**
+     * @brief Prepare the acute check for a new run (threshold computed once here)
+     * @param direction -1 up, +1 down
+     * @param startPositionMs Start position, -1 if unknown
+     * @param distanceMs Expected travel
+     */
+    void beginRun(int direction, long startPositionMs, long distanceMs) {
+        acuteBaseline.beginRun(direction, startPositionMs, distanceMs);
+    }
+
+    /**
+     * @brief Feed a run with a real end point (top limit) into the baseline
+     */
+    void learnRun(int direction, long startPositionMs, long distanceMs, long durationMs) {
+        acuteBaseline.learn(direction, startPositionMs, distanceMs, durationMs);
     }
 
     /**
      * @brief Short-term check: Is the current run taking too long?
+     * O(1): compares against the threshold prepared by beginRun().
      * @param currentDurationMs Current elapsed time of the movement
      * @return true if anomalous (jammed), false otherwise
      */
     bool checkAcuteAnomaly(long currentDurationMs) {
-        long threshold = BASELINE_DURATION * ACUTE_THRESHOLD_RATIO;
-        if (currentDurationMs > threshold) {
-            return true;
-        }
-        return false;
+        return acuteBaseline.isExceeded(currentDurationMs);
     }
 
+    long getAcuteLimitMs() { return acuteBaseline.getLimitMs(); }
+
     /**
-     * @brief Long-term check: Calculate Linear Regression Slope
-     * @return Slope value (ms per run). >0 means getting slower.
+     * @brief Calibrate the up/down speed ratio from a top-limit hit
+     * @param pwm Cruise PWM of the run
+     * @param startPositionUs Where the run started (down units)
+     * @param upTravelUs Travel at nominal up speed, before the ratio is applied
      */
-    double calculateSlope() {
-        if (historyCount < 2) return 0.0;
-
-        double sumX = 0, sumY = 0, sumXY = 0, sumX2 = 0;
-        int n = historyCount;
-
-        // X axis is simply 0, 1, 2... (Run index)
-        // Y axis is Duration (history value)
-        // We need to iterate chronologically.
-        // The oldest item is at (historyIndex - historyCount + MAX_HISTORY_SIZE) % MAX_HISTORY_SIZE?
-        // Simpler: Just treat the buffer as the dataset regardless of order? 
-        // No, order matters for trend.
-        
-        int startIdx = (historyCount < MAX_HISTORY_SIZE) ? 0 : historyIndex; 
-        // If full, historyIndex is the insertion point for NEXT, so it's also the Oldest item.
-        
-        for (int i = 0; i < n; i++) {
-            int bufferIdx = (startIdx + i) % MAX_HISTORY_SIZE;
-            long y = history[bufferIdx];
-            double x = i; // 0 is oldest, n-1 is newest
-
-            sumX += x;
-            sumY += y;
-            sumXY += x * y;
-            sumX2 += x * x;
+    void learnTravelRate(int pwm, int64_t startPositionUs, int64_t upTravelUs) {
+        if (travelRates.learnUp(pwm, startPositionUs, upTravelUs)) {
+            travelRatesDirty = true; // handed to service() by update() when idle
+            telemetry.event(EVENT_UP_RATE, (uint8_t)pwm, 0, (int32_t)travelRates.getUpRateQ16(pwm));
         }
+    }
 
-        double numerator = (n * sumXY) - (sumX * sumY);
-        double denominator = (n * sumX2) - (sumX * sumX);
+    uint32_t getUpRateQ16(int pwm) { return travelRates.getUpRateQ16(pwm); }
+    bool isUpRateLearned() { return travelRates.isLearned(); }
 
-        if (denominator == 0) return 0.0;
-        
-        return numerator / denominator;
+    /**
+     * @brief Long-term check: Linear Regression Slope over a window
+     * O(1): read from running sums maintained by recordRun().
+     * @param window WINDOW_SHORT (last 10), WINDOW_MEDIUM (last 100) or WINDOW_ALL
+     * @return Slope value (ms per run, Q16). >0 means getting slower.
+     *         Saturates at +/-32767 ms per run (see RegressionSums::slope()).
+     */
+    Q16 calculateSlope(StatsWindow window = WINDOW_SHORT) {
+        return stats.slope(window);
     }
 
+    /**
+     * @brief Second wear indicator: trend of the average run current
+     * A rising current at the same duration points at friction / bearing wear.
+     * @return Slope value (mA per run, Q16), from the short or medium window;
+     *         saturates at +/-32767 mA per run like calculateSlope()
+     */
+    Q16 calculateCurrentSlope(StatsWindow window = WINDOW_SHORT) {
+        return currentStats.slope(window);
+    }
+
+    Q8 getMeanCurrentMa(StatsWindow window) { return currentStats.mean(window); }
+
+    Q8 getMeanDuration(StatsWindow window) { return stats.mean(window); }
+    double getDurationVariance(StatsWindow window) { return stats.variance(window); }
+    uint32_t getRunCount(StatsWindow window) { return stats.count(window); }
+
     long getLastRunDuration() {
-        if (historyCount == 0) return 0;
-        // historyIndex points to the NEXT slot, so (historyIndex - 1) is the latest.
-        int lastIdx = (historyIndex - 1 + MAX_HISTORY_SIZE) % MAX_HISTORY_SIZE;
-        return history[lastIdx];
+        return lastRunMs;
     }
 
     // --- Demo / Presentation Features ---
@@ -146,8 +265,10 @@ public:
      * @brief Clears the real history. Call this before starting demo replay.
      */
     void resetHistory() {
-        historyCount = 0;
-        historyIndex = 0;
+        stats.resetWindows(); // all-time sums stay, like the journal itself
+        currentStats.resetWindows();
+        lastRunMs = 0;
+        revision++;
         // Optional: clear NVS if you want persistence to be wiped too
         // prefs.putInt("h_idx", 0); ...
     }
@@ -167,7 +288,9 @@ public:
     /**
      * @brief Access history items safely for visualization replay
      */
-    int getHistoryCount() { return historyCount; }
+    int getHistoryCount() { return stats.count(WINDOW_SHORT); }
+
+    uint32_t getRevision() { return revision; }
     
     // getHistoryItem is no longer needed for Scheme B because we use the return value of injectDemoData
     // but we keep it compatible if needed.
@@ -175,6 +298,53 @@ public:
         // Legacy support if needed, or mapping logic
         return 0; 
     }
+
+private:
+    static uint16_t stddevMs(double variance) {
+        double sd = sqrt(variance);
+        return sd < UINT16_MAX ? (uint16_t)(sd + 0.5) : UINT16_MAX;
+    }
+
+    /**
+     * @brief Publish the windowed statistics after each recorded run (TLM_WEAR)
+     */
+    void reportWear() {
+        TelemetryWear w;
+        w.runCount = getRunCount(WINDOW_ALL);
+        w.shortCount = (uint16_t)getRunCount(WINDOW_SHORT);
+        w.mediumCount = (uint16_t)getRunCount(WINDOW_MEDIUM);
+        w.meanShortMs = getMeanDuration(WINDOW_SHORT).toInt();
+        w.meanMediumMs = getMeanDuration(WINDOW_MEDIUM).toInt();
+        w.meanAllMs = getMeanDuration(WINDOW_ALL).toInt();
+        w.stddevShortMs = stddevMs(getDurationVariance(WINDOW_SHORT));
+        w.stddevMediumMs = stddevMs(getDurationVariance(WINDOW_MEDIUM));
+        w.slopeShortQ16 = calculateSlope(WINDOW_SHORT).raw;
+        w.slopeMediumQ16 = calculateSlope(WINDOW_MEDIUM).raw;
+        telemetry.wear(w);
+    }
+
+    /**
+     * @brief One-time import of the old "history" blob into the journal
+     */
+    void migrateLegacyHistory() {
+        if (journal.getLastSeq() != 0 || !prefs.isKey("history")) return;
+
+        int oldIdx = prefs.getInt("h_idx", 0);
+        int oldCnt = prefs.getInt("h_cnt", 0);
+        long oldHistory[MAX_HISTORY_SIZE];
+        prefs.getBytes("history", oldHistory, sizeof(oldHistory));
+
+        int startIdx = (oldCnt < MAX_HISTORY_SIZE) ? 0 : oldIdx;
+        for (int i = 0; i < oldCnt; i++) {
+            journal.append(oldHistory[(startIdx + i) % MAX_HISTORY_SIZE]);
+        }
+        journal.flush();
+
+        prefs.remove("h_idx");
+        prefs.remove("h_cnt");
+        prefs.remove("history");
+        Serial.printf("[Maintenance] Migrated %d legacy runs into journal.\n", oldCnt);
+    }
 };
 
 #endif
@@ -0,0 +1,55 @@
+#ifndef MOTION_PROFILE_H
+#define MOTION_PROFILE_H
+
+/**
+ * @file MotionProfile.h
+ * @brief 软启动 / 软停止的速度曲线
+ * @details S 曲线 (smoothstep 3t²-2t³) 在编译期生成查找表，运行时只做一次查表和插值，
+ *          可以安全地在定时器回调里每个周期调用。
+ */
+
+#include <Arduino.h>
+
+#define PROFILE_LUT_SIZE 33 // 32 段 + 终点
+#define PROFILE_Q 256       // 查找表数值为 Q8 (0..256)
+
+struct ProfileLut {
+    uint16_t v[PROFILE_LUT_SIZE];
+};
+
+constexpr ProfileLut makeSCurveLut() {
+    ProfileLut lut = {};
+    for (int i = 0; i < PROFILE_LUT_SIZE; i++) {
+        double t = (double)i / (PROFILE_LUT_SIZE - 1);
+        lut.v[i] = (uint16_t)(PROFILE_Q * t * t * (3 - 2 * t) + 0.5);
+    }
+    return lut;
+}
+
+constexpr ProfileLut PROFILE_S_CURVE = makeSCurveLut();
+
+static_assert(PROFILE_S_CURVE.v[0] == 0, "S-curve must start at 0");
+static_assert(PROFILE_S_CURVE.v[PROFILE_LUT_SIZE - 1] == PROFILE_Q, "S-curve must end at full scale");
+
+/**
+ * @brief 斜坡进度 -> Q8 系数
+ * @param progress 已完成量 (超过 span 视为完成)
+ * @param span 斜坡总长
+ */
+inline uint16_t profileRampQ8(int64_t progress, int64_t span) {
+    if (span <= 0 || progress >= span) return PROFILE_Q;
+    if (progress <= 0) return 0;
+    // 线性插值相邻两个表项
+    int64_t scaled = progress * (PROFILE_LUT_SIZE - 1);
+    int idx = (int)(scaled / span);
+    int64_t frac = scaled % span;
+    int a = PROFILE_S_CURVE.v[idx];
+    int b = PROFILE_S_CURVE.v[idx + 1];
+    return (uint16_t)(a + (b - a) * frac / span);
+}
+
+inline int profileLerpDuty(int fromDuty, int toDuty, uint16_t q8) {
+    return fromDuty + (((toDuty - fromDuty) * (int)q8) >> 8);
+}
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef MOTOR_CURRENT_FILTER_H
+#define MOTOR_CURRENT_FILTER_H
+
+/**
+ * @file MotorCurrentFilter.h
+ * @brief 电机电流的分块统计与过流/堵转判断 (BTS7960 IS 输出)
+ * @details 采样以块为单位输入 (连续采样一块约 CURRENT_BLOCK_MS)：
+ *          - 每块算出 RMS 和峰值 (两路 IS 取较大的一路，另一路在该方向上没有电流)
+ *          - RMS 连续 CURRENT_STALL_BLOCKS 块超过 CURRENT_STALL_MA 判定为堵转/过流
+ *          启动冲击电流由状态机按运行时间屏蔽，这里只负责信号本身。
+ *          全部为整数运算，每个样本一次乘加。
+ */
+
+#include <Arduino.h>
+#include "Config.h"
+#include "FixedPoint.h"
+
+struct MotorCurrentState {
+    uint32_t rmsMa;            // 最近一块的 RMS 电流
+    uint32_t peakMa;           // 最近一块的峰值电流
+    bool overCurrent;          // 已持续超限 CURRENT_STALL_BLOCKS 块
+    uint32_t blocks;           // 已处理的块数 (用于发现采样停止)
+    unsigned long timestampMs;
+};
+
+class MotorCurrentFilter {
+private:
+    uint64_t _sumSq[2] = {};
+    uint32_t _count[2] = {};
+    uint32_t _peakMv = 0;
+    uint8_t _overStreak = 0;
+    MotorCurrentState _state = { 0, 0, false, 0, 0 };
+
+    // IS 电压 -> 负载电流：I_load = V / R_IS * k_ILIS
+    static uint32_t mvToMa(uint32_t mv) {
+        return (uint32_t)((uint64_t)mv * CURRENT_SENSE_RATIO / CURRENT_SENSE_RESISTOR_OHM);
+    }
+
+public:
+    /**
+     * @brief 输入一个采样
+     * @param channel 0 = R_IS, 1 = L_IS
+     * @param mv 换算好的电压 (mV)
+     */
+    inline void push(uint8_t channel, uint32_t mv) {
+        _sumSq[channel & 1] += (uint64_t)mv * mv;
+        _count[channel & 1]++;
+        if (mv > _peakMv) _peakMv = mv;
+    }
+
+    /**
+     * @brief 一块结束：算出 RMS / 峰值，更新过流判断
+     */
+    void endBlock(unsigned long nowMs) {
+        uint32_t rmsMv = 0;
+        for (int c = 0; c < 2; c++) {
+            if (_count[c] == 0) continue;
+            uint32_t r = fixedIsqrt(_sumSq[c] / _count[c]);
+            if (r > rmsMv) rmsMv = r;
+            _sumSq[c] = 0;
+            _count[c] = 0;
+        }
+
+        _state.rmsMa = mvToMa(rmsMv);
+        _state.peakMa = mvToMa(_peakMv);
+        _peakMv = 0;
+
+        if (_state.rmsMa > CURRENT_STALL_MA) {
+            if (_overStreak < 0xFF) _overStreak++;
+        } else {
+            _overStreak = 0;
+        }
+        _state.overCurrent = _overStreak >= CURRENT_STALL_BLOCKS;
+        _state.blocks++;
+        _state.timestampMs = nowMs;
+    }
+
+    const MotorCurrentState& state() const { return _state; }
+};
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef NETWORK_LINK_H
+#define NETWORK_LINK_H
+
+/**
+ * @file NetworkLink.h
+ * @brief Wi-Fi / Blynk 连接状态机：非阻塞建连、掉线重连、指数退避
+ * @details 取代阻塞的 Blynk.begin()。service() 每次网络循环调用一次，只推进一步：
+ *            WIFI_CONNECTING -> CLOUD_CONNECTING -> ONLINE
+ *          任何一步失败或掉线都进入 BACKOFF，等待时间每次翻倍 (有上限)，上线后清零。
+ *          每一步最多阻塞 NET_CLOUD_CONNECT_SLICE_MS (Blynk.connect 的超时)，其余都是查询。
+ *          只有 ONLINE 时才调用 Blynk.run()，掉线后不会在 run() 里自己阻塞重连。
+ *          硬件经 NetworkTransport 接口访问，本文件只依赖 <stdint.h>，主机上可以用假的传输层驱动。
+ */
+
+#include <stdint.h>
+
+// 连接所需的底层操作 (实机实现见 blynk_manager.h)
+class NetworkTransport {
+public:
+    virtual void wifiBegin() = 0;                            // 发起 Wi-Fi 连接，立即返回
+    virtual void wifiReset() = 0;                            // 放弃当前连接尝试
+    virtual bool wifiConnected() = 0;
+    virtual bool cloudConnect(uint32_t timeoutMs) = 0;       // 最多阻塞 timeoutMs
+    virtual bool cloudConnected() = 0;
+    virtual void cloudRun() = 0;
+    virtual void cloudDisconnect() = 0;
+};
+
+enum LinkState : uint8_t {
+    LINK_WIFI_CONNECTING,
+    LINK_CLOUD_CONNECTING,
+    LINK_ONLINE,
+    LINK_BACKOFF
+};
+
+struct LinkTiming {
+    uint32_t wifiTimeoutMs;       // 等 Wi-Fi 连上的最长时间
+    uint32_t cloudSliceMs;        // 一次 Blynk.connect 的超时
+    uint32_t backoffMinMs;        // 第一次失败后的等待
+    uint32_t backoffMaxMs;        // 退避上限
+};
+
+class NetworkLink {
+private:
+    NetworkTransport& _transport;
+    LinkTiming _timing;
+    LinkState _state = LINK_BACKOFF;
+    uint32_t _stateSince = 0;
+    uint32_t _retryAt = 0;
+    uint8_t _failures = 0;        // 连续失败次数，决定退避时长
+    uint32_t _reconnects = 0;     // 上线次数 (第一次之后都是重连)
+
+    void enter(LinkState next, uint32_t nowMs) {
+        _state = next;
+        _stateSince = nowMs;
+    }
+
+    void fail(uint32_t nowMs) {
+        uint32_t wait = _timing.backoffMinMs;
+        for (uint8_t i = 0; i < _failures && wait < _timing.backoffMaxMs; i++) wait <<= 1;
+        if (wait > _timing.backoffMaxMs) wait = _timing.backoffMaxMs;
+        if (_failures < 0xFF) _failures++;
+        _retryAt = nowMs + wait;
+        enter(LINK_BACKOFF, nowMs);
+    }
+
+public:
+    NetworkLink(NetworkTransport& transport, const LinkTiming& timing)
+        : _transport(transport), _timing(timing) {}
+
+    /**
+     * @brief 开始连接 (不阻塞)
+     */
+    void begin(uint32_t nowMs) {
+        _failures = 0;
+        _transport.wifiBegin();
+        enter(LINK_WIFI_CONNECTING, nowMs);
+    }
+
+    /**
+     * @brief 推进一步
+     * @return true 表示本次刚刚上线 (调用方可以重发完整状态)
+     */
+    bool service(uint32_t nowMs) {
+        switch (_state) {
+            case LINK_WIFI_CONNECTING:
+                if (_transport.wifiConnected()) {
+                    enter(LINK_CLOUD_CONNECTING, nowMs);
+                } else if (nowMs - _stateSince > _timing.wifiTimeoutMs) {
+                    _transport.wifiReset();
+                    fail(nowMs);
+                }
+                break;
+
+            case LINK_CLOUD_CONNECTING:
+                if (!_transport.wifiConnected()) {
+                    fail(nowMs);
+                } else if (_transport.cloudConnect(_timing.cloudSliceMs)) {
+                    _failures = 0;
+                    _reconnects++;
+                    enter(LINK_ONLINE, nowMs);
+                    return true;
+                } else {
+                    _transport.cloudDisconnect(); // 清掉半开的连接，下次从头握手
+                    fail(nowMs);
+                }
+                break;
+
+            case LINK_ONLINE:
+                if (_transport.wifiConnected() && _transport.cloudConnected()) {
+                    _transport.cloudRun();
+                } else {
+                    _transport.cloudDisconnect();
+                    fail(nowMs);
+                }
+                break;
+
+            case LINK_BACKOFF:
+                if ((int32_t)(nowMs - _retryAt) < 0) break;
+                if (_transport.wifiConnected()) {
+                    enter(LINK_CLOUD_CONNECTING, nowMs);
+                } else {
+                    _transport.wifiBegin();
+                    enter(LINK_WIFI_CONNECTING, nowMs);
+                }
+                break;
+        }
+        return false;
+    }
+
+    LinkState getState() const { return _state; }
+    bool isOnline() const { return _state == LINK_ONLINE; }
+    uint8_t getFailures() const { return _failures; }
+    uint32_t getReconnects() const { return _reconnects; }
+
+    static const char* stateName(LinkState state) {
+        static const char* const names[] = { "wifi", "cloud", "online", "backoff" };
+        return state <= LINK_BACKOFF ? names[state] : "?";
+    }
+};
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef POSITION_CHECKPOINT_H
+#define POSITION_CHECKPOINT_H
+
+/**
+ * @file PositionCheckpoint.h
+ * @brief 位置检查点：静止时把位置存进 NVS，上电后直接从该位置开始，不必先归零
+ * @details 记录分两部分："pos" 存位置和归零以来的行程，"clean" 标记记录是否可信。
+ *          - 静止满 CHECKPOINT_IDLE_MS 后写 pos，再写 clean = 1 (顺序保证写到一半断电时不可信)
+ *          - 离开静止 (开始运行、故障) 时先把 clean 清 0：运行中断电，下次上电必须归零
+ *          - 上电读取：clean、格式版本、楼层表、漂移预算都满足才算可信
+ *          只有状态变化或静止到期时才写 Flash，每次行程最多两次。
+ *          控制任务的 update() 只决定要写什么 (原子标志 + 一份待写记录)，Flash 由网络任务的 service() 写，
+ *          写 Flash 时的长时间阻塞不会落在 1kHz 控制周期里。代价是离开静止到 clean 清 0 之间
+ *          多了最多一圈网络循环的窗口，这期间断电会按旧位置热启动。
+ */
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <atomic>
+#include "Config.h"
+#include "FloorTable.h"
+
+#define CHECKPOINT_PREF_NAMESPACE "position"
+#define CHECKPOINT_VERSION 1
+
+struct PositionRecord {
+    uint8_t version;
+    uint8_t floorCount;          // 楼层表变了 (重新烧录) 就不再相信旧位置
+    int32_t lowestFloorMs;
+    int32_t positionMs;
+    int32_t travelSinceHomeMs;   // 漂移预算接着上次继续算
+};
+
+class PositionCheckpoint {
+private:
+    Preferences _prefs;
+    bool _clean = false;             // Flash 里 clean 标志的当前值 (网络任务)
+
+    // 控制任务 -> 网络任务
+    std::atomic<bool> _wantClean{false};
+    std::atomic<bool> _recordReady{false}; // _record 待写；为 true 时只有网络任务读 _record
+    PositionRecord _record;
+
+    // 控制任务
+    long _savedPositionMs = -1;      // 已交给网络任务的位置
+    unsigned long _idleSince = 0;
+    bool _wasIdle = false;
+
+    void writeClean(bool clean) {
+        if (clean == _clean) return;
+        _prefs.putUChar("clean", clean ? 1 : 0);
+        _clean = clean;
+    }
+
+public:
+    void begin() {
+        _prefs.begin(CHECKPOINT_PREF_NAMESPACE, false);
+        _clean = _prefs.getUChar("clean", 0) != 0;
+    }
+
+    /**
+     * @brief 上电时读取可信位置 (begin() 之后、控制任务启动之前调用)
+     * @param positionMs 输出：位置
+     * @param travelSinceHomeMs 输出：上次归零以来的累计行程
+     * @return false 表示没有可信记录，需要归零
+     */
+    bool restore(long& positionMs, long& travelSinceHomeMs) {
+        PositionRecord rec;
+        bool valid = _clean && _prefs.getBytes("pos", &rec, sizeof(rec)) == sizeof(rec);
+        const char* why = "dirty";
+        if (valid && (rec.version != CHECKPOINT_VERSION || rec.floorCount != FLOOR_COUNT ||
+                      rec.lowestFloorMs != (int32_t)floorPositionMs(FLOOR_COUNT - 1))) {
+            valid = false;
+            why = "floor table changed";
+        } else if (valid && (rec.positionMs < 0 || rec.positionMs > (int32_t)MAX_SAFE_POSITION_MS)) {
+            valid = false;
+            why = "out of range";
+        } else if (valid && rec.travelSinceHomeMs > (int32_t)TRIP_REHOME_TRAVEL_MS) {
+            valid = false;
+            why = "drift budget used up";
+        }
+
+        // 从现在起电梯随时可能运行，记录在下次静止之前都不可信 (任务还没启动，直接写)
+        writeClean(false);
+
+        if (!valid) {
+            Serial.printf("[Checkpoint] No trusted position (%s)\n", why);
+            return false;
+        }
+        positionMs = rec.positionMs;
+        travelSinceHomeMs = rec.travelSinceHomeMs;
+        _savedPositionMs = positionMs;
+        Serial.printf("[Checkpoint] Warm start at %ld ms (%ld ms since home)\n", positionMs, travelSinceHomeMs);
+        return true;
+    }
+
+    /**
+     * @brief 每个控制周期调用一次，只更新要写的内容，不碰 Flash (控制任务)
+     * @param isIdle 电梯静止且位置已知 (STATE_IDLE)
+     */
+    void update(bool isIdle, long positionMs, long travelSinceHomeMs) {
+        if (!isIdle || positionMs < 0) {
+            _wantClean.store(false, std::memory_order_release);
+            _wasIdle = false;
+            return;
+        }
+
+        unsigned long now = millis();
+        if (!_wasIdle) {
+            _wasIdle = true;
+            _idleSince = now;
+        }
+        if (_wantClean.load(std::memory_order_relaxed) && positionMs == _savedPositionMs) return;
+        if (now - _idleSince < CHECKPOINT_IDLE_MS) return;
+
+        if (positionMs != _savedPositionMs) {
+            if (_recordReady.load(std::memory_order_acquire)) return; // 上一份还没写完，下个周期再交
+            _record = { CHECKPOINT_VERSION, FLOOR_COUNT, (int32_t)floorPositionMs(FLOOR_COUNT - 1),
+                        (int32_t)positionMs, (int32_t)travelSinceHomeMs };
+            _recordReady.store(true, std::memory_order_release);
+            _savedPositionMs = positionMs;
+        }
+        // 在记录之后发布：网络任务看到 clean 请求时一定也看得到这份记录
+        _wantClean.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief 把控制任务要求的内容写入 Flash (网络任务每圈调用)
+     * 先读 clean 请求再读记录：clean = 1 之前一定先写 pos；clean = 0 最急，最先写
+     */
+    void service() {
+        bool want = _wantClean.load(std::memory_order_acquire);
+        if (!want) writeClean(false);
+        if (_recordReady.load(std::memory_order_acquire)) {
+            _prefs.putBytes("pos", &_record, sizeof(_record));
+            _recordReady.store(false, std::memory_order_release);
+        }
+        if (want) writeClean(true);
+    }
+};
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef PROGRESS_MONITOR_H
+#define PROGRESS_MONITOR_H
+
+/**
+ * @file ProgressMonitor.h
+ * @brief 运行中的进度检查：期望位置 vs 实测位置
+ * @details 期望位置是运动定时器按实际占空比和学到的速度比积分出来的位置 (ms)；
+ *          实测位置来自顶部的超声波 (量程内) 和到顶判断。两者偏差持续超限即判定卡滞，
+ *          不必等整段行程的耗时上限：
+ *          - 量程内：两者之差按读数做 EWMA (压掉单次读数的噪声)，攒够 PROGRESS_ANCHOR_SAMPLES 个读数时
+ *            记为基准，之后偏差相对基准的增长超过
+ *            PROGRESS_TOLERANCE_MS + 已走行程 × PROGRESS_TOLERANCE_RATIO 即卡滞
+ *          - 上升进量程：从量程外上来时第一次看到吊篮的期望位置 (进量程位置) 从正常的上升中学习；
+ *            期望位置已经过了它、传感器还报“远” (吊篮落在后面)，或者还没到它、传感器已经看到吊篮
+ *            (位置比记录的高，例如上一次下降在量程外打滑)，两者之差同样按行程放宽后判定。
+ *            不用下降离开量程的位置：滤波器从“远”恢复要攒几个读数，上升进量程的位置要晚几秒
+ *          - 归零：期望位置已经到顶 (在 0 处截住)，顶部传感器仍未触发，超时同样按行程放宽
+ *          放宽比例：一般为 PROGRESS_TOLERANCE_RATIO；上升速度比还没学到时按标称速度比积分，放宽到
+ *          PROGRESS_TOLERANCE_RATIO_UNLEARNED，也不做进量程检查；进量程检查用学到的速度比和学到的位置，
+ *          按 PROGRESS_TOLERANCE_RATIO_UP 放宽。
+ *          量程外没有实测位置：上升打滑最早在期望位置进入量程时发现；下降在量程外打滑，本段无从发现
+ *          (电流正常、传感器一直报“远”)，要到下一次上升进量程时才发现。
+ *          其余只能靠电流检测 (MotorCurrentFilter.h) 和耗时上限 (AcuteBaseline.h)。
+ *          超声波读数 (mm) 换算成位置 (ms) 的比例从顶部出发的下降中学习 (位置单位就是下降耗时，
+ *          不依赖上升速度比)：进入量程到离开量程之间的位置差 / 读数差。比例只在 RAM 里，
+ *          上电后第一次从顶部下降出量程之前不做量程内检查，第一次从量程外上升进量程之前不做进量程检查。
+ *          每周期的开销是常数。
+ */
+
+#include <Arduino.h>
+#include "Config.h"
+#include "FixedPoint.h"
+#include "UltrasonicFilter.h"
+
+class ProgressMonitor {
+private:
+    // 学到的换算 (跨行程保留)
+    Q16 _msPerMm;             // 每 mm 读数对应的位置 (ms)
+    bool _scaleLearned = false;
+    long _upEntryMs = -1;     // 上升进量程位置 (ms)，-1 表示还没学到
+
+    // 本段行程
+    int _direction = 0;       // -1 上升, +1 下降
+    bool _homing = false;     // 向上找顶部传感器
+    bool _checking = false;   // 起点已知且该方向的期望位置可信
+    bool _learning = false;   // 从顶部出发的下降，离开量程时学一次比例
+    Q16 _toleranceRatio;      // 本段的放宽比例 (上升速度比没学到时最宽)
+    Q16 _rateErrorRatio;      // 只剩速度比误差时的放宽比例
+    bool _rateKnown = false;  // 上升的期望位置按学到的速度比积分
+    bool _sawFar = false;     // 本段在量程外走过
+    bool _entryDone = false;  // 本段已经处理过进量程
+    long _startMs = -1;
+    unsigned long _sampleMs = 0; // 最近处理过的读数时间戳，每个读数只用一次
+    uint16_t _samples = 0;    // 本段量程内的读数个数
+    long _offsetMs = 0;       // 期望 - 实测 的 EWMA
+    long _anchorOffsetMs = 0; // 基准时的 _offsetMs
+    long _anchorExpectedMs = 0;
+    long _entryExpectedMs = -1; // 量程内的第一个 / 最近一个读数 (学习比例用)
+    int32_t _entryMm = 0;
+    long _lastExpectedMs = 0;
+    int32_t _lastMm = 0;
+    unsigned long _zeroSinceMs = 0; // 归零时期望位置到顶的时刻，0 表示还没到
+    unsigned long _overSinceMs = 0; // 偏差开始超限的时刻，0 表示未超限
+    long _divergenceMs = 0;
+
+    static constexpr Q16 ALPHA = Q16::fromConst(PROGRESS_EWMA_ALPHA);
+    static constexpr Q16 TOLERANCE_RATIO = Q16::fromConst(PROGRESS_TOLERANCE_RATIO);
+    static constexpr Q16 TOLERANCE_RATIO_UP = Q16::fromConst(PROGRESS_TOLERANCE_RATIO_UP);
+    static constexpr Q16 TOLERANCE_RATIO_UNLEARNED = Q16::fromConst(PROGRESS_TOLERANCE_RATIO_UNLEARNED);
+
+    static long absl(long v) { return v < 0 ? -v : v; }
+
+    long allowance(long travelMs) const {
+        return PROGRESS_TOLERANCE_MS + (long)_toleranceRatio.scale(travelMs);
+    }
+
+    long entryAllowance(long travelMs) const {
+        return PROGRESS_TOLERANCE_MS + (long)_rateErrorRatio.scale(travelMs);
+    }
+
+    // 量程内走过的位置差 / 读数差 就是一个比例样本
+    void learnScale() {
+        _learning = false;
+        int32_t spanMm = _lastMm - _entryMm;
+        if (_entryExpectedMs < 0 || spanMm < PROGRESS_MIN_SPAN_MM) return;
+        Q16 sample = Q16::ratio(_lastExpectedMs - _entryExpectedMs, spanMm);
+        if (sample.raw <= 0) return;
+        if (!_scaleLearned) {
+            _msPerMm = sample;
+            _scaleLearned = true;
+        } else {
+            _msPerMm += ALPHA * (sample - _msPerMm);
+        }
+    }
+
+public:
+    /**
+     * @brief 一段行程开始
+     * @param direction -1 上升, +1 下降
+     * @param startPositionMs 起点，-1 表示未知 (不检查)
+     * @param homing true 表示向上直到顶部传感器
+     * @param rateKnown 上升速度比已经学到 (下降方向不需要)；没学到时上升按最宽的比例放宽
+     */
+    void beginRun(int direction, long startPositionMs, bool homing, bool rateKnown) {
+        _direction = direction;
+        _homing = homing;
+        _startMs = startPositionMs;
+        _checking = startPositionMs >= 0;
+        _rateKnown = rateKnown;
+        _sawFar = false;
+        _entryDone = false;
+        _toleranceRatio = direction < 0 && !rateKnown ? TOLERANCE_RATIO_UNLEARNED : TOLERANCE_RATIO;
+        _rateErrorRatio = direction < 0 && !rateKnown ? TOLERANCE_RATIO_UNLEARNED : TOLERANCE_RATIO_UP;
+        _learning = direction > 0 && startPositionMs == 0;
+        _samples = 0;
+        _entryExpectedMs = -1;
+        _zeroSinceMs = 0;
+        _overSinceMs = 0;
+        _divergenceMs = 0;
+    }
+
+    /**
+     * @brief 每个控制周期调用
+     * @param expectedMs 运动定时器的当前位置，-1 表示未知
+     * @param sensor 超声波状态，nullptr 表示没有
+     * @return true 表示偏差持续超限 (卡滞)
+     */
+    bool update(unsigned long now, long expectedMs, const UltrasonicState* sensor, bool topLimit) {
+        if (!_checking && !_learning) return false;
+        if (expectedMs < 0) return false;
+        // 上升到顶：位置刚被清零，由状态逻辑收尾 (下降离开顶部时传感器仍触发，照常检查)
+        if (_direction < 0 && topLimit) {
+            _overSinceMs = 0;
+            return false;
+        }
+
+        bool inRange = sensor && sensor->health == SENSOR_OK && sensor->distanceMm > 0;
+        if (inRange) {
+            if (_entryExpectedMs < 0) {
+                _entryExpectedMs = expectedMs;
+                _entryMm = sensor->distanceMm;
+            }
+            _lastExpectedMs = expectedMs;
+            _lastMm = sensor->distanceMm;
+        } else if (_learning && _entryExpectedMs >= 0 && sensor && sensor->health == SENSOR_FAR) {
+            learnScale();
+        }
+        if (!_checking) return false;
+
+        long excess = 0; // 偏差超出允许值的部分，<= 0 表示正常
+        if (inRange && _scaleLearned && sensor->timestampMs != _sampleMs) {
+            _sampleMs = sensor->timestampMs;
+            long offset = expectedMs - (long)_msPerMm.scale(sensor->distanceMm);
+            _offsetMs = _samples == 0 ? offset : _offsetMs + (offset - _offsetMs) / 4;
+            if (_samples < PROGRESS_ANCHOR_SAMPLES) {
+                _samples++;
+                _anchorOffsetMs = _offsetMs;
+                _anchorExpectedMs = expectedMs;
+            }
+        }
+        bool clamped = _homing && expectedMs == 0; // 期望位置截在 0，吊篮还在走：偏差变化不说明卡滞
+        if (_samples >= PROGRESS_ANCHOR_SAMPLES && !clamped) {
+            _divergenceMs = absl(_offsetMs - _anchorOffsetMs);
+            excess = _divergenceMs - allowance(absl(expectedMs - _anchorExpectedMs));
+        }
+        if (_direction < 0 && _rateKnown && sensor) {
+            // 看得到吊篮说明已过进量程位置，报“远”说明还没到
+            bool far = sensor->health == SENSOR_FAR;
+            if (far) _sawFar = true;
+            if (_upEntryMs >= 0 && (inRange || far)) {
+                long gap = inRange ? expectedMs - _upEntryMs : _upEntryMs - expectedMs;
+                long over = gap - entryAllowance(_startMs - expectedMs);
+                if (over > excess) {
+                    _divergenceMs = gap;
+                    excess = over;
+                }
+            }
+            // 从量程外上来的第一个读数：没有超限就学习进量程位置
+            if (inRange && _sawFar && !_entryDone) {
+                _entryDone = true;
+                if (excess <= 0) {
+                    _upEntryMs = _upEntryMs < 0 ? expectedMs : _upEntryMs + (long)ALPHA.scale(expectedMs - _upEntryMs);
+                }
+            }
+        }
+        if (clamped && !topLimit) {
+            // 位置在 0 处截住，偏差不会再长：改按超时算。最后一次有实测以来的行程按一般比例放宽，
+            // 之前的行程也要算上速度比的误差 (基准只比较偏差的增长，不校正期望位置)
+            if (_zeroSinceMs == 0) _zeroSinceMs = now;
+            long overdue = (long)(now - _zeroSinceMs);
+            long allowed = _samples >= PROGRESS_ANCHOR_SAMPLES
+                               ? allowance(_anchorExpectedMs) + (long)_rateErrorRatio.scale(_startMs - _anchorExpectedMs)
+                               : allowance(_startMs);
+            if (overdue - allowed > excess) {
+                _divergenceMs = overdue;
+                excess = overdue - allowed;
+            }
+        }
+
+        if (excess <= 0) {
+            _overSinceMs = 0;
+            return false;
+        }
+        if (_overSinceMs == 0) _overSinceMs = now;
+        return now - _overSinceMs >= PROGRESS_CONFIRM_MS;
+    }
+
+    // 最近一次的偏差 (ms)，卡滞时作为遥测的 detail
+    long getDivergenceMs() const { return _divergenceMs; }
+
+    bool isScaleLearned() const { return _scaleLearned; }
+    Q16 getMsPerMm() const { return _msPerMm; }
+};
+
+#endif
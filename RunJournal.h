@@ -0,0 +1,196 @@
+#ifndef RUN_JOURNAL_H
+#define RUN_JOURNAL_H
+
+/**
+ * @file RunJournal.h
+ * @brief 运行记录的追加式日志 (Append-only Run Journal)
+ * @details 记录按页存放在 NVS 的 "jp0".."jpN" 中，页号循环使用以分散擦写；
+ *          每条记录自带序号和 CRC32，损坏或半写入的记录在恢复时被丢弃。
+ *          - 写入：append() 只写 RAM，flush() 才落盘 (成批提交)；
+ *            换页时写满的页留在 RAM 里标记为脏，由下一次 flush() 先写它
+ *          - 恢复：只读头指针和头页 (外加下一页的首条记录)，与历史长度无关
+ *          只依赖 Preferences 接口，主机上可以用文件模拟的 Preferences 测试格式。
+ */
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "Config.h"
+
+#define JOURNAL_PAGE_COUNT       8   // 页数 (循环使用)
+#define JOURNAL_RECORDS_PER_PAGE 16  // 每页记录数
+#define JOURNAL_CAPACITY (JOURNAL_PAGE_COUNT * JOURNAL_RECORDS_PER_PAGE)
+
+struct JournalRecord {
+    uint32_t seq;        // 全局递增序号，从 1 开始；0 表示空槽
+    int32_t durationMs;  // 运行耗时
+    uint32_t aux;        // 预留的附加数据
+    uint32_t crc;        // 以上字段的 CRC32
+};
+
+class RunJournal {
+private:
+    Preferences* _prefs = nullptr;
+    JournalRecord _page[JOURNAL_RECORDS_PER_PAGE]; // 当前头页的 RAM 镜像
+    uint8_t _headPage = 0;   // 当前写入的页号
+    uint8_t _pageFill = 0;   // 当前页已用槽数
+    uint32_t _lastSeq = 0;   // 最后一条记录的序号
+    uint8_t _pending = 0;    // 头页尚未落盘的记录数
+    JournalRecord _fullPage[JOURNAL_RECORDS_PER_PAGE]; // 刚写满、尚未落盘的上一页
+    uint8_t _fullPageNo = 0;
+    uint8_t _fullPending = 0; // 上一页尚未落盘的记录数，0 表示不脏
+
+    void writePage(uint8_t page, const JournalRecord* records) {
+        char key[8];
+        pageKey(page, key);
+        _prefs->putBytes(key, records, sizeof(JournalRecord) * JOURNAL_RECORDS_PER_PAGE);
+    }
+
+    static uint32_t crc32(const uint8_t* data, size_t len) {
+        uint32_t crc = 0xFFFFFFFF;
+        for (size_t i = 0; i < len; i++) {
+            crc ^= data[i];
+            for (int b = 0; b < 8; b++) {
+                crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+            }
+        }
+        return ~crc;
+    }
+
+    static uint32_t recordCrc(const JournalRecord& rec) {
+        return crc32((const uint8_t*)&rec, offsetof(JournalRecord, crc));
+    }
+
+    static void pageKey(uint8_t page, char* key) {
+        snprintf(key, 8, "jp%u", page);
+    }
+
+    // 读取一页，返回从头开始连续有效 (CRC 正确且序号递增) 的记录数
+    uint8_t loadPage(uint8_t page, JournalRecord* out) {
+        char key[8];
+        pageKey(page, key);
+        memset(out, 0, sizeof(JournalRecord) * JOURNAL_RECORDS_PER_PAGE);
+        _prefs->getBytes(key, out, sizeof(JournalRecord) * JOURNAL_RECORDS_PER_PAGE);
+
+        uint8_t valid = 0;
+        for (; valid < JOURNAL_RECORDS_PER_PAGE; valid++) {
+            const JournalRecord& rec = out[valid];
+            if (rec.seq == 0 || rec.crc != recordCrc(rec)) break;
+            if (valid > 0 && rec.seq != out[valid - 1].seq + 1) break;
+        }
+        return valid;
+    }
+
+public:
+    /**
+     * @brief 恢复头页，O(1)：头指针 + 头页 + 下一页首条
+     */
+    void begin(Preferences* prefs) {
+        _prefs = prefs;
+        _headPage = _prefs->getUChar("j_head", 0) % JOURNAL_PAGE_COUNT;
+        _pageFill = loadPage(_headPage, _page);
+        _lastSeq = _pageFill ? _page[_pageFill - 1].seq : 0;
+        _pending = 0;
+        _fullPending = 0;
+
+        // 换页时先写新页再写头指针，掉电可能让头指针落后一页
+        if (_pageFill == JOURNAL_RECORDS_PER_PAGE) {
+            JournalRecord next[JOURNAL_RECORDS_PER_PAGE];
+            uint8_t nextPage = (_headPage + 1) % JOURNAL_PAGE_COUNT;
+            uint8_t nextFill = loadPage(nextPage, next);
+            if (nextFill > 0 && next[0].seq == _lastSeq + 1) {
+                _headPage = nextPage;
+                memcpy(_page, next, sizeof(_page));
+                _pageFill = nextFill;
+                _lastSeq = _page[_pageFill - 1].seq;
+                _prefs->putUChar("j_head", _headPage);
+            }
+        }
+    }
+
+    /**
+     * @brief 追加一条记录 (仅写 RAM，不会写 Flash)
+     */
+    void append(int32_t durationMs, uint32_t aux = 0) {
+        if (_pageFill == JOURNAL_RECORDS_PER_PAGE) {
+            // 当前页已满：移到脏页缓冲，由 flush() 写入，再切到下一页。
+            // 成批提交的条数小于一页，缓冲在下一次换页前一定已经写掉；
+            // 只有调用方一整页都没有 flush() 时才会走到这里的同步写入。
+            if (_fullPending) flush();
+            memcpy(_fullPage, _page, sizeof(_page));
+            _fullPageNo = _headPage;
+            _fullPending = _pending;
+            _pending = 0;
+            _headPage = (_headPage + 1) % JOURNAL_PAGE_COUNT;
+            memset(_page, 0, sizeof(_page));
+            _pageFill = 0;
+        }
+
+        JournalRecord& rec = _page[_pageFill++];
+        rec.seq = ++_lastSeq;
+        rec.durationMs = durationMs;
+        rec.aux = aux;
+        rec.crc = recordCrc(rec);
+        _pending++;
+    }
+
+    /**
+     * @brief 把未落盘的记录一次性写入 (每页一次 putBytes：先写满的上一页，再写头页)
+     */
+    void flush() {
+        if (_fullPending) {
+            writePage(_fullPageNo, _fullPage);
+            _fullPending = 0;
+        }
+        if (_pending == 0) return;
+
+        writePage(_headPage, _page);
+        // 新页的第一次提交时更新头指针
+        if (_pageFill == _pending) _prefs->putUChar("j_head", _headPage);
+        _pending = 0;
+    }
+
+    uint8_t getPendingCount() { return _fullPending + _pending; }
+
+    uint32_t getLastSeq() { return _lastSeq; }
+
+    /**
+     * @brief 按时间顺序读取最近 n 条记录 (最多跨 JOURNAL_PAGE_COUNT 页)
+     * @return 实际读到的条数
+     */
+    int readRecent(JournalRecord* out, int n) {
+        if (n > JOURNAL_CAPACITY) n = JOURNAL_CAPACITY;
+        if ((uint32_t)n > _lastSeq) n = _lastSeq;
+
+        // 从头页向前收集，先放在数组末尾
+        int got = 0;
+        int take = min((int)_pageFill, n);
+        memcpy(out + n - take, _page + _pageFill - take, take * sizeof(JournalRecord));
+        got = take;
+
+        JournalRecord page[JOURNAL_RECORDS_PER_PAGE];
+        uint8_t p = _headPage;
+        while (got < n) {
+            p = (p + JOURNAL_PAGE_COUNT - 1) % JOURNAL_PAGE_COUNT;
+            if (p == _headPage) break;
+            uint8_t fill;
+            if (_fullPending && p == _fullPageNo) {
+                memcpy(page, _fullPage, sizeof(page)); // 还没落盘，Flash 里是旧内容
+                fill = JOURNAL_RECORDS_PER_PAGE;
+            } else {
+                fill = loadPage(p, page);
+            }
+            // 旧页必须是满页且序号正好接上
+            if (fill != JOURNAL_RECORDS_PER_PAGE ||
+                page[fill - 1].seq != out[n - got].seq - 1) break;
+            take = min((int)fill, n - got);
+            memcpy(out + n - got - take, page + fill - take, take * sizeof(JournalRecord));
+            got += take;
+        }
+
+        // 没读满时把结果挪到数组开头
+        if (got < n) memmove(out, out + n - got, got * sizeof(JournalRecord));
+        return got;
+    }
+};
+
+#endif
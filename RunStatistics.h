@@ -0,0 +1,178 @@
+#ifndef RUN_STATISTICS_H
+#define RUN_STATISTICS_H
+
+/**
+ * @file RunStatistics.h
+ * @brief 运行耗时的流式统计 (均值 / 方差 / 线性回归斜率)
+ * @details 每个窗口维护 Σy、Σxy、Σy² 三个整数累加和，新增和淘汰都是 O(1)，
+ *          不再每次遍历历史重新求和。x 为窗口内的运行序号 (0 = 最旧)，
+ *          Σx、Σx² 由 n 直接算出。耗时以 10ms 为单位存成 uint16 (最大约 655s)，
+ *          累加和用 int64 精确计算，不存在浮点累计误差；斜率和均值以定点数返回 (FixedPoint.h)。
+ */
+
+#include <Arduino.h>
+#include "FixedPoint.h"
+
+#define STATS_UNIT_MS 10
+#define STATS_FIXED_MAX_N 2000000UL // n(n²−1) 在 int64 内的上限 (约 2.09e6)
+
+enum StatsWindow {
+    WINDOW_SHORT,   // 最近 10 次 (与原 MAX_HISTORY_SIZE 一致)
+    WINDOW_MEDIUM,  // 最近 100 次
+    WINDOW_ALL,     // 全部历史 (只有累加和，不保存样本)
+    WINDOW_COUNT
+};
+
+// 三个累加和 + 样本数；全历史窗口的检查点也用这个结构
+struct RegressionSums {
+    uint32_t n;
+    int64_t sumY;
+    int64_t sumXY;
+    int64_t sumY2;
+
+    /**
+     * @brief 回归斜率 (ms / 次)，Q16
+     * x = 0..n-1 时 Σx、Σx² 有闭式解，公式化简为
+     *   slope = 6·(2Σxy − (n−1)Σy) / (n(n²−1))
+     * 分子分母都是精确的 int64 (n 不超过 STATS_FIXED_MAX_N)，最后只做一次定点除法。
+     * 结果饱和在 Q16 的范围 ±32767 ms/次，不会回绕。真实的老化斜率是每次几毫秒，
+     * 只有窗口里样本很少、前后耗时差几十秒时才会碰到 (如两次运行分别是 10 s 和 50 s)，
+     * 这时返回的是“斜率至少这么大”。tools/fixed_point_test 检查这一点和与浮点版的一致性。
+     */
+    Q16 slope() const {
+        if (n < 2) return Q16();
+        if (n > STATS_FIXED_MAX_N) return Q16::fromRaw((int64_t)(slopeReference() * Q16::ONE));
+        int64_t nn = n;
+        int64_t numerator = 6 * (2 * sumXY - (nn - 1) * sumY);
+        int64_t denominator = nn * (nn * nn - 1);
+        return Q16::fromRaw((int64_t)Q16::ratio(numerator, denominator).raw * STATS_UNIT_MS);
+    }
+
+    // 原来的浮点实现，仅作为基准测试的对照和超大样本数时的后备
+    double slopeReference() const {
+        if (n < 2) return 0.0;
+        int64_t sumX = (int64_t)n * (n - 1) / 2;
+        int64_t sumX2 = (int64_t)(n - 1) * n * (2 * (int64_t)n - 1) / 6;
+        double numerator = (double)n * sumXY - (double)sumX * sumY;
+        double denominator = (double)n * sumX2 - (double)sumX * sumX;
+        if (denominator == 0) return 0.0;
+        return numerator / denominator * STATS_UNIT_MS;
+    }
+
+    // 均值 (ms)，Q8
+    Q8 mean() const {
+        if (n == 0) return Q8();
+        return Q8::ratio(sumY * STATS_UNIT_MS, n);
+    }
+
+    // 方差 (ms²) 可达 1e10 量级，超出 32 位定点范围；只用于诊断输出，保留浮点
+    double variance() const {
+        if (n < 2) return 0.0;
+        double m = (double)sumY / n;
+        return ((double)sumY2 - m * sumY) / (n - 1) * STATS_UNIT_MS * STATS_UNIT_MS;
+    }
+
+    // 新样本放在 x = n
+    void add(uint16_t y) {
+        sumXY += (int64_t)n * y;
+        sumY += y;
+        sumY2 += (int64_t)y * y;
+        n++;
+    }
+
+    // 淘汰 x = 0 的样本，其余样本的 x 全部减 1
+    void evictOldest(uint16_t y) {
+        sumY -= y;
+        sumXY -= sumY;
+        sumY2 -= (int64_t)y * y;
+        n--;
+    }
+};
+
+/**
+ * @brief 固定容量的滑动窗口
+ */
+template <int N>
+class SlidingWindow {
+private:
+    uint16_t _ring[N];
+    int _oldest = 0;
+    RegressionSums _sums = {};
+
+public:
+    void add(uint16_t y) {
+        if ((int)_sums.n == N) {
+            _sums.evictOldest(_ring[_oldest]);
+            _oldest = (_oldest + 1) % N;
+        }
+        _ring[(_oldest + _sums.n) % N] = y;
+        _sums.add(y);
+    }
+
+    void reset() {
+        _oldest = 0;
+        _sums = {};
+    }
+
+    const RegressionSums& sums() const { return _sums; }
+};
+
+class RunStatistics {
+private:
+    SlidingWindow<10> _short;
+    SlidingWindow<100> _medium;
+    RegressionSums _all = {};
+
+    const RegressionSums& sumsOf(StatsWindow w) const {
+        switch (w) {
+            case WINDOW_SHORT:  return _short.sums();
+            case WINDOW_MEDIUM: return _medium.sums();
+            default:            return _all;
+        }
+    }
+
+public:
+    static const int MEDIUM_WINDOW_SIZE = 100;
+
+    static uint16_t toUnits(long durationMs) {
+        if (durationMs <= 0) return 0;
+        long units = (durationMs + STATS_UNIT_MS / 2) / STATS_UNIT_MS;
+        return units > 0xFFFF ? 0xFFFF : (uint16_t)units;
+    }
+
+    /**
+     * @brief 新增一次运行，O(1)
+     */
+    void add(long durationMs) {
+        uint16_t y = toUnits(durationMs);
+        _short.add(y);
+        _medium.add(y);
+        _all.add(y);
+    }
+
+    /**
+     * @brief 只重新填充滑动窗口 (启动时从日志恢复)，不影响全历史累加和
+     */
+    void addToWindows(long durationMs) {
+        uint16_t y = toUnits(durationMs);
+        _short.add(y);
+        _medium.add(y);
+    }
+
+    // 清空滑动窗口；全历史累加和保留
+    void resetWindows() {
+        _short.reset();
+        _medium.reset();
+    }
+
+    void restoreAllTime(const RegressionSums& sums) { _all = sums; }
+    const RegressionSums& allTime() const { return _all; }
+
+    uint32_t count(StatsWindow w) const { return sumsOf(w).n; }
+    Q16 slope(StatsWindow w) const { return sumsOf(w).slope(); }
+    double slopeReference(StatsWindow w) const { return sumsOf(w).slopeReference(); }
+    Q8 mean(StatsWindow w) const { return sumsOf(w).mean(); }
+    double variance(StatsWindow w) const { return sumsOf(w).variance(); }
+};
+
+#endif
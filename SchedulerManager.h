@@ -3,61 +3,167 @@
 
 #include <Arduino.h>
 #include <time.h>
+#include "Config.h"
 
+// Schedule slots (V10 / V11 / V12 map to the first three)
+#define MAX_SCHEDULE_ENTRIES 8
+#define SCHEDULE_SLOT_UP     0
+#define SCHEDULE_SLOT_DOWN   1
+#define SCHEDULE_SLOT_MIDDLE 2
+
+// Weekday mask: bit0 = Sunday ... bit6 = Saturday (same as tm_wday)
+#define WEEKDAYS_ALL 0x7F
+
+// Return values of checkTrigger()
+enum ScheduleAction {
+    SCHED_NONE   = 0,
+    SCHED_UP     = 1,
+    SCHED_DOWN   = 2,
+    SCHED_MIDDLE = 3
+};
+
+struct ScheduleEntry {
+    long secondsOfDay;   // -1 means disabled
+    uint8_t weekdayMask;
+    ScheduleAction action;
+};
+
+/**
+ * @brief Calendar scheduler
+ * The next deadline over all entries is computed once and converted to a
+ * millis() deadline; checkTrigger() is a single compare until it is due.
+ * A deadline missed by a stalled loop still fires if it is at most
+ * SCHEDULE_CATCHUP_SEC late.
+ */
 class SchedulerManager {
 private:
-    long scheduleUpSeconds = -1;   // -1 means disabled
-    long scheduleDownSeconds = -1; // -1 means disabled
-    
-    // Helper to get current seconds since midnight
-    long getCurrentSecondsOfDay() {
-        struct tm timeinfo;
-        if (!getLocalTime(&timeinfo)) {
-            return -1;
+    ScheduleEntry entries[MAX_SCHEDULE_ENTRIES];
+
+    time_t nextEpoch = 0;              // 0 = needs recompute
+    ScheduleAction nextAction = SCHED_NONE;
+    unsigned long deadlineMs = 0;      // millis() at which to look again
+
+    // Local time not synced yet (NTP) if the epoch is before 2020
+    static const time_t MIN_VALID_EPOCH = 1577836800;
+
+    void armIn(long seconds) {
+        unsigned long ms = seconds <= 0 ? 0 : (unsigned long)seconds * 1000;
+        // Wake up periodically anyway so NTP clock corrections are followed
+        if (ms > SCHEDULE_RESYNC_MS) ms = SCHEDULE_RESYNC_MS;
+        deadlineMs = millis() + ms;
+    }
+
+    // Next occurrence of one entry at or after fromEpoch, 0 if none
+    static time_t nextOccurrence(const ScheduleEntry& e, time_t fromEpoch) {
+        if (e.secondsOfDay < 0 || e.weekdayMask == 0) return 0;
+
+        struct tm local;
+        localtime_r(&fromEpoch, &local);
+        time_t midnight = fromEpoch - (local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec);
+
+        for (int day = 0; day <= 7; day++) {
+            time_t t = midnight + (time_t)day * 86400 + e.secondsOfDay;
+            int weekday = (local.tm_wday + day) % 7;
+            if (t >= fromEpoch && (e.weekdayMask & (1 << weekday))) return t;
+        }
+        return 0;
+    }
+
+    // Pick the earliest deadline over all entries
+    void recompute(time_t fromEpoch, time_t now) {
+        nextEpoch = 0;
+        nextAction = SCHED_NONE;
+        for (int i = 0; i < MAX_SCHEDULE_ENTRIES; i++) {
+            time_t t = nextOccurrence(entries[i], fromEpoch);
+            if (t != 0 && (nextEpoch == 0 || t < nextEpoch)) {
+                nextEpoch = t;
+                nextAction = entries[i].action;
+            }
         }
-        return (timeinfo.tm_hour * 3600) + (timeinfo.tm_min * 60) + timeinfo.tm_sec;
+        armIn(nextEpoch ? (long)(nextEpoch - now) : (long)(SCHEDULE_RESYNC_MS / 1000));
+    }
+
+    void invalidate() {
+        nextEpoch = 0;
+        deadlineMs = millis(); // recompute on the next check
     }
 
 public:
     void begin() {
+        reset();
+
         // Init NTP (China Pool)
         configTime(8 * 3600, 0, "ntp.aliyun.com", "pool.ntp.org", "time.nist.gov");
         Serial.println("[Scheduler] NTP Initialized.");
     }
 
-    void setScheduleUp(long seconds) {
-        scheduleUpSeconds = seconds;
-        Serial.printf("[Scheduler] Up Timer set to: %ld s\n", seconds);
+    /**
+     * @brief Disable every entry (no NTP setup, see begin())
+     */
+    void reset() {
+        for (int i = 0; i < MAX_SCHEDULE_ENTRIES; i++) {
+            entries[i] = { -1, WEEKDAYS_ALL, SCHED_NONE };
+        }
+        invalidate();
     }
 
-    void setScheduleDown(long seconds) {
-        scheduleDownSeconds = seconds;
-        Serial.printf("[Scheduler] Down Timer set to: %ld s\n", seconds);
+    /**
+     * @brief Set one calendar entry
+     * @param slot 0..MAX_SCHEDULE_ENTRIES-1
+     * @param seconds Seconds since midnight, -1 disables the slot
+     * @param weekdayMask bit0 = Sunday ... bit6 = Saturday
+     */
+    void setEntry(int slot, long seconds, uint8_t weekdayMask, ScheduleAction action) {
+        if (slot < 0 || slot >= MAX_SCHEDULE_ENTRIES) return;
+        entries[slot] = { seconds, weekdayMask, action };
+        invalidate();
+        Serial.printf("[Scheduler] Slot %d: action %d at %ld s, days 0x%02X\n",
+                      slot, action, seconds, weekdayMask);
     }
 
-    // Returns: 0=None, 1=Trigger Up, 2=Trigger Down
+    void setScheduleUp(long seconds, uint8_t weekdayMask = WEEKDAYS_ALL) {
+        setEntry(SCHEDULE_SLOT_UP, seconds, weekdayMask, SCHED_UP);
+    }
+
+    void setScheduleDown(long seconds, uint8_t weekdayMask = WEEKDAYS_ALL) {
+        setEntry(SCHEDULE_SLOT_DOWN, seconds, weekdayMask, SCHED_DOWN);
+    }
+
+    void setScheduleMiddle(long seconds, uint8_t weekdayMask = WEEKDAYS_ALL) {
+        setEntry(SCHEDULE_SLOT_MIDDLE, seconds, weekdayMask, SCHED_MIDDLE);
+    }
+
+    // Returns: ScheduleAction (0=None, 1=Trigger Up, 2=Trigger Down, 3=Trigger Middle)
     int checkTrigger() {
-        long current = getCurrentSecondsOfDay();
-        if (current < 0) return 0; // Time not set yet
-
-        // Simple trigger logic: check if current second matches target
-        // To avoid multiple triggers, we could store last triggered day or use a window
-        // For MVP, strictly == is fine if loop is fast enough, but a 1-sec tolerance is safer.
-        // Actually, Blynk sends seconds.
-        
-        static long lastCheckedTime = -1;
-        if (current == lastCheckedTime) return 0; // Already checked this second
-        lastCheckedTime = current;
-
-        if (scheduleUpSeconds != -1 && current == scheduleUpSeconds) {
-            return 1;
+        // Fast path: nothing due yet
+        if ((long)(millis() - deadlineMs) < 0) return SCHED_NONE;
+
+        time_t now = time(nullptr);
+        if (now < MIN_VALID_EPOCH) { // Time not set yet
+            armIn(1);
+            return SCHED_NONE;
         }
-        
-        if (scheduleDownSeconds != -1 && current == scheduleDownSeconds) {
-            return 2;
+
+        if (nextEpoch == 0) {
+            recompute(now, now);
+            return SCHED_NONE;
         }
 
-        return 0;
+        if (now < nextEpoch) { // Woke up early (resync or clock correction)
+            armIn((long)(nextEpoch - now));
+            return SCHED_NONE;
+        }
+
+        // Due: fire unless we are too late; then look for the following deadline
+        long late = (long)(now - nextEpoch);
+        ScheduleAction action = nextAction;
+        recompute(nextEpoch + 1, now);
+
+        if (late > SCHEDULE_CATCHUP_SEC) {
+            Serial.printf("[Scheduler] Skipped action %d, missed by %ld s\n", action, late);
+            return SCHED_NONE;
+        }
+        return action;
     }
 };
 
@@ -0,0 +1,43 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+/**
+ * @file Seqlock.h
+ * @brief 单写者最新值邮箱 (seqlock)
+ * @details 写者从不等待；读者在写入过程中读到的不一致数据会被序列号发现并重试。
+ *          适合“只关心最新值”的状态发布，例如传感器结果、控制任务状态。
+ */
+
+#include <Arduino.h>
+#include <atomic>
+
+template <typename T>
+class SeqlockMailbox {
+private:
+    T _value;
+    std::atomic<uint32_t> _seq{0};
+
+public:
+    void publish(const T& value) {
+        uint32_t seq = _seq.load(std::memory_order_relaxed);
+        _seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        _value = value;
+        std::atomic_thread_fence(std::memory_order_release);
+        _seq.store(seq + 2, std::memory_order_relaxed);
+    }
+
+    // 返回 false 表示还没有发布过
+    bool read(T& out) const {
+        uint32_t before, after;
+        do {
+            before = _seq.load(std::memory_order_acquire);
+            out = _value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = _seq.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+        return after != 0;
+    }
+};
+
+#endif
@@ -2,6 +2,7 @@
  * 智能载物机 (Smart Hoist) - MVP Firmware
  * 平台：ESP32 NodeMCU-32S
  * 架构：Layered Architecture (Hardware -> Logic -> Network)
+ * 运行时：控制任务 (APP 核) + 网络任务 (PRO 核)，经 ControlChannel 通信
  */
 
 // 1. 引入各层模块
@@ -10,28 +11,54 @@
 #include "HoistStateMachine.h"    // 业务逻辑层
 #include "MaintenanceManager.h"   // 维护管理模块
 #include "SchedulerManager.h"     // 定时调度模块
+#include "ControlChannel.h"       // 任务间指令/状态通道
+#include "LoopProfiler.h"         // 主循环耗时统计
+#include "Telemetry.h"            // 二进制遥测
+#include "FlightRecorder.h"       // 故障飞行记录
+#include "InputRecorder.h"        // 状态机输入录制
+#include "ControlBenchmark.h"     // 控制路径基准测试
+#include "PositionCheckpoint.h"   // 断电续用的位置检查点
 #include "blynk_manager.h"        // 网络通信层
+#include "LocalControl.h"         // 局域网 UDP 控制
 
 // 2. 全局对象实例化
-// 状态机实例，blynk_manager.h 中通过 'extern' 访问它
+// hoist / maintenance 只属于控制任务；网络任务经 controlChannel 与之交互
 HoistStateMachine hoist;
 MaintenanceManager maintenance;
 SchedulerManager scheduler;
+ControlChannel controlChannel;
+LoopProfiler profiler;
+TelemetryLog telemetry;
+FlightRecorder recorder;
+InputRecorder inputRecorder;        // 只在控制任务里使用
+ControlBenchmark benchmark;
+PositionCheckpoint checkpoint;
+LocalControl localControl;
+
+static void controlTask(void* arg);
+static void networkTask(void* arg);
 
 // ------------------------------------------------
 // Setup: 系统初始化
 // ------------------------------------------------
 void setup() {
+    Serial.setTxBufferSize(TELEMETRY_UART_TX_BUFFER); // 遥测由驱动在后台发出，必须在 begin 之前设置
     Serial.begin(115200);
     delay(500);
     Serial.println("\n>>> Smart Hoist System Booting...");
 
     // A. 初始化硬件层 (GPIO, PWM)
     setupHardware();
+    setupMotionTimer();
     Serial.println(" - Hardware Layer: OK");
 
+    profiler.begin();
+    telemetry.begin();
+    recorder.begin();
+
     // B. 初始化管理模块 (NVS, NTP)
     maintenance.begin();
+    checkpoint.begin();
     scheduler.begin();
     // 绑定维护管理器到状态机
     hoist.bindMaintenanceManager(&maintenance);
@@ -40,134 +67,312 @@ void setup() {
     // 初始化随机种子 (用于 Demo 数据生成)
     randomSeed(analogRead(0));
 
-    // C. 初始化网络层 (Wi-Fi, Blynk)
-    setupBlynk();
-    Serial.println(" - Network Layer: OK");
-
-    // D. 初始化业务逻辑层 (StateMachine)
+    // C. 初始化业务逻辑层 (StateMachine)
     hoist.begin();
     Serial.println(" - Logic Layer: OK");
     
-    // E. 自动开始归零
-    Serial.println(">>> System Ready. Auto-Calibrating...");
-    updateAppStatus("🔄 Auto-Calibrating...");
-    hoist.commandGoTop(); 
+    // D. 有可信的位置检查点就直接可用，否则自动归零 (任务尚未启动，这里可以直接调用状态机)
+    long positionMs, travelSinceHomeMs;
+    if (WARM_START_ENABLED && checkpoint.restore(positionMs, travelSinceHomeMs)) {
+        hoist.warmStart(positionMs, travelSinceHomeMs);
+        Serial.println(">>> System Ready. Position restored.");
+    } else {
+        Serial.println(">>> System Ready. Auto-Calibrating...");
+        updateAppStatus("🔄 Auto-Calibrating...");
+        hoist.commandGoFloor(FLOOR_TOP);
+    }
+
+    // E. 初始化网络层 (Wi-Fi, Blynk)：只发起连接，由网络任务在后台推进
+    setupBlynk();
+    Serial.println(" - Network Layer: Connecting");
+
+    // F. 启动任务
+    xTaskCreatePinnedToCore(controlTask, "control", 4096, nullptr,
+                            CONTROL_TASK_PRIORITY, nullptr, CONTROL_TASK_CORE);
+    xTaskCreatePinnedToCore(networkTask, "network", 8192, nullptr,
+                            NETWORK_TASK_PRIORITY, nullptr, NETWORK_TASK_CORE);
+    Serial.println(" - Tasks: OK");
 }
 
 // ------------------------------------------------
-// Loop: 主循环 (不要使用 delay)
+// Loop: 所有工作都在两个任务里，Arduino 的 loop 任务直接退出
 // ------------------------------------------------
 void loop() {
+    vTaskDelete(nullptr);
+}
+
+// ------------------------------------------------
+// 控制任务：固定周期运行状态机，WiFi 重连不影响它
+// ------------------------------------------------
+static void applyCommand(const HoistCommand& cmd) {
+    switch (cmd.type) {
+        case CMD_GO_FLOOR:       hoist.commandGoFloor((uint8_t)cmd.arg); break;
+        case CMD_EMERGENCY_STOP: hoist.emergencyStop(); break;
+        case CMD_DEMO_START:
+            // 1. 清空当前真实历史，为演示腾出舞台
+            maintenance.resetHistory();
+            // 2. 在后台生成“剧本”，但不写入历史
+            maintenance.generateDemoData();
+            break;
+        case CMD_DEMO_INJECT:
+            // 这一步会真正把数据写入 history 数组，从而改变 calculateSlope 的结果
+            maintenance.injectDemoData(cmd.arg);
+            break;
+        case CMD_SET_RECORDING:
+            inputRecorder.setEnabled(cmd.arg != 0);
+            break;
+        case CMD_RUN_BENCHMARK:
+            benchmark.run(hoist, maintenance);
+            break;
+    }
+}
+
+static void controlTask(void* arg) {
+    HoistStatus status = {};
+    uint32_t publishedRevision = UINT32_MAX;
+    SystemState lastState = hoist.getState();
+    inputRecorder.setEnabled(INPUT_RECORDING_DEFAULT);
+    TickType_t lastWake = xTaskGetTickCount();
+
+    for (;;) {
+        PROFILE_BEGIN(STAGE_HOIST);
+
+        // 传感器输入：录制模式下只记录变化，先于本周期的指令 (回放按同样的顺序应用)
+        bool topLimit = isTopLimitPressed();
+        UltrasonicState sensor;
+        bool haveSensor = getUltrasonicState(sensor);
+        int32_t distanceMm = haveSensor ? sensor.distanceMm : -1;
+        inputRecorder.observe(topLimit, haveSensor ? &sensor : nullptr);
+
+        // 急停不排队，最先处理；队列里在它之前发出的行程请求一并作废
+        bool stopped = controlChannel.takeEmergencyStop();
+        if (stopped) {
+            inputRecorder.command(CMD_EMERGENCY_STOP, 0);
+            hoist.emergencyStop();
+        }
+
+        HoistCommand cmd;
+        while (controlChannel.take(cmd)) {
+            if (stopped && cmd.type == CMD_GO_FLOOR) continue;
+            inputRecorder.command(cmd.type, cmd.arg);
+            applyCommand(cmd);
+        }
+
+        hoist.update();
+
+        // 飞行记录：每周期一条；刚进入 ERROR 时抓下最近一段，由网络任务写 Flash
+        SystemState state = hoist.getState();
+        long positionMs = hoist.getCurrentPosition();
+        recorder.record(state, positionMs, distanceMm, motionGetAppliedDuty());
+        if (state == STATE_ERROR && lastState != STATE_ERROR) {
+            recorder.snapshot(hoist.getLastReason(), lastState);
+        }
+        lastState = state;
+
+        // 静止后记下位置；一离开静止就把检查点标记为不可信
+        checkpoint.update(state == STATE_IDLE, positionMs, hoist.getTravelSinceHomeMs());
+
+        // 运行日志由网络任务成批落盘，这里只告诉它是否空闲
+        maintenance.update(state == STATE_IDLE || state == STATE_POS_UNKNOWN);
+
+        // 发布状态快照；斜率只在历史变化时重算
+        status.state = state;
+        status.stateName = hoist.getStateName();
+        status.positionMs = positionMs;
+        status.topLimit = topLimit;
+        status.pendingStops = hoist.getPendingStops();
+        status.targetFloor = hoist.getTargetFloor();
+        status.duty = (uint8_t)motionGetAppliedDuty();
+        if (maintenance.getRevision() != publishedRevision) {
+            publishedRevision = maintenance.getRevision();
+            status.lastRunMs = maintenance.getLastRunDuration();
+            status.slope = maintenance.calculateSlope().toFloat();
+            status.meanCurrentMa = maintenance.getMeanCurrentMa(WINDOW_SHORT).toInt();
+            status.currentSlope = maintenance.calculateCurrentSlope().toFloat();
+            status.historyVersion = publishedRevision;
+        }
+        controlChannel.publishStatus(status);
+
+        PROFILE_END(STAGE_HOIST);
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(CONTROL_TASK_PERIOD_MS));
+    }
+}
+
+// ------------------------------------------------
+// 网络任务：原 loop() 中除状态机外的全部工作
+// ------------------------------------------------
+static void networkLoop() {
+    HoistStatus status;
+    if (!controlChannel.readStatus(status)) return; // 控制任务还没发布过状态
+
+    PROFILE_BEGIN(STAGE_LOOP);
+
     // 1. 处理网络通信 (心跳、接收指令)
+    PROFILE_BEGIN(STAGE_BLYNK);
     runBlynk();
+    PROFILE_END(STAGE_BLYNK);
 
-    // 2. 运行核心状态机 (高频调用，处理运动控制)
-    hoist.update();
+    // 局域网直连控制：不依赖云端，只要 Wi-Fi 在就可用
+    localControl.service(status, isWifiConnected());
     
-    // 3. 运行调度器检查 (Auto-Run)
+    // 2. 运行调度器检查 (Auto-Run)
+    PROFILE_BEGIN(STAGE_SCHEDULER);
     int schedAction = scheduler.checkTrigger();
-    if (schedAction == 1) { // Auto-Up
+    if (schedAction == SCHED_UP) { // Auto-Up
         // 仅在空闲且未在顶端时执行
-        if (hoist.getState() == STATE_IDLE && !isTopLimitPressed()) {
+        if (status.state == STATE_IDLE && !status.topLimit) {
              Serial.println("[Scheduler] ⏰ Auto-UP Triggered!");
-             hoist.commandGoTop();
+             controlChannel.post(CMD_GO_FLOOR, FLOOR_TOP);
         }
-    } else if (schedAction == 2) { // Auto-Down
-        if (hoist.getState() == STATE_IDLE) {
+    } else if (schedAction == SCHED_DOWN) { // Auto-Down
+        if (status.state == STATE_IDLE) {
              Serial.println("[Scheduler] ⏰ Auto-DOWN Triggered!");
-             hoist.commandGoBottom();
+             controlChannel.post(CMD_GO_FLOOR, FLOOR_BOTTOM);
+        }
+    } else if (schedAction == SCHED_MIDDLE) { // Auto-Middle
+        if (status.state == STATE_IDLE) {
+             Serial.println("[Scheduler] ⏰ Auto-MIDDLE Triggered!");
+             controlChannel.post(CMD_GO_FLOOR, FLOOR_MIDDLE);
         }
     }
+    PROFILE_END(STAGE_SCHEDULER);
 
-    // 4. 定时任务 (状态上报 & 调试日志 & Demo回放)
+    // 3. 定时任务 (状态上报 & 调试日志 & Demo回放)
     static unsigned long lastLog = 0;
+    static unsigned long lastTelemetry = 0;
+
+    // 周期状态帧 (二进制模式下 10Hz，只是写进内存缓冲)
+    if (millis() - lastTelemetry >= TELEMETRY_STATUS_PERIOD_MS) {
+        UltrasonicState sensor = {};
+        bool haveSensor = getUltrasonicState(sensor);
+        telemetry.status(status.state, status.topLimit, status.pendingStops,
+                         haveSensor ? sensor.health : SENSOR_DEAD, status.positionMs,
+                         haveSensor ? sensor.distanceMm : -1);
+        lastTelemetry = millis();
+    }
     
     // --- Demo 模式变量 ---
     static bool isDemoPlaying = false;
     static int demoPlayIndex = 0;
     static unsigned long lastDemoStep = 0;
+    static uint32_t demoSeenVersion = 0;
 
     // A. Demo 数据回放逻辑 (每 500ms 注入并推送一个历史点)
-    if (isDemoPlaying && millis() - lastDemoStep > 500) {
-        // 使用硬编码 10 或从 MaintenanceManager 获取常量 (MAX_HISTORY_SIZE)
-        if (demoPlayIndex < 10) { 
-            // 核心修改：这里不再是“读”，而是“注入” (Inject)
-            // 这一步会真正把数据写入 history 数组，从而改变 calculateSlope 的结果
-            long val = maintenance.injectDemoData(demoPlayIndex);
-            
+    if (isDemoPlaying) {
+        // 控制任务完成注入后，快照版本号会变化，此时推送新点
+        if (demoPlayIndex == 0) {
+            demoSeenVersion = status.historyVersion; // 跳过清空历史带来的变化
+        } else if (status.historyVersion != demoSeenVersion) {
+            demoSeenVersion = status.historyVersion;
+
             // 推送单次耗时
-            Blynk.virtualWrite(V5, (int)val);
+            Blynk.virtualWrite(V5, (int)status.lastRunMs);
             
             // 推送斜率
             // 因为刚刚 inject 了一个新点，现在的 slope 是基于当前已有的点 (1个, 2个...) 计算出来的
             // 这样就实现了斜率的“渐进式变化”
-            Blynk.virtualWrite(V4, maintenance.calculateSlope());
+            Blynk.virtualWrite(V4, status.slope);
 
-            Serial.printf("[Demo] Injecting step [%d]: %ld ms. New Slope: %.2f\n", 
-                          demoPlayIndex, val, maintenance.calculateSlope());
-            
-            demoPlayIndex++;
-            lastDemoStep = millis();
-        } else {
-            isDemoPlaying = false;
-            Serial.println("[Demo] Playback finished.");
-            updateAppStatus("✅ Demo Replay Done");
+            Serial.printf("[Demo] Injected step [%d]: %ld ms. New Slope: %.2f\n", 
+                          demoPlayIndex - 1, status.lastRunMs, status.slope);
+        }
+
+        if (millis() - lastDemoStep > 500) {
+            if (demoPlayIndex < MAX_HISTORY_SIZE) {
+                // 核心修改：这里不再是“读”，而是“注入” (Inject)，由控制任务执行
+                controlChannel.post(CMD_DEMO_INJECT, demoPlayIndex);
+                demoPlayIndex++;
+                lastDemoStep = millis();
+            } else {
+                isDemoPlaying = false;
+                Serial.println("[Demo] Playback finished.");
+                updateAppStatus("✅ Demo Replay Done");
+                invalidateAppCache(); // Demo 直接写过 V4/V5，之后全部重发
+            }
         }
     }
 
     if (millis() - lastLog > 1000) {
-        // A. 串口打印
-        Serial.printf("[State: %s] Pos: %ld ms | Limit: %s\n", 
-                      hoist.getStateName(), 
-                      hoist.getCurrentPosition(),
-                      isTopLimitPressed() ? "HIT" : "OPEN");
-        
-        // B. APP 状态文字更新
-        String statusStr = "✅ " + String(hoist.getStateName());
-        if (isDemoPlaying) statusStr = "📊 Demo Mode: Uploading..."; // Demo 状态提示
-        else if (hoist.getState() == STATE_ERROR) statusStr = "⚠️ ERROR: Check Logs";
-        else if (hoist.getState() == STATE_MOVING_UP) statusStr = "⬆️ Moving Up...";
-        else if (hoist.getState() == STATE_MOVING_DOWN) statusStr = "⬇️ Moving Down...";
-        else if (hoist.getState() == STATE_CALIBRATING) statusStr = "🔄 Calibrating...";
-        updateAppStatus(statusStr.c_str());
+        PROFILE_BEGIN(STAGE_STATUS);
+
+        // A. 串口状态行已由上面的遥测状态帧取代
+
+        // B. APP 状态文字更新 (查表，未变化时不发送)
+        if (isDemoPlaying) updateAppStatus("📊 Demo Mode: Uploading..."); // Demo 状态提示
+        else updateAppStatus(getStateStatusText(status.state));
 
         // C. APP 图表数据更新 (非 Demo 模式下正常推送)
         if (!isDemoPlaying) {
-             updateAppMaintenanceData(maintenance.getLastRunDuration(), maintenance.calculateSlope());
+             updateAppMaintenanceData(status.lastRunMs, status.slope);
+             updateAppCurrentData(status.meanCurrentMa, status.currentSlope);
         }
 
+        // D. 主循环耗时 (用于排查停层过冲)
+        updateAppLoopLatency(profiler.getMaxUs(STAGE_LOOP), profiler.getP99Us(STAGE_LOOP));
+
         lastLog = millis();
+        PROFILE_END(STAGE_STATUS);
     }
 
-    // 5. 串口指令控制 (调试神器)
+    // 4. 串口指令控制 (调试神器)
     if (Serial.available()) {
         char cmd = Serial.read();
-        // 忽略换行符
-        if (cmd == '\n' || cmd == '\r') return;
 
         switch (cmd) {
-            case 't': hoist.commandGoTop(); break;
-            case 'm': hoist.commandGoMiddle(); break;
-            case 'b': hoist.commandGoBottom(); break;
-            case 's': hoist.emergencyStop(); break;
+            case '\n': case '\r': break; // 忽略换行符
+            case 't': controlChannel.post(CMD_GO_FLOOR, FLOOR_TOP); break;
+            case 'm': controlChannel.post(CMD_GO_FLOOR, FLOOR_MIDDLE); break;
+            case 'b': controlChannel.post(CMD_GO_FLOOR, FLOOR_BOTTOM); break;
+            case 's': controlChannel.requestEmergencyStop(); break;
             case 'p': setMockTopLimit(true); break;  // 按下开关
             case 'r': setMockTopLimit(false); break; // 松开开关
+            case 'L': // 打印主循环分段耗时，并开始新的统计窗口
+                profiler.dump();
+                profiler.requestReset();
+                break;
+            case 'R': { // 切换输入录制 (tools/telemetry_decode --report 分析)
+                static bool recording = INPUT_RECORDING_DEFAULT;
+                recording = !recording;
+                controlChannel.post(CMD_SET_RECORDING, recording ? 1 : 0);
+                Serial.printf("[Record] Input recording %s\n", recording ? "ON" : "OFF");
+                break;
+            }
+            case 'B': // 控制路径基准测试，逐项与周期预算比较
+                controlChannel.post(CMD_RUN_BENCHMARK);
+                break;
+            case 'F': // 导出上一次故障的飞行记录 (tools/telemetry_decode 解码)
+                recorder.dump();
+                break;
             case 'D': // [New] Demo Mode
                 Serial.println(">>> Starting Demo Mode (Scheme B: Progressive Slope)...");
-                // 1. 清空当前真实历史，为演示腾出舞台
-                maintenance.resetHistory();
-                // 2. 在后台生成“剧本”，但不写入历史
-                maintenance.generateDemoData();
-                // 3. 开始回放，由 Loop 负责一步步注入数据
+                // 1~2. 清空历史并生成剧本 (控制任务执行)
+                controlChannel.post(CMD_DEMO_START);
+                // 3. 开始回放，由本任务负责一步步下发注入指令
                 isDemoPlaying = true;
                 demoPlayIndex = 0;
+                lastDemoStep = millis();
                 break;
-            case 'x': 
-                // 模拟一个异常长的运行 (调试用)
-                Serial.println("Simulating jammed run...");
-                // 实际很难直接注入，只能依赖手动不按开关让它超时
-                break; 
+            case 'x': { // 模拟卡死 (仅仿真模式)：电机不动、电流升到堵转值，再按一次解除
+                static bool jammed = false;
+                jammed = !jammed;
+                setMockJam(jammed);
+                Serial.printf("Simulated jam %s\n", jammed ? "ON" : "OFF");
+                break;
+            }
             default: Serial.printf("Unknown command: %c\n", cmd); break;
         }
     }
+
+    PROFILE_END(STAGE_LOOP);
+}
+
+static void networkTask(void* arg) {
+    for (;;) {
+        networkLoop();
+        recorder.service(); // 控制任务抓下的故障快照在这里写 Flash
+        checkpoint.service(); // 位置检查点同样在这里写 Flash
+        maintenance.service(); // 运行日志、统计检查点和速度比 (只在电梯空闲时写)
+        telemetry.drain(); // 只写串口不会阻塞的量
+        vTaskDelay(1); // 让出 CPU 给同核的 WiFi/IDLE 任务
+    }
 }
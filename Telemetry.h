@@ -0,0 +1,191 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+/**
+ * @file Telemetry.h
+ * @brief 二进制遥测：状态切换 / 运行记录 / 周期状态写入内存环形缓冲，由网络任务非阻塞发送
+ * @details 控制路径上只做一次 ~20 字节的拷贝 (自旋锁保护，允许多个任务写入)，
+ *          从不等待串口。drain() 每次只写 Serial.availableForWrite() 允许的字节数，
+ *          剩下的交给 UART 驱动的发送缓冲区在后台发出。缓冲区满时整帧丢弃并计数，
+ *          丢帧数随下一个状态帧上报。帧格式见 TelemetryFormat.h，解码工具见 tools/telemetry_decode.cpp。
+ *          ENABLE_BINARY_TELEMETRY 为 0 时接口不变，改为直接打印文本 (原来的行为)。
+ */
+
+#include <Arduino.h>
+#include <atomic>
+#include <esp_system.h>
+#include "Config.h"
+#include "TelemetryFormat.h"
+#include "FloorTable.h"
+
+#if ENABLE_BINARY_TELEMETRY
+
+static_assert((TELEMETRY_RING_SIZE & (TELEMETRY_RING_SIZE - 1)) == 0, "TELEMETRY_RING_SIZE must be a power of two");
+
+class TelemetryLog {
+private:
+    uint8_t _ring[TELEMETRY_RING_SIZE];
+    std::atomic<uint32_t> _head{0}; // 写入位置 (只增不减，取模使用)
+    std::atomic<uint32_t> _tail{0}; // 发送位置
+    uint8_t _seq = 0;
+    uint16_t _dropped = 0;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+
+    bool emit(TelemetryType type, const void* payload, uint8_t len) {
+        uint8_t frame[TLM_MAX_FRAME];
+        uint32_t ts = millis();
+        uint32_t size = TLM_HEADER_SIZE + len + 1;
+
+        portENTER_CRITICAL(&_mux);
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        if (TELEMETRY_RING_SIZE - (head - _tail.load(std::memory_order_acquire)) < size) {
+            if (_dropped < UINT16_MAX) _dropped++;
+            portEXIT_CRITICAL(&_mux);
+            return false;
+        }
+        telemetryEncode(frame, type, _seq++, ts, payload, len);
+        for (uint32_t i = 0; i < size; i++) {
+            _ring[(head + i) & (TELEMETRY_RING_SIZE - 1)] = frame[i];
+        }
+        _head.store(head + size, std::memory_order_release);
+        portEXIT_CRITICAL(&_mux);
+        return true;
+    }
+
+public:
+    void begin() {
+        TelemetryBoot boot = { (uint8_t)esp_reset_reason(), FLOOR_COUNT };
+        emit(TLM_BOOT, &boot, sizeof(boot));
+    }
+
+    void stateChange(uint8_t from, uint8_t to, TelemetryReason reason, uint8_t floor,
+                     long positionMs, long detail) {
+        TelemetryState p = { from, to, (uint8_t)reason, floor, (int32_t)positionMs, (int32_t)detail };
+        emit(TLM_STATE, &p, sizeof(p));
+    }
+
+    void status(uint8_t state, bool topLimit, uint8_t pendingStops, uint8_t sensorHealth,
+                long positionMs, int32_t distanceMm) {
+        TelemetryStatus p = { state, (uint8_t)topLimit, pendingStops, sensorHealth,
+                              (int32_t)positionMs, (int16_t)distanceMm, _dropped };
+        // 只有状态帧真正写进缓冲区，才扣掉它带出去的丢帧数
+        if (emit(TLM_STATUS, &p, sizeof(p))) {
+            portENTER_CRITICAL(&_mux);
+            _dropped -= p.dropped;
+            portEXIT_CRITICAL(&_mux);
+        }
+    }
+
+    void run(long durationMs, uint32_t runCount, long acuteLimitMs, uint32_t currentMa) {
+        TelemetryRun p = { (int32_t)durationMs, runCount, (int32_t)acuteLimitMs, (int32_t)currentMa };
+        emit(TLM_RUN, &p, sizeof(p));
+    }
+
+    void input(TelemetryInputKind kind, uint8_t a, int16_t arg = 0, int32_t value = 0) {
+        TelemetryInput p = { (uint8_t)kind, a, arg, value };
+        emit(TLM_INPUT, &p, sizeof(p));
+    }
+
+    void wear(const TelemetryWear& p) {
+        emit(TLM_WEAR, &p, sizeof(p));
+    }
+
+    void event(TelemetryEventKind kind, uint8_t a, int16_t arg = 0, int32_t value = 0) {
+        TelemetryEvent p = { (uint8_t)kind, a, arg, value };
+        emit(TLM_EVENT, &p, sizeof(p));
+    }
+
+    /**
+     * @brief 把缓冲区内容交给串口，只写不会阻塞的量 (网络任务调用)
+     */
+    void drain() {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        uint32_t head = _head.load(std::memory_order_acquire);
+        int room = Serial.availableForWrite();
+        while (tail != head && room > 0) {
+            uint32_t offset = tail & (TELEMETRY_RING_SIZE - 1);
+            uint32_t chunk = head - tail;
+            if (chunk > TELEMETRY_RING_SIZE - offset) chunk = TELEMETRY_RING_SIZE - offset; // 到环尾为止
+            if (chunk > (uint32_t)room) chunk = room;
+            Serial.write(&_ring[offset], chunk);
+            tail += chunk;
+            room -= chunk;
+        }
+        _tail.store(tail, std::memory_order_release);
+    }
+};
+
+#else
+
+// 关闭时保留同样的接口，直接打印文本
+class TelemetryLog {
+public:
+    void begin() {}
+
+    void stateChange(uint8_t from, uint8_t to, TelemetryReason reason, uint8_t floor,
+                     long positionMs, long detail) {
+        Serial.printf("[State] %s -> %s (%s) pos %ld ms, floor %d, detail %ld\n",
+                      telemetryStateName(from), telemetryStateName(to),
+                      telemetryReasonName(reason), positionMs, floor == 0xFF ? -1 : floor, detail);
+    }
+
+    void status(uint8_t state, bool topLimit, uint8_t pendingStops, uint8_t sensorHealth,
+                long positionMs, int32_t distanceMm) {
+        Serial.printf("[State: %s] Pos: %ld ms | Limit: %s | Dist: %ld mm | Queue: %d\n",
+                      telemetryStateName(state), positionMs, topLimit ? "HIT" : "OPEN",
+                      (long)distanceMm, pendingStops);
+    }
+
+    void run(long durationMs, uint32_t runCount, long acuteLimitMs, uint32_t currentMa) {
+        Serial.printf("[Maintenance] Recorded Run: %ld ms, %lu mA. History Size: %lu\n",
+                      durationMs, (unsigned long)currentMa, (unsigned long)runCount);
+    }
+
+    void input(TelemetryInputKind kind, uint8_t a, int16_t arg = 0, int32_t value = 0) {
+        Serial.printf("[Input] kind %d a %d arg %d value %ld\n", kind, a, arg, (long)value);
+    }
+
+    void wear(const TelemetryWear& p) {
+        Serial.printf("[Maintenance] Wear: runs %lu | last %u: mean %ld ms, sd %u ms, slope %.2f ms/run"
+                      " | last %u: mean %ld ms, sd %u ms, slope %.2f ms/run | all: mean %ld ms\n",
+                      (unsigned long)p.runCount, p.shortCount, (long)p.meanShortMs, p.stddevShortMs,
+                      p.slopeShortQ16 / 65536.0, p.mediumCount, (long)p.meanMediumMs, p.stddevMediumMs,
+                      p.slopeMediumQ16 / 65536.0, (long)p.meanAllMs);
+    }
+
+    void event(TelemetryEventKind kind, uint8_t a, int16_t arg = 0, int32_t value = 0) {
+        switch (kind) {
+            case EVENT_TRANSITION_REJECTED:
+                Serial.printf("[Hoist] Rejected %s -> %s\n", telemetryStateName(a), telemetryStateName(arg));
+                break;
+            case EVENT_REHOME_FIRST:
+                Serial.printf("[Trip] %ld ms travelled since last home, re-homing first\n", (long)value);
+                break;
+            case EVENT_STOP_ON_THE_WAY:
+                Serial.printf("[Trip] Stopping at %s on the way\n", floorSpec(a).name);
+                break;
+            case EVENT_UP_RATE:
+                Serial.printf("[Maintenance] Up rate @PWM %d: %.3f\n", a, value / 65536.0);
+                break;
+            case EVENT_FLIGHT_SAVED:
+                Serial.printf("[Flight] Saved %d samples before %s error\n", arg, telemetryReasonName(a));
+                break;
+            case EVENT_CURRENT_LOST:
+                Serial.printf("[Current] ⚠️ No current samples %ld ms into %s, overcurrent stop unavailable\n",
+                              (long)value, telemetryStateName(a));
+                break;
+            default:
+                Serial.printf("[Event] kind %d a %d arg %d value %ld\n", kind, a, arg, (long)value);
+                break;
+        }
+    }
+
+    void drain() {}
+};
+
+#endif // ENABLE_BINARY_TELEMETRY
+
+// 定义在 SmartElevator.ino
+extern TelemetryLog telemetry;
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef TELEMETRY_FORMAT_H
+#define TELEMETRY_FORMAT_H
+
+/**
+ * @file TelemetryFormat.h
+ * @brief 二进制遥测帧格式 (固件与 tools/telemetry_decode.cpp 共用)
+ * @details 帧结构 (小端)：
+ *            0xA5 | len | type | seq | timestampMs(u32) | payload[len] | crc8
+ *          crc8 覆盖 len .. payload。seq 每帧 +1，解码端据此发现丢帧。
+ *          串口上可以与普通文本日志混在一起：解码端按同步字节 + CRC 找帧，其余字节按文本输出。
+ *          本文件只依赖 <stdint.h>，主机上可以直接编译。
+ */
+
+#include <stdint.h>
+
+#define TLM_SYNC 0xA5
+#define TLM_HEADER_SIZE 8   // sync + len + type + seq + timestamp
+#define TLM_MAX_PAYLOAD 32
+#define TLM_MAX_FRAME (TLM_HEADER_SIZE + TLM_MAX_PAYLOAD + 1)
+
+enum TelemetryType : uint8_t {
+    TLM_BOOT = 1,      // 启动
+    TLM_STATE = 2,     // 状态切换
+    TLM_STATUS = 3,    // 周期状态
+    TLM_RUN = 4,       // 记录了一次全程运行
+    TLM_FLIGHT_HEADER = 5, // 飞行记录快照头 (FlightRecorder.h)
+    TLM_FLIGHT_SAMPLE = 6, // 飞行记录的一个采样
+    TLM_INPUT = 7,         // 录制模式：状态机的一个输入事件
+    TLM_WEAR = 8,          // 磨损统计：每记录一次全程运行后各窗口的均值 / 标准差 / 斜率
+    TLM_EVENT = 9          // 控制路径上的零散事件 (原来的 Serial.printf)
+};
+
+// 事件帧的种类，各字段含义见注释
+enum TelemetryEventKind : uint8_t {
+    EVENT_TRANSITION_REJECTED, // 转移表不允许的切换：a = 当前状态, arg = 目标状态
+    EVENT_REHOME_FIRST,        // 漂移预算用完，下行前先归零：a = 放回队列的楼层, value = 归零以来的行程 ms
+    EVENT_STOP_ON_THE_WAY,     // 运行中改为先停顺路楼层：a = 该楼层, arg = 原目标楼层
+    EVENT_UP_RATE,             // 学到新的上升速度比：a = 巡航 PWM, value = 速度比 (Q16)
+    EVENT_FLIGHT_SAVED,        // 飞行记录快照已写入 Flash：a = 出错原因, arg = 采样数
+    EVENT_CURRENT_LOST,        // 电机在转但电流样本中断 (过流保护失效)：a = 运行状态, value = 已运行 ms
+    EVENT_COUNT
+};
+
+// 录制模式下记录的输入 (状态机除时间外的全部外部输入，InputRecorder.h)
+enum TelemetryInputKind : uint8_t {
+    INPUT_COMMAND,          // a = HoistCommandType, arg = 指令参数
+    INPUT_TOP_LIMIT,        // a = 过滤后的到顶判断 (0/1), value = 距离 mm
+    INPUT_SENSOR,           // 超声波的一个新样本：a = SensorHealth, arg = 样本比帧早多少 ms, value = 距离 mm
+    INPUT_CURRENT           // 电流：a = bit0 有有效样本 / bit1 过流, arg = RMS mA, value = 峰值 mA
+};
+
+// 状态切换原因，取代原来各处的 Serial.println
+enum TelemetryReason : uint8_t {
+    REASON_NONE,
+    REASON_COMMAND,         // 指令发起的行程
+    REASON_LIMIT_HIT,       // 非预期撞顶
+    REASON_CALIB_TIMEOUT,   // 归零超时
+    REASON_SENSOR_DEAD,     // 顶部传感器无回波
+    REASON_ACUTE,           // 短期异常 (卡滞)，detail = 已运行时长
+    REASON_MAX_POSITION,    // 超出安全下限
+    REASON_TARGET_REACHED,  // 到达目标楼层
+    REASON_VIRTUAL_BOTTOM,  // 到达最低层 (虚拟底部)
+    REASON_HOMED,           // 归零完成
+    REASON_EMERGENCY_STOP,  // 急停指令
+    REASON_WARM_START,      // 上电时从位置检查点恢复，detail = 归零以来的行程
+    REASON_OVERCURRENT,     // 电机电流持续超限 (堵转)，detail = 峰值电流 mA
+    REASON_STALL,           // 期望位置与实测位置偏差超限 (卡滞)，detail = 偏差 ms
+    REASON_COUNT
+};
+
+#pragma pack(push, 1)
+
+struct TelemetryBoot {
+    uint8_t resetReason;
+    uint8_t floorCount;
+};
+
+struct TelemetryState {
+    uint8_t from;           // SystemState
+    uint8_t to;
+    uint8_t reason;         // TelemetryReason
+    uint8_t floor;          // 目标楼层，0xFF 表示无
+    int32_t positionMs;
+    int32_t detail;         // 与原因相关的附加值 (如卡滞时的运行时长)
+};
+
+struct TelemetryStatus {
+    uint8_t state;
+    uint8_t topLimit;
+    uint8_t pendingStops;
+    uint8_t sensorHealth;
+    int32_t positionMs;
+    int16_t distanceMm;     // -1 表示无
+    uint16_t dropped;       // 自上次状态帧以来因缓冲区满丢弃的帧数
+};
+
+struct TelemetryRun {
+    int32_t durationMs;
+    uint32_t runCount;
+    int32_t acuteLimitMs;
+    int32_t currentMa;      // 本次运行的平均电流，0 表示没有测到
+};
+
+// 窗口：short = 最近 10 次，medium = 最近 100 次 (RunStatistics.h)
+struct TelemetryWear {
+    uint32_t runCount;      // 全部运行次数
+    uint16_t shortCount;
+    uint16_t mediumCount;
+    int32_t meanShortMs;
+    int32_t meanMediumMs;
+    int32_t meanAllMs;
+    uint16_t stddevShortMs;
+    uint16_t stddevMediumMs;
+    int32_t slopeShortQ16;  // 耗时斜率 (ms / 次，Q16)
+    int32_t slopeMediumQ16;
+};
+
+struct TelemetryEvent {
+    uint8_t kind;           // TelemetryEventKind
+    uint8_t a;
+    int16_t arg;
+    int32_t value;
+};
+
+struct TelemetryInput {
+    uint8_t kind;           // TelemetryInputKind
+    uint8_t a;
+    int16_t arg;
+    int32_t value;
+};
+
+// 飞行记录：每个控制周期一条
+struct FlightSample {
+    uint32_t timestampMs;
+    int32_t positionMs;     // -1 表示未知
+    int16_t distanceMm;     // 过滤后的超声波距离，-1 表示无
+    uint8_t state;          // SystemState
+    uint8_t duty;           // 实际输出的 PWM
+};
+
+struct FlightHeader {
+    uint32_t triggerMs;     // 进入 ERROR 的时刻
+    uint8_t reason;         // TelemetryReason
+    uint8_t fromState;      // 出错前的状态
+    uint16_t count;         // 快照中的采样数
+    uint16_t strideCycles;  // 相邻采样间隔的控制周期数
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(TelemetryWear) <= TLM_MAX_PAYLOAD, "TelemetryWear must fit in one frame");
+
+inline uint8_t telemetryCrc8(const uint8_t* data, uint32_t len, uint8_t crc = 0) {
+    // CRC-8 (poly 0x07)，逐位计算，每帧只有几十字节
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// 与 Config.h 中 SystemState 的顺序一致
+inline const char* telemetryStateName(uint8_t state) {
+    static const char* const names[] = { "IDLE", "CALIB", "UP", "DOWN", "ERROR", "UNKNOWN" };
+    return state < sizeof(names) / sizeof(names[0]) ? names[state] : "?";
+}
+
+/**
+ * @brief 组一帧到 out (至少 TLM_MAX_FRAME 字节)，返回帧长
+ */
+inline uint32_t telemetryEncode(uint8_t* out, uint8_t type, uint8_t seq, uint32_t timestampMs,
+                                const void* payload, uint8_t len) {
+    out[0] = TLM_SYNC;
+    out[1] = len;
+    out[2] = type;
+    out[3] = seq;
+    for (int i = 0; i < 4; i++) out[4 + i] = (uint8_t)(timestampMs >> (8 * i));
+    const uint8_t* p = (const uint8_t*)payload;
+    for (uint8_t i = 0; i < len; i++) out[TLM_HEADER_SIZE + i] = p[i];
+    uint32_t size = TLM_HEADER_SIZE + len + 1;
+    out[size - 1] = telemetryCrc8(&out[1], size - 2);
+    return size;
+}
+
+/**
+ * @brief data 开头 (还剩 avail 字节) 是不是一个完整、CRC 正确的帧
+ * @return 帧长，0 表示不是
+ */
+inline uint32_t telemetryFrameSize(const uint8_t* data, uint32_t avail) {
+    if (avail < TLM_HEADER_SIZE + 1 || data[0] != TLM_SYNC || data[1] > TLM_MAX_PAYLOAD) return 0;
+    uint32_t size = TLM_HEADER_SIZE + data[1] + 1;
+    if (size > avail || telemetryCrc8(&data[1], size - 2) != data[size - 1]) return 0;
+    return size;
+}
+
+inline const char* telemetryReasonName(uint8_t reason) {
+    static const char* const names[REASON_COUNT] = {
+        "none", "command", "limit_hit", "calib_timeout", "sensor_dead", "acute",
+        "max_position", "target_reached", "virtual_bottom", "homed", "emergency_stop",
+        "warm_start", "overcurrent", "stall"
+    };
+    return reason < REASON_COUNT ? names[reason] : "?";
+}
+
+inline const char* telemetryEventName(uint8_t kind) {
+    static const char* const names[EVENT_COUNT] = {
+        "transition_rejected", "rehome_first", "stop_on_the_way", "up_rate", "flight_saved", "current_lost"
+    };
+    return kind < EVENT_COUNT ? names[kind] : "?";
+}
+
+inline const char* telemetryInputName(uint8_t kind) {
+    static const char* const names[] = { "command", "top_limit", "sensor", "current" };
+    return kind < sizeof(names) / sizeof(names[0]) ? names[kind] : "?";
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef TRAVEL_RATE_MODEL_H
+#define TRAVEL_RATE_MODEL_H
+
+/**
+ * @file TravelRateModel.h
+ * @brief 按 PWM 学习上升/下降的相对速度 (负载自适应的位置模型)
+ * @details 位置单位是“下降标称 PWM 下的运行时间”。负载不同，上升相对下降的速度比也不同，
+ *          固定按 1:1 积分会让从下方到达中层的停点漂移。
+ *          每次从已知位置向上撞顶就是一次标定：起点 (下降单位) / 上升实际行程 = 速度比。
+ *          比值按巡航 PWM 分桶做 EWMA，定时器里以 Q16 定点数使用。
+ */
+
+#include <Arduino.h>
+#include "Config.h"
+
+#define RATE_PWM_BUCKETS 8 // PWM 0-255 按 32 一档
+#define RATE_Q16_ONE 65536u
+
+class TravelRateModel {
+public:
+    struct Bucket {
+        float rate;       // 下降单位 / 上升标称单位
+        uint16_t samples;
+    };
+
+private:
+    Bucket _up[RATE_PWM_BUCKETS];
+
+    static int bucketOf(int pwm) {
+        int b = pwm / (256 / RATE_PWM_BUCKETS);
+        if (b < 0) return 0;
+        return b >= RATE_PWM_BUCKETS ? RATE_PWM_BUCKETS - 1 : b;
+    }
+
+public:
+    void reset() { memset(_up, 0, sizeof(_up)); }
+
+    /**
+     * @brief 一次撞顶标定
+     * @param pwm 本次上升的巡航 PWM
+     * @param startPositionUs 起点位置 (下降单位)
+     * @param upTravelUs 上升过程中按标称速度折算的行程 (未乘速度比)
+     * @return true 表示样本被采纳
+     */
+    bool learnUp(int pwm, int64_t startPositionUs, int64_t upTravelUs) {
+        if (startPositionUs < (int64_t)RATE_MIN_DISTANCE_MS * 1000 || upTravelUs <= 0) return false;
+
+        float sample = (float)startPositionUs / upTravelUs;
+        if (sample < RATE_MIN || sample > RATE_MAX) return false; // 明显异常 (卡滞、传感器误触发)
+
+        Bucket& b = _up[bucketOf(pwm)];
+        if (b.samples == 0) {
+            b.rate = sample;
+        } else {
+            b.rate += RATE_EWMA_ALPHA * (sample - b.rate);
+        }
+        if (b.samples < 0xFFFF) b.samples++;
+        return true;
+    }
+
+    /**
+     * @brief 该 PWM 下的上升速度比 (Q16)；没有样本时借用最近的已学习档位，再没有则为 1.0
+     */
+    uint32_t getUpRateQ16(int pwm) const {
+        int center = bucketOf(pwm);
+        for (int d = 0; d < RATE_PWM_BUCKETS; d++) {
+            int lo = center - d, hi = center + d;
+            if (lo >= 0 && _up[lo].samples) return (uint32_t)(_up[lo].rate * RATE_Q16_ONE);
+            if (hi < RATE_PWM_BUCKETS && _up[hi].samples) return (uint32_t)(_up[hi].rate * RATE_Q16_ONE);
+        }
+        return RATE_Q16_ONE;
+    }
+
+    // 是否有学到的档位可用 (getUpRateQ16 不是退回的 1.0)
+    bool isLearned() const {
+        for (int b = 0; b < RATE_PWM_BUCKETS; b++) {
+            if (_up[b].samples) return true;
+        }
+        return false;
+    }
+
+    // 持久化用的原始数据
+    const Bucket* raw() const { return _up; }
+    Bucket* raw() { return _up; }
+    static size_t rawSize() { return sizeof(Bucket) * RATE_PWM_BUCKETS; }
+};
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef TRIP_PLANNER_H
+#define TRIP_PLANNER_H
+
+/**
+ * @file TripPlanner.h
+ * @brief 多目的地停靠队列 (SCAN 调度)
+ * @details 新指令不再覆盖当前行程，而是把目标楼层加入队列：
+ *          - 队列是楼层位图，同一楼层的重复请求自然合并，也不会满
+ *          - 沿当前扫描方向取最近的楼层，该方向没有请求时再掉头
+ *          - 正在运行时，新楼层若在当前行程途中，可以顺路先停
+ *          楼层按位置从顶到底编号 (FloorTable.h)，下标增大即向下。
+ */
+
+#include <Arduino.h>
+#include "Config.h"
+#include "FloorTable.h"
+
+enum TripRequestResult : uint8_t {
+    TRIP_QUEUED,
+    TRIP_MERGED    // 该楼层已在队列中或正是当前目标
+};
+
+class TripPlanner {
+private:
+    uint32_t _pending = 0; // bit i = 楼层 i 等待停靠
+    int _sweep = 1;        // 当前扫描方向：+1 向下, -1 向上
+
+    // 沿 direction 方向距 fromMs 最近的待停楼层，FLOOR_NONE 表示没有
+    uint8_t nearestAhead(long fromMs, int direction) const {
+        uint8_t best = FLOOR_NONE;
+        long bestDist = 0;
+        for (uint8_t i = 0; i < FLOOR_COUNT; i++) {
+            if (!(_pending & (1UL << i))) continue;
+            long dist = (floorPositionMs(i) - fromMs) * direction;
+            if (dist < 0) continue;
+            if (best == FLOOR_NONE || dist < bestDist) {
+                best = i;
+                bestDist = dist;
+            }
+        }
+        return best;
+    }
+
+public:
+    void clear() { _pending = 0; }
+    bool isEmpty() const { return _pending == 0; }
+    uint8_t count() const { return __builtin_popcount(_pending); }
+
+    /**
+     * @brief 加入一个楼层
+     * @param floor 目标楼层
+     * @param currentFloor 正在执行的行程目标，FLOOR_NONE 表示没有 (与它相同的请求也合并)
+     */
+    TripRequestResult request(uint8_t floor, uint8_t currentFloor = FLOOR_NONE) {
+        if (floor == currentFloor || (_pending & (1UL << floor))) return TRIP_MERGED;
+        _pending |= 1UL << floor;
+        return TRIP_QUEUED;
+    }
+
+    /**
+     * @brief 取出下一个楼层 (SCAN：先沿当前方向，没有再掉头)
+     * @param fromMs 当前位置
+     * @return 队列为空时返回 FLOOR_NONE
+     */
+    uint8_t takeNext(long fromMs) {
+        if (_pending == 0) return FLOOR_NONE;
+        uint8_t floor = nearestAhead(fromMs, _sweep);
+        if (floor == FLOOR_NONE) {
+            _sweep = -_sweep;
+            floor = nearestAhead(fromMs, _sweep);
+        }
+        _pending &= ~(1UL << floor);
+        return floor;
+    }
+
+    /**
+     * @brief 运行中的顺路楼层：返回值不是 FLOOR_NONE 时已出队，应改为先去这里
+     * @details 楼层必须位于当前位置与当前目标之间，且离当前位置至少一个减速段，
+     *          否则来不及平稳停下，留给下一段行程。
+     */
+    uint8_t takeOnTheWay(long fromMs, long targetMs) {
+        int direction = targetMs > fromMs ? 1 : -1;
+        uint8_t floor = nearestAhead(fromMs + direction * (long)RAMP_DECEL_MS, direction);
+        if (floor == FLOOR_NONE) return FLOOR_NONE;
+        if ((targetMs - floorPositionMs(floor)) * direction <= 0) return FLOOR_NONE;
+        _pending &= ~(1UL << floor);
+        _sweep = direction;
+        return floor;
+    }
+
+    void setSweep(int direction) { _sweep = direction < 0 ? -1 : 1; }
+};
+
+#endif
@@ -0,0 +1,224 @@
+#ifndef ULTRASONIC_FILTER_H
+#define ULTRASONIC_FILTER_H
+
+/**
+ * @file UltrasonicFilter.h
+ * @brief 超声波测距的信号处理管线
+ * @details 每个测量周期输入一次分类结果 (有效回波 / 超量程 / 完全没有回波)：
+ *          - 最近 5 个有效样本取中值，单个噪声样本无法改变输出
+ *          - 与中值偏差过大的样本计为离群
+ *          - 中值的变化超过机械速度上限时保持原距离，新距离持续一整个窗口才接受
+ *          - 输出距离、速度、健康状态和置信度 (最近 8 个周期中可信样本的比例)
+ *          每个样本的处理开销固定 (5 元素排序)，全部为整数运算。
+ */
+
+#include <Arduino.h>
+#include "Config.h"
+
+#define ULTRASONIC_MEDIAN_WINDOW 5
+
+enum EchoKind : uint8_t {
+    ECHO_VALID,        // 正常回波
+    ECHO_OUT_OF_RANGE, // 有回波但脉宽超出量程 (远处 / 没挡住)
+    ECHO_NONE          // 触发后完全没有回波 (传感器掉线)
+};
+
+enum SensorHealth : uint8_t {
+    SENSOR_OK,         // 有可信的距离
+    SENSOR_FAR,        // 连续超量程：前方没有物体
+    SENSOR_NOISY,      // 有回波但离群太多，暂不可信
+    SENSOR_DEAD        // 连续没有回波：传感器故障
+};
+
+/**
+ * @brief 一个测量周期内 Echo 边沿的捕获与分类
+ * Echo 中断调用 onEdge()，触发定时器在下一次触发前调用 finishCycle()。
+ * 不带锁，调用方负责互斥 (固件里是 portMUX 临界区)。主机上用录下的边沿时间回放测试。
+ */
+class EchoCapture {
+private:
+    int64_t _riseUs = -1;   // 上升沿时间，-1 表示未在测量
+    uint32_t _widthUs = 0;
+    bool _riseSeen = false;
+    bool _done = false;
+
+public:
+    // 上升沿记时，下降沿算脉宽
+    inline void IRAM_ATTR onEdge(bool high, int64_t nowUs) {
+        if (high) {
+            _riseUs = nowUs;
+            _riseSeen = true;
+        } else if (_riseUs >= 0) {
+            _widthUs = (uint32_t)(nowUs - _riseUs);
+            _done = true;
+            _riseUs = -1;
+        }
+    }
+
+    /**
+     * @brief 结束本周期：对收到的边沿分类，并为下一周期清零
+     * @param widthUs 输出本周期的脉宽
+     */
+    EchoKind finishCycle(uint32_t& widthUs) {
+        EchoKind kind;
+        if (!_riseSeen) {
+            kind = ECHO_NONE;          // 触发后完全没有回波
+        } else if (!_done || _widthUs > ULTRASONIC_ECHO_TIMEOUT_US) {
+            kind = ECHO_OUT_OF_RANGE;  // 与原 pulseIn(…, 6000) 超时返回 0 的语义一致
+        } else {
+            kind = ECHO_VALID;
+        }
+        widthUs = _widthUs;
+        _riseSeen = false;
+        _done = false;
+        _riseUs = -1;
+        return kind;
+    }
+};
+
+struct UltrasonicState {
+    uint32_t echoUs;       // 最近一次原始脉宽，0 表示无有效回波
+    int32_t distanceMm;    // 中值滤波后的距离，-1 表示无
+    int32_t velocityMmS;   // 距离变化率，负数表示在靠近传感器
+    uint8_t confidence;    // 0-100
+    SensorHealth health;
+    unsigned long timestampMs;
+};
+
+class UltrasonicFilter {
+private:
+    int32_t _ring[ULTRASONIC_MEDIAN_WINDOW];
+    uint8_t _ringCount = 0;
+    uint8_t _ringNext = 0;
+    uint8_t _history = 0;        // 最近 8 个周期是否为可信样本 (bit0 = 最新)
+    uint8_t _noneStreak = 0;
+    uint8_t _farStreak = 0;
+    uint8_t _jumpStreak = 0;     // 连续被变化率检查拒绝的次数
+    int32_t _refMm = -1;         // 变化率检查的参考距离；超量程时取量程上限
+    unsigned long _refMs = 0;
+    UltrasonicState _state = { 0, -1, 0, 0, SENSOR_NOISY, 0 };
+
+    int32_t median() const {
+        int32_t sorted[ULTRASONIC_MEDIAN_WINDOW];
+        memcpy(sorted, _ring, sizeof(int32_t) * _ringCount);
+        // 插入排序，最多 5 个元素
+        for (int i = 1; i < _ringCount; i++) {
+            int32_t v = sorted[i];
+            int j = i - 1;
+            while (j >= 0 && sorted[j] > v) {
+                sorted[j + 1] = sorted[j];
+                j--;
+            }
+            sorted[j + 1] = v;
+        }
+        return sorted[_ringCount / 2];
+    }
+
+    void clearRing() {
+        _ringCount = 0;
+        _ringNext = 0;
+    }
+
+    static uint8_t popcount8(uint8_t v) {
+        uint8_t n = 0;
+        for (; v; v &= v - 1) n++;
+        return n;
+    }
+
+public:
+    static int32_t echoToMm(uint32_t echoUs) {
+        // 声速 343 m/s，往返距离减半：mm = us * 0.343 / 2
+        return (int32_t)(echoUs * 343 / 2000);
+    }
+
+    /**
+     * @brief 输入一个测量周期的结果
+     */
+    void push(EchoKind kind, uint32_t echoUs, unsigned long nowMs) {
+        bool trusted = false;
+        bool outlier = false;
+        _state.echoUs = (kind == ECHO_VALID) ? echoUs : 0;
+
+        if (kind == ECHO_NONE) {
+            if (_noneStreak < 0xFF) _noneStreak++;
+            _farStreak = 0;
+        } else if (kind == ECHO_OUT_OF_RANGE) {
+            _noneStreak = 0;
+            if (_farStreak < 0xFF) _farStreak++;
+            if (_farStreak >= ULTRASONIC_FAR_CYCLES) clearRing();
+            trusted = true; // 超量程是明确的“没挡住”，本身是可信的
+            // 物体至少在量程之外，从这里出发也不可能瞬间出现在近处
+            _refMm = echoToMm(ULTRASONIC_ECHO_TIMEOUT_US);
+            _refMs = nowMs;
+        } else {
+            _noneStreak = 0;
+            _farStreak = 0;
+
+            int32_t sampleMm = echoToMm(echoUs);
+            outlier = _ringCount >= 3 &&
+                      abs(sampleMm - median()) > ULTRASONIC_OUTLIER_MM;
+
+            _ring[_ringNext] = sampleMm;
+            _ringNext = (_ringNext + 1) % ULTRASONIC_MEDIAN_WINDOW;
+            if (_ringCount < ULTRASONIC_MEDIAN_WINDOW) _ringCount++;
+
+            int32_t filtered = median();
+            if (_refMm >= 0 && nowMs > _refMs) {
+                int32_t dt = nowMs - _refMs;
+                int32_t maxStep = ULTRASONIC_MAX_SPEED_MM_S * dt / 1000 + ULTRASONIC_OUTLIER_MM;
+                // 变化率超过机械上限：保持参考距离，除非新距离持续了整个窗口
+                if (abs(filtered - _refMm) > maxStep) {
+                    if (_jumpStreak < ULTRASONIC_MEDIAN_WINDOW) {
+                        _jumpStreak++;
+                        filtered = _refMm;
+                    } else {
+                        _jumpStreak = 0; // 接受新距离，但这一周期仍不可信
+                    }
+                    outlier = true;
+                    _state.velocityMmS = 0;
+                } else {
+                    _jumpStreak = 0;
+                    _state.velocityMmS = (filtered - _refMm) * 1000 / dt;
+                }
+            } else {
+                _jumpStreak = 0;
+                _state.velocityMmS = 0;
+            }
+            _state.distanceMm = filtered;
+            _refMm = filtered;
+            _refMs = nowMs;
+            trusted = !outlier && _ringCount >= 3;
+        }
+
+        _history = (uint8_t)((_history << 1) | (trusted ? 1 : 0));
+        _state.confidence = popcount8(_history) * 100 / 8;
+        _state.timestampMs = nowMs;
+
+        if (_noneStreak >= ULTRASONIC_DEAD_CYCLES) {
+            _state.health = SENSOR_DEAD;
+            _state.distanceMm = -1;
+            _refMm = -1;
+            clearRing();
+        } else if (_farStreak >= ULTRASONIC_FAR_CYCLES) {
+            _state.health = SENSOR_FAR;
+            _state.distanceMm = -1;
+            _state.velocityMmS = 0;
+        } else if (_ringCount >= 3 && !outlier && _state.confidence >= ULTRASONIC_MIN_CONFIDENCE) {
+            _state.health = SENSOR_OK;
+        } else {
+            _state.health = SENSOR_NOISY;
+        }
+    }
+
+    const UltrasonicState& state() const { return _state; }
+
+    /**
+     * @brief 过滤后的“到顶”判断：健康、足够可信且距离在限位内
+     */
+    static bool isAtTop(const UltrasonicState& s) {
+        return s.health == SENSOR_OK && s.distanceMm > 0 &&
+               s.distanceMm <= (int32_t)(SENSOR_DISTANCE_LIMIT * 10);
+    }
+};
+
+#endif
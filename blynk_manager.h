@@ -10,14 +10,15 @@
 #include "secrets.h"
 #include <WiFi.h>
 #include <BlynkSimpleEsp32.h>
-#include "HoistStateMachine.h" 
+#include "ControlChannel.h"
 #include "SchedulerManager.h"
-#include "MaintenanceManager.h"
+#include "FloorTable.h"
+#include "NetworkLink.h"
 
 // 引用主程序中定义的全局对象
-extern HoistStateMachine hoist; 
+// 状态机运行在控制任务里，这里只通过 controlChannel 下发指令
+extern ControlChannel controlChannel;
 extern SchedulerManager scheduler;
-extern MaintenanceManager maintenance;
 
 // 定义 Blynk 的打印输出为串口
 #define BLYNK_PRINT Serial
@@ -26,15 +27,48 @@ extern MaintenanceManager maintenance;
 // 1. 连接管理
 // ------------------------------------
 
+// 实机传输层：NetworkLink 只经由这里访问 WiFi / Blynk
+class BlynkTransport : public NetworkTransport {
+public:
+    void wifiBegin() override {
+        WiFi.mode(WIFI_STA);
+        WiFi.begin(WIFI_SSID, WIFI_PASS);
+    }
+    void wifiReset() override { WiFi.disconnect(); }
+    bool wifiConnected() override { return WiFi.status() == WL_CONNECTED; }
+    bool cloudConnect(uint32_t timeoutMs) override { return Blynk.connect(timeoutMs); }
+    bool cloudConnected() override { return Blynk.connected(); }
+    void cloudRun() override { Blynk.run(); }
+    void cloudDisconnect() override { Blynk.disconnect(); }
+};
+
+static BlynkTransport s_blynkTransport;
+static NetworkLink s_link(s_blynkTransport, { NET_WIFI_TIMEOUT_MS, NET_CLOUD_CONNECT_SLICE_MS,
+                                              NET_BACKOFF_MIN_MS, NET_BACKOFF_MAX_MS });
+
 void setupBlynk() {
-    Serial.println("\n[Network] Connecting to WiFi & Blynk...");
-    // 阻塞式连接，连接失败会一直卡在这里（MVP策略）
-    Blynk.begin(BLYNK_AUTH_TOKEN, WIFI_SSID, WIFI_PASS);
-    Serial.println("[Network] Connected!");
+    Serial.println("\n[Network] Connecting to WiFi & Blynk in the background...");
+    // 不再阻塞：连不上时电梯照常工作，串口和定时指令都不受影响
+    Blynk.config(BLYNK_AUTH_TOKEN); // 只保存配置，不连接
+    s_link.begin(millis());
 }
 
 void runBlynk() {
-    Blynk.run();
+    LinkState before = s_link.getState();
+    s_link.service(millis());
+    LinkState after = s_link.getState();
+    if (after != before) {
+        Serial.printf("[Network] %s -> %s (failures: %u)\n", NetworkLink::stateName(before),
+                      NetworkLink::stateName(after), s_link.getFailures());
+    }
+}
+
+bool isWifiConnected() {
+    return WiFi.status() == WL_CONNECTED;
+}
+
+bool isNetworkOnline() {
+    return s_link.isOnline();
 }
 
 // ------------------------------------
@@ -46,72 +80,145 @@ BLYNK_WRITE(V1) {
     int val = param.asInt();
     if (val == 1) {
         Serial.println("[Blynk] 🚨 EMERGENCY STOP Triggered!");
-        hoist.emergencyStop();
+        controlChannel.requestEmergencyStop();
     }
 }
 
 // V20: 楼层选择 (综合控制)
-// 0=无, 1=底, 2=中, 3=顶
+// 0=无, 1=最低层 ... FLOOR_COUNT=顶层 (顺序由楼层表决定)
 BLYNK_WRITE(V20) {
-    int floor = param.asInt();
-    Serial.printf("[Blynk] Floor Select: %d\n", floor);
-    switch (floor) {
-        case 1: hoist.commandGoBottom(); break;
-        case 2: hoist.commandGoMiddle(); break;
-        case 3: hoist.commandGoTop(); break;
-        default: break;
-    }
+    uint8_t floor = floorFromSelector(param.asInt());
+    if (floor == FLOOR_NONE) return;
+    Serial.printf("[Blynk] Floor Select: %s\n", floorSpec(floor).name);
+    controlChannel.post(CMD_GO_FLOOR, floor);
 }
 
-// V21: 去底层
-BLYNK_WRITE(V21) {
-    if (param.asInt() == 1) {
-        Serial.println("[Blynk] CMD: Go Bottom");
-        hoist.commandGoBottom();
-    }
-}
-
-// V22: 去中层
-BLYNK_WRITE(V22) {
-    if (param.asInt() == 1) {
-        Serial.println("[Blynk] CMD: Go Middle");
-        hoist.commandGoMiddle();
-    }
+// 楼层按钮 (V21 底 / V22 中 / V23 顶，引脚在楼层表里配置)
+// 没有单独 BLYNK_WRITE 的引脚都会进到这里，按楼层表查找
+BLYNK_WRITE_DEFAULT() {
+    uint8_t floor = floorFromBlynkPin(request.pin);
+    if (floor == FLOOR_NONE || param.asInt() != 1) return;
+    Serial.printf("[Blynk] CMD: Go %s\n", floorSpec(floor).name);
+    controlChannel.post(CMD_GO_FLOOR, floor);
 }
 
-// V23: 去顶层 (校准)
-BLYNK_WRITE(V23) {
-    if (param.asInt() == 1) {
-        Serial.println("[Blynk] CMD: Go Top");
-        hoist.commandGoTop();
+// Time Input 的星期字段: "1,2,3" (1=周一 ... 7=周日)，为空表示每天
+// 转成调度器的 bit0=周日 ... bit6=周六
+uint8_t parseBlynkWeekdays(const char* days) {
+    if (days == nullptr || *days == '\0') return WEEKDAYS_ALL;
+    uint8_t mask = 0;
+    for (const char* p = days; *p; p++) {
+        if (*p >= '1' && *p <= '7') mask |= 1 << ((*p - '0') % 7);
     }
+    return mask ? mask : WEEKDAYS_ALL;
 }
 
 // V10: 定时上升 (Time Input widget sends seconds)
 BLYNK_WRITE(V10) {
     long startTimeInSecs = param[0].asLong();
-    scheduler.setScheduleUp(startTimeInSecs);
+    scheduler.setScheduleUp(startTimeInSecs, parseBlynkWeekdays(param[3].asStr()));
 }
 
 // V11: 定时下降 (Time Input widget sends seconds)
 BLYNK_WRITE(V11) {
     long startTimeInSecs = param[0].asLong();
-    scheduler.setScheduleDown(startTimeInSecs);
+    scheduler.setScheduleDown(startTimeInSecs, parseBlynkWeekdays(param[3].asStr()));
+}
+
+// V12: 定时去中层 (Time Input widget sends seconds)
+BLYNK_WRITE(V12) {
+    long startTimeInSecs = param[0].asLong();
+    scheduler.setScheduleMiddle(startTimeInSecs, parseBlynkWeekdays(param[3].asStr()));
 }
 
 // ------------------------------------
 // 3. 状态推送 (Device -> App)
 // ------------------------------------
 
+// 每个状态对应的 APP 状态文字 (按 SystemState 顺序)，上报时直接查表，不拼接字符串
+const char* const STATE_STATUS_TEXT[] = {
+    "✅ IDLE",              // STATE_IDLE
+    "🔄 Calibrating...",    // STATE_CALIBRATING
+    "⬆️ Moving Up...",      // STATE_MOVING_UP
+    "⬇️ Moving Down...",    // STATE_MOVING_DOWN
+    "⚠️ ERROR: Check Logs", // STATE_ERROR
+    "✅ UNKNOWN"            // STATE_POS_UNKNOWN
+};
+
+const char* getStateStatusText(SystemState state) {
+    return STATE_STATUS_TEXT[state];
+}
+
+// 上一次推送的值：只有变化时才发送 (Delta Suppression)
+// 缓冲区预先分配，上报路径上没有堆内存分配
+static char s_lastStatusText[48] = "";
+static long s_lastDurationMs = -1;
+static float s_lastSlope = 0;
+static bool s_slopeSent = false;
+static long s_lastMeanCurrentMa = -1;
+static float s_lastCurrentSlope = 0;
+static bool s_currentSlopeSent = false;
+static unsigned long s_lastLoopMaxUs = 0;
+static unsigned long s_lastLoopP99Us = 0;
+static bool s_loopSent = false;
+
+// 使缓存失效，下次上报全部重发 (重连后 APP 需要完整状态)
+void invalidateAppCache() {
+    s_lastStatusText[0] = '\0';
+    s_lastDurationMs = -1;
+    s_slopeSent = false;
+    s_lastMeanCurrentMa = -1;
+    s_currentSlopeSent = false;
+    s_loopSent = false;
+}
+
 // 辅助函数：更新APP上的状态文字
 void updateAppStatus(const char* statusStr) {
+    if (strncmp(statusStr, s_lastStatusText, sizeof(s_lastStatusText)) == 0) return;
+    strncpy(s_lastStatusText, statusStr, sizeof(s_lastStatusText) - 1);
+    s_lastStatusText[sizeof(s_lastStatusText) - 1] = '\0';
     Blynk.virtualWrite(V3, statusStr);
 }
 
 // 辅助函数：更新维护数据 (AI 数据)
-void updateAppMaintenanceData(long lastDurationMs, double slope) {
-    Blynk.virtualWrite(V0, (int)lastDurationMs); // 单次耗时
-    Blynk.virtualWrite(V4, slope);              // 老化斜率
+void updateAppMaintenanceData(long lastDurationMs, float slope) {
+    if (lastDurationMs != s_lastDurationMs) {
+        s_lastDurationMs = lastDurationMs;
+        Blynk.virtualWrite(V0, (int)lastDurationMs); // 单次耗时
+    }
+    if (!s_slopeSent || slope != s_lastSlope) {
+        s_lastSlope = slope;
+        s_slopeSent = true;
+        Blynk.virtualWrite(V4, slope);              // 老化斜率
+    }
+}
+
+// 辅助函数：更新电流磨损指标 (与耗时斜率并列的第二个老化指标)
+void updateAppCurrentData(long meanCurrentMa, float currentSlope) {
+    if (meanCurrentMa != s_lastMeanCurrentMa) {
+        s_lastMeanCurrentMa = meanCurrentMa;
+        Blynk.virtualWrite(V8, (int)meanCurrentMa); // 最近几次全程的平均电流 (mA)
+    }
+    if (!s_currentSlopeSent || currentSlope != s_lastCurrentSlope) {
+        s_lastCurrentSlope = currentSlope;
+        s_currentSlopeSent = true;
+        Blynk.virtualWrite(V9, currentSlope);       // 电流斜率 (mA / 次)
+    }
+}
+
+// 辅助函数：更新主循环耗时 (us)
+void updateAppLoopLatency(unsigned long maxUs, unsigned long p99Us) {
+    if (s_loopSent && maxUs == s_lastLoopMaxUs && p99Us == s_lastLoopP99Us) return;
+    s_lastLoopMaxUs = maxUs;
+    s_lastLoopP99Us = p99Us;
+    s_loopSent = true;
+    Blynk.virtualWrite(V6, (int)maxUs);  // 最大单次 loop 耗时
+    Blynk.virtualWrite(V7, (int)p99Us);  // p99 loop 耗时
+}
+
+// 连上 (或重连上) 云端后，下一次上报全部重发
+BLYNK_CONNECTED() {
+    invalidateAppCache();
 }
 
 #endif
\ No newline at end of file
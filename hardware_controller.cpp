@@ -7,6 +7,35 @@
 #include "hardware_controller.h"
 #include "Config.h"
 
+#if !USE_SIMULATED_HARDWARE
+#include "Seqlock.h"
+#include <esp_timer.h>
+#include <esp_adc/adc_continuous.h>
+
+// --- 超声波异步测距的内部状态 ---
+// Echo 中断只记录边沿；触发定时器在每个周期开始时对上一周期分类、滤波并发布。
+// 发布者只有定时器一个 (单写者)，读者通过 seqlock 拿到一致的快照。
+static portMUX_TYPE s_echoMux = portMUX_INITIALIZER_UNLOCKED;
+static EchoCapture s_echo;                 // s_echoMux 保护
+static bool s_triggered = false;           // 是否已发出过触发脉冲 (仅定时器访问)
+static UltrasonicFilter s_filter;          // 仅定时器访问
+static SeqlockMailbox<UltrasonicState> s_sensorState;
+static esp_timer_handle_t s_triggerTimer = nullptr;
+
+// --- 电机电流采样的内部状态 ---
+// ADC 连续模式由 DMA 填满一块就发中断，中断只唤醒电流任务；
+// 电流任务 (PRO 核) 读出整块、算 RMS / 峰值后发布，控制任务只读快照。
+static const uint32_t CURRENT_FRAME_BYTES = CURRENT_BLOCK_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES;
+static adc_continuous_handle_t s_adc = nullptr;
+static TaskHandle_t s_currentTask = nullptr;
+static adc_channel_t s_channelL;                 // L_IS 对应的 ADC 通道，用于区分两路
+static MotorCurrentFilter s_currentFilter;       // 仅电流任务访问
+static SeqlockMailbox<MotorCurrentState> s_currentState;
+
+static void triggerUltrasonic(void* arg);
+static void IRAM_ATTR onEchoEdge();
+static void setupCurrentSense();
+
 // --- 1. 初始化实现 ---
 
 void setupHardware() {
@@ -19,6 +48,16 @@ void setupHardware() {
     pinMode(PIN_ULTRASONIC_ECHO, INPUT);
     digitalWrite(PIN_ULTRASONIC_TRIG, LOW);
 
+    // 超声波改为异步：Echo 双边沿中断 + 周期触发定时器
+    attachInterrupt(digitalPinToInterrupt(PIN_ULTRASONIC_ECHO), onEchoEdge, CHANGE);
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = triggerUltrasonic;
+    timerArgs.name = "us_trig";
+    esp_timer_create(&timerArgs, &s_triggerTimer);
+    esp_timer_start_periodic(s_triggerTimer, ULTRASONIC_PERIOD_US);
+
+    setupCurrentSense();
+
     Serial.println("[硬件] 硬件初始化完成 (真实驱动模式)");
 }
 
@@ -63,36 +102,133 @@ void setMockTopLimit(bool pressed) {
     // 真实硬件模式下，此函数无效
 }
 
-bool isTopLimitPressed() {
-    // 发送触发信号
-    digitalWrite(PIN_ULTRASONIC_TRIG, LOW);
-    delayMicroseconds(2);
+// 定时器回调 (esp_timer 任务上下文)：处理上一周期的回波，再发出 10us 触发脉冲
+static void triggerUltrasonic(void* arg) {
+    uint32_t width;
+    portENTER_CRITICAL(&s_echoMux);
+    EchoKind kind = s_echo.finishCycle(width);
+    portEXIT_CRITICAL(&s_echoMux);
+
+    if (s_triggered) {
+        s_filter.push(kind, width, millis());
+        s_sensorState.publish(s_filter.state());
+    }
+
     digitalWrite(PIN_ULTRASONIC_TRIG, HIGH);
     delayMicroseconds(10);
     digitalWrite(PIN_ULTRASONIC_TRIG, LOW);
+    s_triggered = true;
+}
 
-    // 读取回声信号 
-    // Optimization: Reduced timeout to 6000us (~100cm range). 
-    // Target is 42.5cm, so 100cm is sufficient. 30ms (5m) was too blocking.
-    long duration = pulseIn(PIN_ULTRASONIC_ECHO, HIGH, 6000); 
+// Echo 引脚中断：上升沿记时，下降沿算脉宽
+static void IRAM_ATTR onEchoEdge() {
+    int64_t now = esp_timer_get_time();
+    bool high = digitalRead(PIN_ULTRASONIC_ECHO) == HIGH;
 
-    if (duration == 0) {
-        // 超时或读取失败，通常意味着距离很远（没挡住），或者传感器故障
-        // 保守起见，如果没有回波，假设没有到达顶部（或者视为故障停止？）
-        // 这里暂时假设未到达
-        return false; 
-    }
+    portENTER_CRITICAL_ISR(&s_echoMux);
+    s_echo.onEdge(high, now);
+    portEXIT_CRITICAL_ISR(&s_echoMux);
+}
 
-    // 计算距离（cm）
-    float distance = duration * 0.034 / 2;
+bool getUltrasonicState(UltrasonicState& out) {
+    return s_sensorState.read(out);
+}
+
+bool getUltrasonicReading(UltrasonicReading& out) {
+    UltrasonicState state;
+    if (!getUltrasonicState(state)) return false;
+    out.echoUs = state.echoUs;
+    out.timestampMs = state.timestampMs;
+    return true;
+}
 
+bool isTopLimitPressed() {
+    UltrasonicState state;
+    if (!getUltrasonicState(state)) return false;
+
+    // 结果过旧（定时器停止工作），按“未到达顶部”处理
+    if (millis() - state.timestampMs > ULTRASONIC_STALE_MS) return false;
+
+    // 中值滤波后的距离 + 健康/置信度，单个噪声样本不会触发
+    return UltrasonicFilter::isAtTop(state);
+}
 
-    // 
-    // 正确逻辑: 如果距离 <= 给定距离，说明到达顶部限位，应返回 true
-    if (distance > 0 && distance <= SENSOR_DISTANCE_LIMIT) {
-        // Serial.printf("[硬件] 顶部限位触发! 距离: %.2f cm\n", distance);
-        return true; 
+// --- 4. 电流检测实现 ---
+
+// 一块转换完成 (中断上下文)：只唤醒电流任务
+static bool IRAM_ATTR onCurrentBlock(adc_continuous_handle_t handle, const adc_continuous_evt_data_t* edata,
+                                     void* user) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_currentTask, &woken);
+    return woken == pdTRUE;
+}
+
+// 电流任务：每块做一次 RMS / 峰值归约并发布
+static void currentTask(void* arg) {
+    static uint8_t frame[CURRENT_FRAME_BYTES];
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        uint32_t len = 0;
+        while (adc_continuous_read(s_adc, frame, sizeof(frame), &len, 0) == ESP_OK) {
+            for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= len; i += SOC_ADC_DIGI_RESULT_BYTES) {
+                const adc_digi_output_data_t* d = (const adc_digi_output_data_t*)&frame[i];
+                uint32_t mv = d->type1.data * CURRENT_ADC_FULL_SCALE_MV / ((1 << SOC_ADC_DIGI_MAX_BITWIDTH) - 1);
+                s_currentFilter.push(d->type1.channel == s_channelL ? 1 : 0, mv);
+            }
+            s_currentFilter.endBlock(millis());
+            s_currentState.publish(s_currentFilter.state());
+        }
     }
-    
-    return false;
-}
\ No newline at end of file
+}
+
+static void setupCurrentSense() {
+    adc_continuous_handle_cfg_t handleCfg = {};
+    handleCfg.max_store_buf_size = CURRENT_FRAME_BYTES * 4;
+    handleCfg.conv_frame_size = CURRENT_FRAME_BYTES;
+    if (adc_continuous_new_handle(&handleCfg, &s_adc) != ESP_OK) {
+        Serial.println("[硬件] 电流检测初始化失败，仅依靠耗时检查");
+        return;
+    }
+
+    static const int pins[2] = { PIN_MOTOR_R_IS, PIN_MOTOR_L_IS };
+    adc_digi_pattern_config_t pattern[2] = {};
+    for (int i = 0; i < 2; i++) {
+        adc_unit_t unit;
+        adc_channel_t channel;
+        adc_continuous_io_to_channel(pins[i], &unit, &channel);
+        pattern[i].atten = ADC_ATTEN_DB_12;
+        pattern[i].channel = channel;
+        pattern[i].unit = unit;
+        pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+        if (i == 1) s_channelL = channel;
+    }
+
+    adc_continuous_config_t config = {};
+    config.pattern_num = 2;
+    config.adc_pattern = pattern;
+    config.sample_freq_hz = CURRENT_SAMPLE_RATE_HZ;
+    config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+    adc_continuous_config(s_adc, &config);
+
+    // 与网络任务同在 PRO 核，不占用控制任务所在的 APP 核
+    xTaskCreatePinnedToCore(currentTask, "current", 3072, nullptr, CURRENT_TASK_PRIORITY,
+                            &s_currentTask, NETWORK_TASK_CORE);
+
+    adc_continuous_evt_cbs_t callbacks = {};
+    callbacks.on_conv_done = onCurrentBlock;
+    adc_continuous_register_event_callbacks(s_adc, &callbacks, nullptr);
+    adc_continuous_start(s_adc);
+}
+
+bool getMotorCurrent(MotorCurrentState& out) {
+    if (!s_currentState.read(out)) return false;
+    // 采样停止 (驱动出错) 时不再相信旧结果
+    return millis() - out.timestampMs <= CURRENT_STALE_MS;
+}
+
+void setMockJam(bool jammed) {
+    // 真实硬件模式下，此函数无效
+}
+
+#endif // !USE_SIMULATED_HARDWARE
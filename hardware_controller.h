@@ -9,6 +9,8 @@
 #define HARDWARE_CONTROLLER_H
 
 #include <Arduino.h>
+#include "UltrasonicFilter.h"
+#include "MotorCurrentFilter.h"
 
 // --- 常量定义 ---
 
@@ -28,6 +30,7 @@ constexpr int MIN_MOTOR_SPEED = 80;
 void setupHardware();
 
 // --- 2. 电机控制 ---
+// 运行时由 motion_timer 统一调用 (加锁串行、占空比变化时才写寄存器)，逻辑层不要直接调用。
 
 /**
  * @brief 电机上升
@@ -48,9 +51,57 @@ void motorGoDown(int pwm_val = MAX_MOTOR_SPEED);
 void stopMotor();
 
 // --- 传感器读取 ---
+
+/**
+ * @brief 超声波最新一次测距快照
+ * 由 Echo 引脚中断异步写入，读取方不阻塞。
+ */
+struct UltrasonicReading {
+    uint32_t echoUs;           // 回波脉宽 (us)，0 表示超出量程/无回波
+    unsigned long timestampMs; // 该回波的捕获时间 (millis)
+};
+
+/**
+ * @brief 是否到达顶部限位
+ * 只读取最近一次异步测距结果，O(1)，不再调用 pulseIn 阻塞主循环。
+ * 判断基于中值滤波后的距离，且要求传感器健康、置信度足够。
+ */
 bool isTopLimitPressed();
 
+/**
+ * @brief 读取最新原始测距快照
+ * @return false 表示尚未完成任何测量周期
+ */
+bool getUltrasonicReading(UltrasonicReading& out);
+
+/**
+ * @brief 读取滤波后的传感器状态 (距离 / 速度 / 健康 / 置信度)
+ * @return false 表示尚未完成任何测量周期
+ */
+bool getUltrasonicState(UltrasonicState& out);
+
+/**
+ * @brief 读取最新的电机电流统计 (RMS / 峰值 / 过流标志)
+ * 由电流任务按块异步发布，读取方不阻塞。
+ * @return false 表示没有采样或结果已过期
+ */
+bool getMotorCurrent(MotorCurrentState& out);
+
 // --- 调试用 ---
 void setMockTopLimit(bool pressed); // 手动设置模拟限位开关的状态
+void setMockJam(bool jammed);       // 仿真：电机卡死 (不动且电流升到堵转值)
+
+#if USE_SIMULATED_HARDWARE
+// 仿真模型参数，默认取 Config.h 中的 SIM_*；主机仿真按参数扫描时在 setupHardware() 之前设置
+struct SimParams {
+    float loadKg;
+    float sensorNoiseCm;
+    float fullSpeedCmS;   // PWM 255、空载时的速度
+    int pwmDeadband;
+};
+void setSimParams(const SimParams& params);
+float simGetPositionCm(); // 模型中的真实位置 (距顶部 cm)，用于评估停层误差
+void setMockSlip(bool slipping); // 打滑：电机照常转、电流正常，吊篮不动 (只有位置检查能发现)
+#endif
 
 #endif
\ No newline at end of file
@@ -0,0 +1,187 @@
+/**
+ * @file hardware_sim.cpp
+ * @brief 硬件抽象层的仿真实现 (Simulated Hardware Implementation)
+ * @details Config.h 中 USE_SIMULATED_HARDWARE 为 1 时替代 hardware_controller.cpp。
+ *          电机不接线，位置由简单的电机+绳索模型按时间积分；超声波读数由模型合成。
+ *          与真实驱动的结构相同：模型只由仿真定时器 (esp_timer) 一个上下文推进和写入，
+ *          传感器 / 电流结果经 seqlock 发布；电机指令、调试开关只是原子变量，
+ *          控制任务、网络任务、运动定时器都只读发布的副本。
+ *          主机仿真 (sim/) 用同一份文件，定时器跑在虚拟时钟上。
+ */
+
+#include "hardware_controller.h"
+#include "Config.h"
+
+#if USE_SIMULATED_HARDWARE
+#include "Seqlock.h"
+#include <atomic>
+#include <esp_timer.h>
+
+// --- 指令输入 (任意上下文写，仿真定时器读) ---
+// 方向和占空比合成一个值，读者不会看到新方向配旧占空比：>0 下降, <0 上升, 0 停止
+static std::atomic<int> s_motorCommand{0};
+static std::atomic<bool> s_mockTopPressed{false};
+static std::atomic<bool> s_mockJam{false};        // 模拟卡死：电机通电但不动
+static std::atomic<bool> s_mockSlip{false};       // 模拟打滑：电机照常转、电流正常，吊篮不动
+
+// --- 模型状态 (仅仿真定时器访问) ---
+static SimParams s_params = { SIM_LOAD_KG, SIM_SENSOR_NOISE_CM, SIM_FULL_SPEED_CM_S, SIM_PWM_DEADBAND };
+static float s_positionCm = 0;                    // 距顶部的位置 (0 = 顶)
+static uint32_t s_tick = 0;
+static UltrasonicFilter s_filter;                 // 与真实驱动相同的信号处理管线
+static MotorCurrentFilter s_currentFilter;        // 与真实驱动相同的电流统计
+static esp_timer_handle_t s_simTimer = nullptr;
+
+// --- 发布给读者的结果 ---
+static SeqlockMailbox<UltrasonicState> s_sensorState;
+static SeqlockMailbox<MotorCurrentState> s_currentState;
+static std::atomic<float> s_publishedPositionCm{0};
+
+static const uint32_t SENSOR_EVERY_TICKS = ULTRASONIC_PERIOD_US / SIM_TICK_US;
+static const uint32_t CURRENT_EVERY_TICKS = CURRENT_BLOCK_SAMPLES * 1000000ULL / CURRENT_SAMPLE_RATE_HZ / SIM_TICK_US;
+
+// 当前 PWM/负载 下的速度 (cm/s)
+static float simSpeedCmPerSec(int dir, int pwm) {
+    if (dir == 0 || pwm <= s_params.pwmDeadband || s_mockJam.load(std::memory_order_relaxed)) return 0;
+
+    float duty = (float)(pwm - s_params.pwmDeadband) / (MAX_MOTOR_SPEED - s_params.pwmDeadband);
+    float speed = s_params.fullSpeedCmS * duty;
+
+    if (dir < 0) {
+        speed *= 1.0f - s_params.loadKg * SIM_UP_SLOWDOWN_PER_KG;
+    } else {
+        speed *= 1.0f + s_params.loadKg * SIM_DOWN_SPEEDUP_PER_KG;
+    }
+    return speed > 0 ? speed : 0;
+}
+
+// 合成传感器距离 (cm)，叠加均匀噪声
+static float simSensorDistanceCm() {
+    if (s_mockTopPressed.load(std::memory_order_relaxed)) return SIM_TOP_GAP_CM;
+    float noise = random(-1000, 1001) / 1000.0f * s_params.sensorNoiseCm;
+    return SIM_TOP_GAP_CM + s_positionCm + noise;
+}
+
+// 模型电流 (mA)：随占空比和负载增加，卡死或顶在机械限位上时为堵转电流
+static uint32_t simCurrentMa(int dir, int pwm) {
+    if (dir == 0 || pwm == 0) return 0;
+    bool blocked = s_mockJam.load(std::memory_order_relaxed) || (dir < 0 && s_positionCm <= 0);
+    if (blocked) return SIM_CURRENT_STALL_MA;
+    uint32_t loadMa = SIM_CURRENT_NOLOAD_MA + (uint32_t)(s_params.loadKg * SIM_CURRENT_PER_KG_MA);
+    return loadMa * pwm / MAX_MOTOR_SPEED;
+}
+
+// 仿真定时器 (esp_timer 任务上下文)：模型的唯一写者
+static void onSimTick(void* arg) {
+    int command = s_motorCommand.load(std::memory_order_acquire);
+    int dir = command > 0 ? 1 : (command < 0 ? -1 : 0);
+    int pwm = command * dir;
+    unsigned long now = millis();
+
+    if (!s_mockSlip.load(std::memory_order_relaxed)) {
+        s_positionCm += dir * simSpeedCmPerSec(dir, pwm) * (SIM_TICK_US / 1e6f);
+    }
+    // 机械限位：顶部卡住，底部绳子放尽
+    if (s_positionCm < 0) s_positionCm = 0;
+    if (s_positionCm > SIM_TRAVEL_CM) s_positionCm = SIM_TRAVEL_CM;
+    s_publishedPositionCm.store(s_positionCm, std::memory_order_relaxed);
+    s_tick++;
+
+    // 按真实的测量周期生成合成回波，送入滤波管线
+    if (s_tick % SENSOR_EVERY_TICKS == 0) {
+        uint32_t echoUs = (uint32_t)(simSensorDistanceCm() * 2 / 0.034f);
+        s_filter.push(echoUs > ULTRASONIC_ECHO_TIMEOUT_US ? ECHO_OUT_OF_RANGE : ECHO_VALID, echoUs, now);
+        s_sensorState.publish(s_filter.state());
+    }
+
+    // 按真实的块周期生成电流样本，换算回 IS 电压后送入同一个统计管线
+    if (s_tick % CURRENT_EVERY_TICKS == 0) {
+        uint32_t mv = (uint32_t)((uint64_t)simCurrentMa(dir, pwm) * CURRENT_SENSE_RESISTOR_OHM / CURRENT_SENSE_RATIO);
+        for (uint32_t i = 0; i < CURRENT_BLOCK_SAMPLES; i++) {
+            s_currentFilter.push(dir < 0 ? 1 : 0, mv);
+        }
+        s_currentFilter.endBlock(now);
+        s_currentState.publish(s_currentFilter.state());
+    }
+}
+
+// --- 1. 初始化实现 ---
+
+void setupHardware() {
+    s_motorCommand.store(0);
+    s_positionCm = 0;
+
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = onSimTick;
+    timerArgs.name = "sim";
+    esp_timer_create(&timerArgs, &s_simTimer);
+    esp_timer_start_periodic(s_simTimer, SIM_TICK_US);
+
+    Serial.println("[硬件] 硬件初始化完成 (仿真模式)");
+    Serial.printf("[硬件] 仿真参数: 负载 %.1f kg, 噪声 ±%.1f cm\n", s_params.loadKg, s_params.sensorNoiseCm);
+}
+
+void setSimParams(const SimParams& params) {
+    s_params = params;
+}
+
+float simGetPositionCm() {
+    return s_publishedPositionCm.load(std::memory_order_relaxed);
+}
+
+// --- 2. 电机控制实现 ---
+// 只记下指令，下一个仿真周期生效 (真实驱动也要等 LEDC 的下一个周期)
+
+void motorGoDown(int speed) {
+    s_motorCommand.store(speed, std::memory_order_release);
+}
+
+void motorGoUp(int speed) {
+    s_motorCommand.store(-speed, std::memory_order_release);
+}
+
+void stopMotor() {
+    s_motorCommand.store(0, std::memory_order_release);
+}
+
+// --- 3. 传感器读取实现 ---
+
+void setMockTopLimit(bool pressed) {
+    s_mockTopPressed.store(pressed, std::memory_order_relaxed);
+}
+
+bool getUltrasonicState(UltrasonicState& out) {
+    return s_sensorState.read(out);
+}
+
+bool getUltrasonicReading(UltrasonicReading& out) {
+    UltrasonicState state;
+    if (!getUltrasonicState(state)) return false;
+    out.echoUs = state.echoUs;
+    out.timestampMs = state.timestampMs;
+    return true;
+}
+
+bool isTopLimitPressed() {
+    UltrasonicState state;
+    if (!getUltrasonicState(state)) return false;
+    if (millis() - state.timestampMs > ULTRASONIC_STALE_MS) return false;
+    return UltrasonicFilter::isAtTop(state);
+}
+
+// --- 4. 电流检测实现 ---
+
+void setMockJam(bool jammed) {
+    s_mockJam.store(jammed, std::memory_order_relaxed);
+}
+
+void setMockSlip(bool slipping) {
+    s_mockSlip.store(slipping, std::memory_order_relaxed);
+}
+
+bool getMotorCurrent(MotorCurrentState& out) {
+    if (!s_currentState.read(out)) return false;
+    return millis() - out.timestampMs <= CURRENT_STALE_MS;
+}
+
+#endif // USE_SIMULATED_HARDWARE
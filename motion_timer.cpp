@@ -0,0 +1,195 @@
+/**
+ * @file motion_timer.cpp
+ * @brief 运动计时核心实现
+ * @details 定时器回调、motionStart/Stop 都运行在任务上下文 (esp_timer 任务 / 控制任务)，
+ *          用同一把互斥锁串行化，保证电机 HAL 调用不会交错。
+ *          电机只经由这里驱动：每个周期按速度曲线算出占空比，变化时才写 LEDC。
+ */
+
+#include "motion_timer.h"
+#include "MotionProfile.h"
+#include "hardware_controller.h"
+#include "Config.h"
+#include <esp_timer.h>
+
+static SemaphoreHandle_t s_motionLock = nullptr;
+static esp_timer_handle_t s_motionTimer = nullptr;
+
+// 以下状态均在 s_motionLock 保护下读写
+static int s_direction = 0;                      // +1 下降, -1 上升, 0 停止
+static int s_cruisePwm = 0;
+static int s_approachPwm = 0;                    // 接近目标时的减速终点
+static int64_t s_positionUs = MOTION_POS_UNKNOWN;
+static int64_t s_targetUs = MOTION_NO_TARGET;
+static int64_t s_lastTickUs = 0;
+static int64_t s_runElapsedUs = 0;               // 本次运行已持续时间 (用于加速段)
+static int64_t s_runTravelUs = 0;                // 本次运行按标称速度折算的行程 (未乘速度比)
+static uint32_t s_upRateQ16 = 65536;             // 上升速度比 (下降单位 / 上升标称单位)
+static bool s_targetReached = false;
+static int s_appliedDir = 0;                     // 当前实际输出到 H 桥的方向/占空比
+static int s_appliedDuty = 0;
+
+static void lock() { xSemaphoreTake(s_motionLock, portMAX_DELAY); }
+static void unlock() { xSemaphoreGive(s_motionLock); }
+
+// 该方向的标称 PWM：TIME_TO_* 等位置常量都是在这个 PWM 下标定的
+static int nominalPwm(int direction) {
+    return direction < 0 ? PWM_SPEED_UP : PWM_SPEED_DOWN;
+}
+
+// 推进位置积分，返回 true 表示已越过目标
+// 斜坡段速度低于标称，按 (占空比 - 死区) 线性折算位置增量
+static bool integrateLocked(int64_t now) {
+    int64_t dt = now - s_lastTickUs;
+    s_lastTickUs = now;
+
+    if (s_direction == 0) return false;
+    s_runElapsedUs += dt;
+
+    if (s_positionUs == MOTION_POS_UNKNOWN || s_appliedDuty <= MOTOR_PWM_DEADBAND) return false;
+
+    int64_t moved = dt * (s_appliedDuty - MOTOR_PWM_DEADBAND)
+                    / (nominalPwm(s_direction) - MOTOR_PWM_DEADBAND);
+    s_runTravelUs += moved;
+    // 上升按学到的速度比换算到下降单位 (负载越重，上升越慢)
+    if (s_direction < 0) moved = (moved * s_upRateQ16) >> 16;
+    s_positionUs += s_direction * moved;
+    if (s_positionUs < 0) s_positionUs = 0; // 顶部是物理零点
+
+    if (s_targetUs == MOTION_NO_TARGET) return false;
+    return (s_direction > 0) ? (s_positionUs >= s_targetUs)
+                             : (s_positionUs <= s_targetUs);
+}
+
+// 速度曲线：加速段从 MIN_MOTOR_SPEED 升到巡航，接近目标时降到接近速度
+static int profileDutyLocked() {
+    uint16_t accel = profileRampQ8(s_runElapsedUs, (int64_t)RAMP_ACCEL_MS * 1000);
+    int duty = profileLerpDuty(MIN_MOTOR_SPEED, s_cruisePwm, accel);
+
+    if (s_targetUs != MOTION_NO_TARGET && s_positionUs != MOTION_POS_UNKNOWN) {
+        int64_t remaining = s_targetUs - s_positionUs;
+        if (remaining < 0) remaining = -remaining;
+        uint16_t decel = profileRampQ8(remaining, (int64_t)RAMP_DECEL_MS * 1000);
+        int decelDuty = profileLerpDuty(s_approachPwm, s_cruisePwm, decel);
+        if (decelDuty < duty) duty = decelDuty;
+    }
+    return duty;
+}
+
+// 只有方向或占空比变化时才调用 HAL
+static void applyLocked(int direction, int duty) {
+    if (direction == 0) duty = 0;
+    if (direction == s_appliedDir && duty == s_appliedDuty) return;
+
+    if (duty == 0) {
+        stopMotor();
+    } else if (direction > 0) {
+        motorGoDown(duty);
+    } else {
+        motorGoUp(duty);
+    }
+    s_appliedDir = duty ? direction : 0;
+    s_appliedDuty = duty;
+}
+
+// 定时器回调 (esp_timer 任务上下文)
+static void onMotionTick(void* arg) {
+    lock();
+    if (integrateLocked(esp_timer_get_time())) {
+        s_direction = 0;
+        s_targetReached = true;
+    }
+    applyLocked(s_direction, s_direction ? profileDutyLocked() : 0);
+    unlock();
+}
+
+void setupMotionTimer() {
+    s_motionLock = xSemaphoreCreateMutex();
+    s_lastTickUs = esp_timer_get_time();
+
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = onMotionTick;
+    timerArgs.name = "motion";
+    esp_timer_create(&timerArgs, &s_motionTimer);
+    esp_timer_start_periodic(s_motionTimer, MOTION_TIMER_PERIOD_US);
+
+    Serial.printf("[Motion] Timer started (%lu us period)\n", MOTION_TIMER_PERIOD_US);
+}
+
+void motionStart(int direction, int pwm_val, int64_t targetUs, int approachPwm) {
+    lock();
+    integrateLocked(esp_timer_get_time()); // 结算上一段，避免把停机时间算进来
+    if (direction != s_direction) {
+        // 换向或从静止启动：重新软启动，重新统计行程
+        s_runElapsedUs = 0;
+        s_runTravelUs = 0;
+    }
+    s_direction = direction;
+    s_cruisePwm = pwm_val;
+    s_approachPwm = approachPwm;
+    s_targetUs = targetUs;
+    s_targetReached = false;
+    applyLocked(s_direction, s_direction ? profileDutyLocked() : 0);
+    unlock();
+}
+
+void motionStop() {
+    // 急停/主动停止不走减速曲线，立即断开
+    lock();
+    integrateLocked(esp_timer_get_time());
+    s_direction = 0;
+    applyLocked(0, 0);
+    unlock();
+}
+
+bool motionIsRunning() {
+    lock();
+    bool running = s_direction != 0;
+    unlock();
+    return running;
+}
+
+bool motionConsumeTargetReached() {
+    lock();
+    bool reached = s_targetReached;
+    s_targetReached = false;
+    unlock();
+    return reached;
+}
+
+int64_t motionGetPositionUs() {
+    lock();
+    integrateLocked(esp_timer_get_time()); // 读取时顺带结算，得到 us 级实时位置
+    int64_t pos = s_positionUs;
+    unlock();
+    return pos;
+}
+
+void motionSetPositionUs(int64_t positionUs) {
+    lock();
+    integrateLocked(esp_timer_get_time());
+    s_positionUs = positionUs;
+    unlock();
+}
+
+int motionGetAppliedDuty() {
+    lock();
+    int duty = s_appliedDuty;
+    unlock();
+    return duty;
+}
+
+void motionSetUpRateQ16(uint32_t rateQ16) {
+    lock();
+    integrateLocked(esp_timer_get_time()); // 已走过的部分按旧比值结算
+    s_upRateQ16 = rateQ16;
+    unlock();
+}
+
+int64_t motionGetRunTravelUs() {
+    lock();
+    integrateLocked(esp_timer_get_time());
+    int64_t travel = s_runTravelUs;
+    unlock();
+    return travel;
+}
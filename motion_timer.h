@@ -0,0 +1,67 @@
+/**
+ * @file motion_timer.h
+ * @brief 运动计时核心 (Motion Timing Core)
+ * @details 由 esp_timer 周期性回调累计电机运行时间 (us)，与 loop() 调用频率无关；
+ *          到达目标位置时直接在定时器上下文里停机，停层精度不再受 Blynk/串口拖累。
+ *          位置单位仍沿用“标称 PWM 下的运行时间”，只是精度从 ms 提升到 us。
+ *          电机占空比也由定时器按速度曲线 (MotionProfile.h) 输出：软启动、接近目标时减速。
+ */
+
+#ifndef MOTION_TIMER_H
+#define MOTION_TIMER_H
+
+#include <Arduino.h>
+
+// 位置未知 (未校准)
+constexpr int64_t MOTION_POS_UNKNOWN = INT64_MIN;
+// 不设停止目标 (例如向上找限位)
+constexpr int64_t MOTION_NO_TARGET = INT64_MIN;
+
+/**
+ * @brief 创建并启动周期定时器，需在 setupHardware() 之后调用
+ */
+void setupMotionTimer();
+
+/**
+ * @brief 启动电机并开始计时
+ * @param direction +1 下降, -1 上升
+ * @param pwm_val 巡航 PWM 占空比 (加速/减速段由速度曲线决定)
+ * @param targetUs 到达该位置时由定时器停机；MOTION_NO_TARGET 表示不自动停
+ * @param approachPwm 接近目标时减速到的占空比 (通常取目标楼层的设定)
+ */
+void motionStart(int direction, int pwm_val, int64_t targetUs, int approachPwm);
+
+/**
+ * @brief 立即停机并停止计时 (不走减速曲线)
+ */
+void motionStop();
+
+/**
+ * @brief 当前是否有方向在运行 (被定时器停下后返回 false)
+ */
+bool motionIsRunning();
+
+/**
+ * @brief 取走“已到达目标”标志 (读一次后清零)
+ */
+bool motionConsumeTargetReached();
+
+int64_t motionGetPositionUs();
+void motionSetPositionUs(int64_t positionUs);
+
+/**
+ * @brief 当前实际输出的占空比 (0 表示停止)
+ */
+int motionGetAppliedDuty();
+
+/**
+ * @brief 设置上升速度比 (Q16，65536 = 与下降同速)，上升时位置增量乘以该比值
+ */
+void motionSetUpRateQ16(uint32_t rateQ16);
+
+/**
+ * @brief 本次运行按标称速度折算的行程 (us，未乘速度比)，换向/重新启动时清零
+ */
+int64_t motionGetRunTravelUs();
+
+#endif
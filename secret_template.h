@@ -16,4 +16,8 @@
 #define BLYNK_TEMPLATE_NAME "Smart Hoist"
 #define BLYNK_AUTH_TOKEN    "Your_Blynk_Token_Here"
 
+// 3. 局域网 UDP 控制密钥 (32 位，非 0)，tools/local_client 用 --key 传入
+// 不定义时局域网只能急停和订阅状态，楼层指令一律拒绝
+// #define LOCAL_CONTROL_KEY 0x12345678UL
+
 #endif
\ No newline at end of file
@@ -0,0 +1,137 @@
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+/*
+ * 主机仿真用的 Arduino.h 替身
+ * 只提供固件实际用到的接口：时间来自 sim_host 的虚拟时钟，串口文本写到 stdout，
+ * 二进制遥测 (Serial.write) 写到 simSerialCapture() 指定的文件。
+ * 仿真是单线程的：临界区、互斥锁都是空操作，任务不会真的创建。
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <cstdlib>
+#include "sim_host.h"
+
+#define IRAM_ATTR
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define CHANGE 3
+
+typedef uint8_t byte;
+
+using std::abs;
+using std::max;
+using std::min;
+
+inline unsigned long millis() { return (unsigned long)(simNowUs() / 1000); }
+inline unsigned long micros() { return (unsigned long)simNowUs(); }
+inline void delay(unsigned long ms) { simAdvanceUs((int64_t)ms * 1000); }
+inline void delayMicroseconds(unsigned int us) { simAdvanceUs(us); }
+
+inline void pinMode(int, int) {}
+inline void digitalWrite(int, int) {}
+inline int digitalRead(int) { return LOW; }
+inline void analogWrite(int, int) {}
+inline int analogRead(int) { return 0; }
+
+inline void randomSeed(unsigned long seed) { simRandomSeed(seed); }
+inline long random(long howBig) { return howBig > 0 ? (long)(simRandom() % (uint32_t)howBig) : 0; }
+inline long random(long howSmall, long howBig) {
+    return howSmall >= howBig ? howSmall : howSmall + random(howBig - howSmall);
+}
+
+template <class T>
+T constrain(T v, T lo, T hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+inline uint32_t getCpuFrequencyMhz() { return simCpuMhz(); }
+inline void configTime(long gmtOffsetSec, int daylightOffsetSec, const char*, const char* = nullptr,
+                       const char* = nullptr) {
+    simConfigTime(gmtOffsetSec, daylightOffsetSec);
+}
+
+class HardwareSerial {
+public:
+    void begin(unsigned long) {}
+    void setTxBufferSize(size_t) {}
+    void flush() { fflush(stdout); }
+    int available() { return 0; }
+    int read() { return -1; }
+    int availableForWrite() { return 4096; }
+    size_t write(uint8_t b) { return simSerialWrite(&b, 1); }
+    size_t write(const uint8_t* data, size_t len) { return simSerialWrite(data, len); }
+
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, fmt);
+        size_t n = simSerialVprintf(fmt, args);
+        va_end(args);
+        return n;
+    }
+    size_t print(const char* s) { return printf("%s", s); }
+    size_t print(char c) { return printf("%c", c); }
+    size_t print(int v) { return printf("%d", v); }
+    size_t print(long v) { return printf("%ld", v); }
+    size_t print(unsigned long v) { return printf("%lu", v); }
+    size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+    size_t println() { return printf("\n"); }
+    template <typename T>
+    size_t println(T v) { return print(v) + println(); }
+    size_t println(double v, int digits) { return print(v, digits) + println(); }
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+    uint32_t getCycleCount() { return simCycleCount(); }
+    uint32_t getFreeHeap() { return 0; }
+    void restart() { exit(0); }
+};
+
+extern EspClass ESP;
+
+// --- ESP32 Arduino 核心经 Arduino.h 暴露的 FreeRTOS 接口 ---
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED { 0 }
+inline void portENTER_CRITICAL(portMUX_TYPE*) {}
+inline void portEXIT_CRITICAL(portMUX_TYPE*) {}
+inline void portENTER_CRITICAL_ISR(portMUX_TYPE*) {}
+inline void portEXIT_CRITICAL_ISR(portMUX_TYPE*) {}
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef void* TaskHandle_t;
+typedef void* SemaphoreHandle_t;
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS 1
+#define portMAX_DELAY 0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+inline TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+inline void vTaskDelay(TickType_t ticks) { delay(ticks); }
+inline void vTaskDelayUntil(TickType_t* lastWake, TickType_t period) {
+    *lastWake += period;
+    int64_t wakeUs = (int64_t)*lastWake * 1000;
+    if (wakeUs > simNowUs()) simAdvanceUs(wakeUs - simNowUs());
+}
+inline void vTaskDelete(TaskHandle_t) {}
+// 仿真不创建任务：由 tools/ 里的主程序按周期调用各任务的循环体
+inline BaseType_t xTaskCreatePinnedToCore(void (*)(void*), const char*, uint32_t, void*, int, TaskHandle_t*, int) {
+    return pdPASS;
+}
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return (SemaphoreHandle_t)1; }
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t) { return pdTRUE; }
+
+#endif
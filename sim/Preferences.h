@@ -0,0 +1,52 @@
+#ifndef SIM_PREFERENCES_H
+#define SIM_PREFERENCES_H
+
+/*
+ * 主机仿真用的 Preferences.h 替身 (NVS 的文件模拟)
+ * 每个命名空间是一组 key -> 字节串，整个“Flash”在进程内共享；
+ * simNvsOpen(path) 之后每次写入都落到该文件，下一次运行可以从同一个文件“重启”。
+ * 写入次数 (simNvsWriteCount) 用来检查哪些路径在写 Flash。
+ */
+
+#include <Arduino.h>
+
+class Preferences {
+private:
+    char _namespace[16] = "";
+    bool _readOnly = false;
+    bool _open = false;
+
+    size_t put(const char* key, const void* data, size_t len);
+    size_t get(const char* key, void* out, size_t maxLen) const;
+
+    template <typename T>
+    T getValue(const char* key, T defaultValue) const {
+        T v;
+        return get(key, &v, sizeof(v)) == sizeof(v) ? v : defaultValue;
+    }
+
+public:
+    bool begin(const char* name, bool readOnly = false);
+    void end() { _open = false; }
+
+    bool isKey(const char* key) const;
+    bool remove(const char* key);
+    bool clear();
+
+    size_t putBytes(const char* key, const void* data, size_t len) { return put(key, data, len); }
+    size_t getBytes(const char* key, void* out, size_t maxLen) const { return get(key, out, maxLen); }
+    size_t getBytesLength(const char* key) const;
+
+    size_t putUChar(const char* key, uint8_t v) { return put(key, &v, sizeof(v)); }
+    uint8_t getUChar(const char* key, uint8_t d = 0) const { return getValue(key, d); }
+    size_t putBool(const char* key, bool v) { return putUChar(key, v ? 1 : 0); }
+    bool getBool(const char* key, bool d = false) const { return getUChar(key, d ? 1 : 0) != 0; }
+    size_t putInt(const char* key, int32_t v) { return put(key, &v, sizeof(v)); }
+    int32_t getInt(const char* key, int32_t d = 0) const { return getValue(key, d); }
+    size_t putUInt(const char* key, uint32_t v) { return put(key, &v, sizeof(v)); }
+    uint32_t getUInt(const char* key, uint32_t d = 0) const { return getValue(key, d); }
+    size_t putLong(const char* key, int32_t v) { return put(key, &v, sizeof(v)); }
+    int32_t getLong(const char* key, int32_t d = 0) const { return getValue(key, d); }
+};
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef REPLAY_HARDWARE_H
+#define REPLAY_HARDWARE_H
+
+/*
+ * 回放用的硬件抽象层 (hardware_replay.cpp)：没有电机 / 绳索模型，
+ * 状态机读到的到顶判断、超声波状态和电流全部来自录制的 TLM_INPUT 帧 (InputRecorder.h)，
+ * 由 tools/replay_runner 按时间顺序设置。电机指令只记下来，供报告使用。
+ */
+
+#include "../hardware_controller.h"
+
+void replaySetTopLimit(bool pressed);
+void replaySetSensor(const UltrasonicState& state);
+void replaySetCurrent(bool available, const MotorCurrentState& state);
+int replayGetMotorCommand(); // >0 下降, <0 上升, 0 停止 (绝对值为占空比)
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef SIM_RIG_H
+#define SIM_RIG_H
+
+/*
+ * 主机仿真台架：真实的状态机 / 维护管理器 + 仿真硬件 (hardware_sim.cpp) + 虚拟时钟
+ * cycle() 按 SmartElevator.ino 控制任务的顺序跑一个周期，再把虚拟时间推进一个控制周期；
+ * 运动定时器、仿真定时器在推进途中按各自的周期回调，与固件里的 esp_timer 一样。
+ * 使用者需要定义全局的 TelemetryLog telemetry (固件里定义在 SmartElevator.ino)。
+ * 要录制状态机输入 (tools/replay_runner 回放) 时，在 begin() 之前打开 inputs，指令经 goFloor() 下发。
+ */
+
+#include <Arduino.h>
+#include "../Config.h"
+#include "../hardware_controller.h"
+#include "../motion_timer.h"
+#include "../HoistStateMachine.h"
+#include "../MaintenanceManager.h"
+#include "../Telemetry.h"
+#include "../InputRecorder.h"
+#include "../PositionCheckpoint.h"
+#include "../ControlChannel.h"
+
+// 默认的模型参数 (Config.h 的 SIM_*)
+inline SimParams simDefaultParams() {
+    return { SIM_LOAD_KG, SIM_SENSOR_NOISE_CM, SIM_FULL_SPEED_CM_S, SIM_PWM_DEADBAND };
+}
+
+// 模型里的速度 (cm/s)，与 hardware_sim.cpp 的公式一致；用来把楼层位置 (ms) 换算成 cm
+inline float simModelSpeedCmS(const SimParams& p, int direction, int pwm) {
+    if (pwm <= p.pwmDeadband) return 0;
+    float speed = p.fullSpeedCmS * (pwm - p.pwmDeadband) / (MAX_MOTOR_SPEED - p.pwmDeadband);
+    return direction < 0 ? speed * (1.0f - p.loadKg * SIM_UP_SLOWDOWN_PER_KG)
+                         : speed * (1.0f + p.loadKg * SIM_DOWN_SPEEDUP_PER_KG);
+}
+
+// 楼层的物理位置：楼层表按默认参数下、标称下降 PWM 的运行时间标定
+inline float simFloorCm(uint8_t floor) {
+    return floorPositionMs(floor) / 1000.0f * simModelSpeedCmS(simDefaultParams(), 1, PWM_SPEED_DOWN);
+}
+
+class SimRig {
+public:
+    HoistStateMachine hoist;
+    MaintenanceManager maintenance;
+    InputRecorder inputs;
+    PositionCheckpoint checkpoint;
+
+    /**
+     * @brief 像上电一样初始化；calibrate 为 true 时随后自动归零
+     */
+    void begin(const SimParams& params, bool calibrate = true) {
+        setSimParams(params);
+        setupHardware();
+        setupMotionTimer();
+        telemetry.begin();
+        maintenance.begin();
+        checkpoint.begin();
+        hoist.bindMaintenanceManager(&maintenance);
+        hoist.begin();
+        // 等超声波管线攒够样本 (固件里是 setup 的其余部分和网络初始化的时间)
+        simAdvanceUs((int64_t)ULTRASONIC_PERIOD_US * ULTRASONIC_MEDIAN_WINDOW);
+        if (calibrate) goFloor(FLOOR_TOP);
+    }
+
+    /**
+     * @brief 像网络任务发指令一样前往楼层；录制时先记下当前传感器输入，再记指令
+     */
+    void goFloor(uint8_t floor) {
+        observeInputs();
+        inputs.command(CMD_GO_FLOOR, floor);
+        hoist.commandGoFloor(floor);
+    }
+
+    // 控制任务的一个周期 (末尾是网络任务写 Flash / 串口的那部分)，然后推进虚拟时间
+    void cycle() {
+        observeInputs();
+        hoist.update();
+        SystemState state = hoist.getState();
+        checkpoint.update(state == STATE_IDLE, hoist.getCurrentPosition(), hoist.getTravelSinceHomeMs());
+        maintenance.update(state == STATE_IDLE || state == STATE_POS_UNKNOWN);
+        checkpoint.service();
+        maintenance.service();
+        telemetry.drain();
+        simAdvanceUs((int64_t)CONTROL_TASK_PERIOD_MS * 1000);
+    }
+
+    // 与 SmartElevator.ino 控制任务开头的输入读取一致 (不录制时不读)
+    void observeInputs() {
+        if (!inputs.isEnabled()) return;
+        UltrasonicState sensor;
+        bool haveSensor = getUltrasonicState(sensor);
+        inputs.observe(isTopLimitPressed(), haveSensor ? &sensor : nullptr);
+    }
+
+    // 没有在动，也没有排队的停点
+    bool settled() {
+        SystemState s = hoist.getState();
+        return s != STATE_CALIBRATING && s != STATE_MOVING_UP && s != STATE_MOVING_DOWN &&
+               hoist.getPendingStops() == 0 && !motionIsRunning();
+    }
+
+    /**
+     * @brief 一直运行到静止
+     * @return 用掉的虚拟时间 (ms)，超时返回 -1
+     */
+    long runUntilSettled(unsigned long timeoutMs) {
+        unsigned long start = millis();
+        do {
+            cycle();
+        } while (!settled() && millis() - start < timeoutMs);
+        return settled() ? (long)(millis() - start) : -1;
+    }
+
+    /**
+     * @brief 静止时快进 ms：每 stepMs 只跑一个控制周期，空闲落盘等按时间触发的逻辑照常发生
+     */
+    void idleFor(unsigned long ms, unsigned long stepMs = 1000) {
+        unsigned long end = millis() + ms;
+        while ((long)(end - millis()) > 0) {
+            cycle();
+            long left = (long)(end - millis());
+            if (left <= 0) break;
+            simSkipUs((int64_t)(left < (long)stepMs ? left : (long)stepMs) * 1000);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef SIM_WIFI_H
+#define SIM_WIFI_H
+
+/*
+ * 主机仿真用的 WiFi.h 替身
+ * 只有 LocalControl.h 用到的部分：IPAddress 和 WiFi.localIP()。“Wi-Fi”就是主机的回环网卡，
+ * UDP 见同目录的 WiFiUdp.h (真实的 socket，主机程序可以用 tools/local_client 连上来)。
+ */
+
+#include <Arduino.h>
+#include <string>
+#include <arpa/inet.h>
+
+class IPAddress {
+private:
+    uint32_t _addr = 0; // 网络字节序
+
+public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : _addr(htonl((uint32_t)a << 24 | (uint32_t)b << 16 | (uint32_t)c << 8 | d)) {}
+    static IPAddress fromNetwork(uint32_t addr) {
+        IPAddress ip;
+        ip._addr = addr;
+        return ip;
+    }
+
+    uint32_t network() const { return _addr; }
+    bool operator==(const IPAddress& other) const { return _addr == other._addr; }
+
+    std::string toString() const {
+        char buf[INET_ADDRSTRLEN] = "";
+        in_addr a = { _addr };
+        inet_ntop(AF_INET, &a, buf, sizeof(buf));
+        return buf;
+    }
+};
+
+class WiFiClass {
+public:
+    IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+};
+
+inline WiFiClass WiFi;
+
+#endif
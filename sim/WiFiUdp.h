@@ -0,0 +1,90 @@
+#ifndef SIM_WIFI_UDP_H
+#define SIM_WIFI_UDP_H
+
+/*
+ * 主机仿真用的 WiFiUdp.h 替身：接口与 ESP32 的 WiFiUDP 相同，底下是非阻塞的 POSIX UDP socket
+ * parsePacket() 取一个已到达的包 (没有就返回 0)，read() 从中读取；
+ * beginPacket() / write() / endPacket() 攒出一个包再一次发出。
+ */
+
+#include <Arduino.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "WiFi.h"
+
+class WiFiUDP {
+private:
+    int _fd = -1;
+    uint8_t _rx[1500];
+    int _rxLen = 0, _rxPos = 0;
+    sockaddr_in _remote = {};
+    uint8_t _tx[1500];
+    size_t _txLen = 0;
+    sockaddr_in _dest = {};
+
+public:
+    uint8_t begin(uint16_t port) {
+        stop();
+        _fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (_fd < 0) return 0;
+        int one = 1;
+        setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        if (bind(_fd, (const sockaddr*)&addr, sizeof(addr)) != 0 || fcntl(_fd, F_SETFL, O_NONBLOCK) != 0) {
+            stop();
+            return 0;
+        }
+        return 1;
+    }
+
+    void stop() {
+        if (_fd >= 0) close(_fd);
+        _fd = -1;
+    }
+
+    int parsePacket() {
+        _rxLen = _rxPos = 0;
+        if (_fd < 0) return 0;
+        socklen_t len = sizeof(_remote);
+        ssize_t n = recvfrom(_fd, _rx, sizeof(_rx), 0, (sockaddr*)&_remote, &len);
+        _rxLen = n > 0 ? (int)n : 0;
+        return _rxLen;
+    }
+
+    int read(uint8_t* buf, size_t len) {
+        int n = std::min((int)len, _rxLen - _rxPos);
+        memcpy(buf, _rx + _rxPos, n);
+        _rxPos += n;
+        return n;
+    }
+
+    IPAddress remoteIP() { return IPAddress::fromNetwork(_remote.sin_addr.s_addr); }
+    uint16_t remotePort() { return ntohs(_remote.sin_port); }
+
+    int beginPacket(IPAddress ip, uint16_t port) {
+        _dest = {};
+        _dest.sin_family = AF_INET;
+        _dest.sin_port = htons(port);
+        _dest.sin_addr.s_addr = ip.network();
+        _txLen = 0;
+        return _fd >= 0;
+    }
+
+    size_t write(const uint8_t* data, size_t len) {
+        len = std::min(len, sizeof(_tx) - _txLen);
+        memcpy(_tx + _txLen, data, len);
+        _txLen += len;
+        return len;
+    }
+
+    int endPacket() {
+        return _fd >= 0 && sendto(_fd, _tx, _txLen, 0, (const sockaddr*)&_dest, sizeof(_dest)) == (ssize_t)_txLen;
+    }
+};
+
+#endif
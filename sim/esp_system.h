@@ -0,0 +1,13 @@
+#ifndef SIM_ESP_SYSTEM_H
+#define SIM_ESP_SYSTEM_H
+
+// 主机仿真用的 esp_system.h 替身
+
+typedef enum {
+    ESP_RST_UNKNOWN,
+    ESP_RST_POWERON
+} esp_reset_reason_t;
+
+inline esp_reset_reason_t esp_reset_reason() { return ESP_RST_POWERON; }
+
+#endif
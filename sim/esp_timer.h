@@ -0,0 +1,30 @@
+#ifndef SIM_ESP_TIMER_H
+#define SIM_ESP_TIMER_H
+
+/*
+ * 主机仿真用的 esp_timer.h 替身：周期定时器挂在 sim_host 的虚拟时钟上，
+ * 时钟推进到到期时间时按时间顺序调用回调 (与 esp_timer 任务一样串行)。
+ */
+
+#include <stdint.h>
+#include "sim_host.h"
+
+typedef int esp_err_t;
+#define ESP_OK 0
+
+typedef struct SimTimer* esp_timer_handle_t;
+
+typedef struct {
+    void (*callback)(void* arg);
+    void* arg;
+    int dispatch_method;
+    const char* name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out);
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+inline int64_t esp_timer_get_time() { return simNowUs(); }
+
+#endif
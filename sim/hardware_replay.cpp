@@ -0,0 +1,64 @@
+/**
+ * @file hardware_replay.cpp
+ * @brief 硬件抽象层的回放实现 (见 ReplayHardware.h)，只在主机上与 tools/replay_runner 一起编译
+ */
+
+#include "ReplayHardware.h"
+
+static int s_motorCommand = 0;
+static bool s_topPressed = false;
+static bool s_haveSensor = false;
+static UltrasonicState s_sensor = {};
+static bool s_haveCurrent = false;
+static MotorCurrentState s_current = {};
+
+void setupHardware() {
+    s_motorCommand = 0;
+    Serial.println("[硬件] 硬件初始化完成 (回放模式)");
+}
+
+void replaySetTopLimit(bool pressed) { s_topPressed = pressed; }
+
+void replaySetSensor(const UltrasonicState& state) {
+    s_sensor = state;
+    s_haveSensor = true;
+}
+
+void replaySetCurrent(bool available, const MotorCurrentState& state) {
+    s_haveCurrent = available;
+    s_current = state;
+}
+
+int replayGetMotorCommand() { return s_motorCommand; }
+
+void motorGoDown(int speed) { s_motorCommand = speed; }
+
+void motorGoUp(int speed) { s_motorCommand = -speed; }
+
+void stopMotor() { s_motorCommand = 0; }
+
+bool isTopLimitPressed() { return s_topPressed; }
+
+bool getUltrasonicState(UltrasonicState& out) {
+    if (!s_haveSensor) return false;
+    out = s_sensor;
+    return true;
+}
+
+bool getUltrasonicReading(UltrasonicReading& out) {
+    if (!s_haveSensor) return false;
+    out.echoUs = s_sensor.echoUs;
+    out.timestampMs = s_sensor.timestampMs;
+    return true;
+}
+
+bool getMotorCurrent(MotorCurrentState& out) {
+    if (!s_haveCurrent) return false;
+    out = s_current;
+    return true;
+}
+
+// 录制里已经是结果，调试开关在回放中没有意义
+void setMockTopLimit(bool) {}
+void setMockJam(bool) {}
+void setMockSlip(bool) {}
@@ -0,0 +1,268 @@
+/**
+ * @file sim_host.cpp
+ * @brief 主机仿真运行时的实现 (见 sim_host.h)
+ */
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <esp_timer.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// --- 虚拟时钟与定时器 ---
+
+struct SimTimer {
+    void (*callback)(void*);
+    void* arg;
+    int64_t periodUs;
+    int64_t dueUs;
+    bool active;
+};
+
+static int64_t s_nowUs = 0;
+static std::vector<SimTimer*> s_timers;
+
+int64_t simNowUs() { return s_nowUs; }
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out) {
+    SimTimer* t = new SimTimer{ args->callback, args->arg, 0, 0, false };
+    s_timers.push_back(t);
+    *out = t;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) {
+    timer->periodUs = (int64_t)periodUs;
+    timer->dueUs = s_nowUs + timer->periodUs;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    timer->active = false;
+    return ESP_OK;
+}
+
+// 最早到期的定时器 (同时到期按创建顺序)
+static SimTimer* nextDue(int64_t limitUs) {
+    SimTimer* best = nullptr;
+    for (SimTimer* t : s_timers) {
+        if (t->active && t->dueUs <= limitUs && (!best || t->dueUs < best->dueUs)) best = t;
+    }
+    return best;
+}
+
+void simAdvanceUs(int64_t us) {
+    int64_t end = s_nowUs + us;
+    while (SimTimer* t = nextDue(end)) {
+        s_nowUs = t->dueUs;
+        t->dueUs += t->periodUs;
+        t->callback(t->arg);
+    }
+    s_nowUs = end;
+}
+
+void simSkipUs(int64_t us) {
+    s_nowUs += us;
+    for (SimTimer* t : s_timers) {
+        if (!t->active) continue;
+        t->dueUs = s_nowUs + t->periodUs;
+        t->callback(t->arg);
+    }
+}
+
+// --- 墙上时间 ---
+
+static time_t s_wallAtZero = 1767225600; // 2026-01-01 00:00:00 UTC
+
+void simSetWallClock(time_t epochAtZero) { s_wallAtZero = epochAtZero; }
+
+time_t simWallTime(time_t* out) {
+    time_t now = s_wallAtZero + (time_t)(s_nowUs / 1000000);
+    if (out) *out = now;
+    return now;
+}
+
+void simConfigTime(long gmtOffsetSec, int daylightOffsetSec) {
+    // 与 ESP32 的 configTime 一样换成 POSIX TZ (符号相反)
+    char tz[32];
+    long offset = gmtOffsetSec + daylightOffsetSec;
+    snprintf(tz, sizeof(tz), "UTC%+ld:%02ld", -offset / 3600, (labs(offset) % 3600) / 60);
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+// --- 随机数与周期计数 ---
+
+static uint32_t s_random = 2463534242u;
+
+void simRandomSeed(uint32_t seed) { s_random = seed ? seed : 2463534242u; }
+
+uint32_t simRandom() {
+    // xorshift32：每次运行序列相同
+    s_random ^= s_random << 13;
+    s_random ^= s_random >> 17;
+    s_random ^= s_random << 5;
+    return s_random;
+}
+
+static uint64_t hostTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+uint32_t simCycleCount() { return (uint32_t)hostTicks(); }
+
+uint32_t simCpuMhz() {
+    static uint32_t mhz = 0;
+    if (mhz == 0) {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t t0 = hostTicks();
+        while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(20)) {
+        }
+        uint64_t t1 = hostTicks();
+        int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        mhz = (uint32_t)((t1 - t0) * 1000 / (uint64_t)ns);
+        if (mhz == 0) mhz = 1;
+    }
+    return mhz;
+}
+
+// --- 串口 ---
+
+static FILE* s_capture = nullptr;
+static bool s_quiet = false;
+
+void simSerialCapture(FILE* binary) { s_capture = binary; }
+void simSerialQuiet(bool quiet) { s_quiet = quiet; }
+
+size_t simSerialWrite(const uint8_t* data, size_t len) {
+    if (s_capture) fwrite(data, 1, len, s_capture);
+    return len;
+}
+
+size_t simSerialVprintf(const char* fmt, va_list args) {
+    if (s_quiet) return 0;
+    int n = vprintf(fmt, args);
+    return n > 0 ? (size_t)n : 0;
+}
+
+// --- NVS ---
+// 文件格式：逐条 [命名空间长度 u8][命名空间][key 长度 u8][key][值长度 u32][值]
+
+typedef std::map<std::string, std::vector<uint8_t>> NvsNamespace;
+static std::map<std::string, NvsNamespace> s_nvs;
+static std::string s_nvsPath;
+static uint32_t s_nvsWrites = 0;
+
+static void nvsSave() {
+    if (s_nvsPath.empty()) return;
+    FILE* f = fopen(s_nvsPath.c_str(), "wb");
+    if (!f) return;
+    for (const auto& ns : s_nvs) {
+        for (const auto& kv : ns.second) {
+            uint8_t nsLen = (uint8_t)ns.first.size(), keyLen = (uint8_t)kv.first.size();
+            uint32_t len = (uint32_t)kv.second.size();
+            fwrite(&nsLen, 1, 1, f);
+            fwrite(ns.first.data(), 1, nsLen, f);
+            fwrite(&keyLen, 1, 1, f);
+            fwrite(kv.first.data(), 1, keyLen, f);
+            fwrite(&len, sizeof(len), 1, f);
+            fwrite(kv.second.data(), 1, len, f);
+        }
+    }
+    fclose(f);
+}
+
+bool simNvsOpen(const char* path) {
+    s_nvs.clear();
+    s_nvsPath = path;
+    FILE* f = fopen(path, "rb");
+    if (!f) return false; // 新文件：空 Flash
+    uint8_t nsLen, keyLen;
+    uint32_t len;
+    char ns[256], key[256];
+    while (fread(&nsLen, 1, 1, f) == 1) {
+        if (fread(ns, 1, nsLen, f) != nsLen || fread(&keyLen, 1, 1, f) != 1 ||
+            fread(key, 1, keyLen, f) != keyLen || fread(&len, sizeof(len), 1, f) != 1) {
+            break;
+        }
+        std::vector<uint8_t> value(len);
+        if (fread(value.data(), 1, len, f) != len) break;
+        s_nvs[std::string(ns, nsLen)][std::string(key, keyLen)] = value;
+    }
+    fclose(f);
+    return true;
+}
+
+void simNvsReset() {
+    s_nvs.clear();
+    nvsSave();
+}
+
+uint32_t simNvsWriteCount() { return s_nvsWrites; }
+
+bool Preferences::begin(const char* name, bool readOnly) {
+    snprintf(_namespace, sizeof(_namespace), "%s", name);
+    _readOnly = readOnly;
+    _open = true;
+    return true;
+}
+
+size_t Preferences::put(const char* key, const void* data, size_t len) {
+    if (!_open || _readOnly) return 0;
+    const uint8_t* p = (const uint8_t*)data;
+    s_nvs[_namespace][key].assign(p, p + len);
+    s_nvsWrites++;
+    nvsSave();
+    return len;
+}
+
+size_t Preferences::get(const char* key, void* out, size_t maxLen) const {
+    if (!_open) return 0;
+    auto ns = s_nvs.find(_namespace);
+    if (ns == s_nvs.end()) return 0;
+    auto kv = ns->second.find(key);
+    if (kv == ns->second.end() || kv->second.size() > maxLen) return 0;
+    memcpy(out, kv->second.data(), kv->second.size());
+    return kv->second.size();
+}
+
+size_t Preferences::getBytesLength(const char* key) const {
+    auto ns = s_nvs.find(_namespace);
+    if (!_open || ns == s_nvs.end()) return 0;
+    auto kv = ns->second.find(key);
+    return kv == ns->second.end() ? 0 : kv->second.size();
+}
+
+bool Preferences::isKey(const char* key) const {
+    auto ns = s_nvs.find(_namespace);
+    return _open && ns != s_nvs.end() && ns->second.count(key) != 0;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!_open || _readOnly || !s_nvs[_namespace].erase(key)) return false;
+    s_nvsWrites++;
+    nvsSave();
+    return true;
+}
+
+bool Preferences::clear() {
+    if (!_open || _readOnly) return false;
+    s_nvs.erase(_namespace);
+    s_nvsWrites++;
+    nvsSave();
+    return true;
+}
@@ -0,0 +1,53 @@
+#ifndef SIM_HOST_H
+#define SIM_HOST_H
+
+/*
+ * 主机仿真运行时：虚拟时钟、虚拟定时器、串口输出、文件模拟的 NVS
+ * 固件代码只经由 sim/ 下的 Arduino.h / esp_timer.h / Preferences.h / time.h 间接使用这里；
+ * tools/ 里的主机程序直接调用 simAdvanceUs() 等推进时间。
+ * 时间从 0 开始，只在调用 simAdvanceUs() / simSkipUs() 时前进，同样的输入每次结果完全一样。
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <time.h>
+
+// --- 虚拟时钟 ---
+int64_t simNowUs();
+
+/**
+ * @brief 推进虚拟时间，途中到期的定时器按时间顺序逐个回调
+ */
+void simAdvanceUs(int64_t us);
+
+/**
+ * @brief 快进：时间直接跳过去，每个定时器只在终点回调一次
+ * 只能在电机停止、没有任何东西在动的时候用 (例如两次定时行程之间的空闲)，
+ * 一天的仿真因此只花在真正运行的那几分钟上。
+ */
+void simSkipUs(int64_t us);
+
+// --- 墙上时间 (调度器的 time()) ---
+void simSetWallClock(time_t epochAtZero); // 虚拟时间 0 对应的 UTC 时刻
+void simConfigTime(long gmtOffsetSec, int daylightOffsetSec);
+
+// --- 其它 ---
+void simRandomSeed(uint32_t seed);
+uint32_t simRandom();
+uint32_t simCycleCount(); // 主机 CPU 周期计数 (基准测试用，与虚拟时钟无关)
+uint32_t simCpuMhz();
+
+// --- 串口 ---
+size_t simSerialWrite(const uint8_t* data, size_t len);
+size_t simSerialVprintf(const char* fmt, va_list args);
+void simSerialCapture(FILE* binary); // Serial.write 的去处，nullptr 表示丢弃
+void simSerialQuiet(bool quiet);     // 不打印文本日志
+
+// --- NVS ---
+bool simNvsOpen(const char* path);   // 读入并在之后每次写入时保存到该文件
+void simNvsReset();                  // 清空 (相当于整片擦除)
+uint32_t simNvsWriteCount();
+
+#endif
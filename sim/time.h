@@ -0,0 +1,14 @@
+#ifndef SIM_TIME_H
+#define SIM_TIME_H
+
+/*
+ * 主机仿真用的 time.h 替身：time() 改读虚拟墙上时间 (sim_host)，
+ * 调度器的 NTP 日历逻辑因此跟着虚拟时钟走。其余内容来自系统的 time.h。
+ */
+
+#include_next <time.h>
+
+time_t simWallTime(time_t* out);
+#define time(out) simWallTime(out)
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef CAPTURE_REPORT_H
+#define CAPTURE_REPORT_H
+
+/*
+ * 录制数据分析 (telemetry_decode --report 和 replay_runner 共用)
+ * 按时间顺序喂入帧，统计：楼层指令 -> 开始运行、急停 -> ERROR、到顶判断 -> 停机的延迟，
+ * 每段行程的停点偏差 (过冲)，以及各状态切换的次数。状态帧按顺序保存下来，回放时逐条比对。
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include "../Config.h"
+#include "../TelemetryFormat.h"
+
+// 与 ControlChannel.h 中 HoistCommandType 的顺序一致
+inline const char* commandName(uint8_t type) {
+    static const char* const names[] = { "go_floor", "emergency_stop", "demo_start", "demo_inject", "set_recording", "run_benchmark" };
+    return type < sizeof(names) / sizeof(names[0]) ? names[type] : "?";
+}
+#define REPORT_CMD_GO_FLOOR 0
+#define REPORT_CMD_EMERGENCY_STOP 1
+
+inline const char* floorName(uint8_t floor) {
+    return floor < FLOOR_COUNT ? FLOOR_TABLE[floor].name : "-";
+}
+
+struct LatencyStats {
+    unsigned long count = 0;
+    long minMs = 0, maxMs = 0;
+    double sumMs = 0;
+
+    void add(long ms) {
+        if (count == 0 || ms < minMs) minMs = ms;
+        if (count == 0 || ms > maxMs) maxMs = ms;
+        sumMs += ms;
+        count++;
+    }
+
+    void print(const char* name) const {
+        if (count == 0) {
+            printf("  %-22s -\n", name);
+        } else {
+            printf("  %-22s n=%-4lu min=%ld ms avg=%.1f ms max=%ld ms\n", name, count, minMs, sumMs / count, maxMs);
+        }
+    }
+};
+
+struct StateRecord {
+    uint32_t ts;
+    TelemetryState st;
+};
+
+class CaptureReport {
+private:
+    // 等待响应的输入
+    bool _floorCmdPending = false;
+    uint32_t _floorCmdMs = 0;
+    bool _stopCmdPending = false;
+    uint32_t _stopCmdMs = 0;
+    bool _limitEdgePending = false;
+    uint32_t _limitEdgeMs = 0;
+
+    // 当前行程
+    bool _inTrip = false;
+    uint32_t _tripStartMs = 0;
+    long _tripStartPos = 0;
+
+    void input(uint32_t ts, const TelemetryInput& in) {
+        inputs++;
+        if (in.kind == INPUT_COMMAND && in.a == REPORT_CMD_GO_FLOOR && !_floorCmdPending) {
+            _floorCmdPending = true;
+            _floorCmdMs = ts;
+        } else if (in.kind == INPUT_COMMAND && in.a == REPORT_CMD_EMERGENCY_STOP) {
+            _stopCmdPending = true;
+            _stopCmdMs = ts;
+        } else if (in.kind == INPUT_TOP_LIMIT && in.a) {
+            _limitEdgePending = true;
+            _limitEdgeMs = ts;
+        }
+        // 传感器样本和电流每秒几十帧，只打印指令和到顶边沿
+        if (verbose && (in.kind == INPUT_COMMAND || in.kind == INPUT_TOP_LIMIT)) {
+            printf("%10.3f INPUT %-14s a=%u arg=%d value=%ld\n", ts / 1000.0,
+                   in.kind == INPUT_COMMAND ? commandName(in.a) : telemetryInputName(in.kind),
+                   in.a, in.arg, (long)in.value);
+        }
+    }
+
+    void state(uint32_t ts, const TelemetryState& st) {
+        states.push_back({ ts, st });
+        std::string key = std::string(telemetryStateName(st.from)) + " -> " + telemetryStateName(st.to) +
+                          " (" + telemetryReasonName(st.reason) + ")";
+        transitions[key]++;
+
+        // 从静止 (IDLE / ERROR / UNKNOWN) 进入运行状态 (CALIB / UP / DOWN) 即一段行程开始
+        bool fromMoving = st.from == STATE_CALIBRATING || st.from == STATE_MOVING_UP || st.from == STATE_MOVING_DOWN;
+        bool toMoving = st.to == STATE_CALIBRATING || st.to == STATE_MOVING_UP || st.to == STATE_MOVING_DOWN;
+        if (!fromMoving && toMoving) {
+            if (_floorCmdPending) startLatency.add((long)(ts - _floorCmdMs));
+            _floorCmdPending = false;
+            _inTrip = true;
+            _tripStartMs = ts;
+            _tripStartPos = st.positionMs;
+        }
+        if (st.to == STATE_ERROR && st.reason == REASON_EMERGENCY_STOP && _stopCmdPending) {
+            stopLatency.add((long)(ts - _stopCmdMs));
+            _stopCmdPending = false;
+        }
+        if ((st.reason == REASON_HOMED || st.reason == REASON_LIMIT_HIT) && _limitEdgePending) {
+            limitLatency.add((long)(ts - _limitEdgeMs));
+            _limitEdgePending = false;
+        }
+
+        if (_inTrip && st.to == STATE_IDLE) {
+            trips++;
+            long dev = 0;
+            bool hasTarget = st.floor < FLOOR_COUNT && st.reason != REASON_HOMED;
+            if (hasTarget) {
+                // 沿运行方向为正：下行停在目标下方、上行停在目标上方都是过冲
+                dev = st.positionMs - (long)FLOOR_TABLE[st.floor].positionMs;
+                if (st.positionMs < _tripStartPos) dev = -dev;
+                overshoot.add(dev);
+            }
+            if (verbose) {
+                printf("%10.3f TRIP  %-6s from %ld ms, %.3f s, stop deviation %s%ld ms (%s)\n", ts / 1000.0,
+                       floorName(st.floor), _tripStartPos, (ts - _tripStartMs) / 1000.0,
+                       hasTarget ? "" : "n/a ", dev, telemetryReasonName(st.reason));
+            }
+            _inTrip = false;
+        } else if (st.to == STATE_ERROR) {
+            if (_inTrip && verbose) printf("%10.3f TRIP  aborted: %s\n", ts / 1000.0, telemetryReasonName(st.reason));
+            _inTrip = false;
+            _floorCmdPending = false;
+        }
+    }
+
+public:
+    bool verbose = true;          // 逐条打印输入和行程
+
+    LatencyStats startLatency;    // 楼层指令 -> 开始运行
+    LatencyStats stopLatency;     // 急停指令 -> ERROR
+    LatencyStats limitLatency;    // 到顶判断 -> 停机 (归零完成或撞顶故障)
+    LatencyStats overshoot;       // 停点 - 目标楼层 (沿运行方向为正)
+    std::map<std::string, unsigned long> transitions;
+    std::vector<StateRecord> states;
+    unsigned long trips = 0, inputs = 0;
+
+    void frame(uint8_t type, uint32_t ts, const uint8_t* payload, uint8_t len) {
+        if (type == TLM_INPUT && len >= sizeof(TelemetryInput)) {
+            TelemetryInput in;
+            memcpy(&in, payload, sizeof(in));
+            input(ts, in);
+        } else if (type == TLM_STATE && len >= sizeof(TelemetryState)) {
+            TelemetryState st;
+            memcpy(&st, payload, sizeof(st));
+            state(ts, st);
+        }
+    }
+
+    void print(const char* title) const {
+        printf("\n=== %s: %lu inputs, %lu trips ===\n", title, inputs, trips);
+        startLatency.print("command -> start");
+        stopLatency.print("e-stop -> ERROR");
+        limitLatency.print("top limit -> stop");
+        overshoot.print("stop deviation");
+        printf("  transitions:\n");
+        for (const auto& t : transitions) printf("    %-40s %lu\n", t.first.c_str(), t.second);
+    }
+};
+
+#endif
@@ -0,0 +1,99 @@
+/*
+ * 位置检查点 (PositionCheckpoint.h) 的主机测试
+ * 用 sim/ 的文件模拟 Preferences，“重启”时换一个新对象从文件恢复，检查：
+ *   - update() (控制任务) 从不写 Flash，静止到期后由 service() (网络任务) 写 pos 和 clean
+ *   - 离开静止后 service() 把 clean 清 0，重启不再相信旧位置
+ *   - 上一份记录还没写时又停在新位置：新记录等上一份写完再交接，最后落盘的是新位置
+ * 失败时退出码为 1。
+ *
+ * 编译：make -C sim          (生成 sim/build/checkpoint_test)
+ * 用法：checkpoint_test
+ */
+
+#include <cstdio>
+#include <unistd.h>
+#include "../PositionCheckpoint.h"
+
+static const char* NVS_FILE = "/tmp/checkpoint_test.nvs";
+static int s_failures = 0;
+
+static void check(bool ok, const char* scenario, const char* what) {
+    printf("  %-4s %-14s %s\n", ok ? "ok" : "FAIL", scenario, what);
+    if (!ok) s_failures++;
+}
+
+static void freshFlash() {
+    unlink(NVS_FILE);
+    simNvsOpen(NVS_FILE);
+}
+
+// 控制任务静止 ms 毫秒，每个周期调用一次 update()
+static void idleFor(PositionCheckpoint& cp, unsigned long ms, long positionMs) {
+    for (unsigned long t = 0; t < ms; t++) {
+        cp.update(true, positionMs, 1000);
+        simAdvanceUs(1000);
+    }
+}
+
+// 重启后读回的位置，-1 表示不可信
+static long rebootAndRestore() {
+    simNvsOpen(NVS_FILE);
+    PositionCheckpoint cp;
+    cp.begin();
+    long positionMs = -1, travelMs = 0;
+    return cp.restore(positionMs, travelMs) ? positionMs : -1;
+}
+
+static void scenarioIdle() {
+    freshFlash();
+    PositionCheckpoint cp;
+    cp.begin();
+    uint32_t writes = simNvsWriteCount();
+    idleFor(cp, CHECKPOINT_IDLE_MS + 10, 70000);
+    check(simNvsWriteCount() == writes, "idle", "update() never writes flash");
+    cp.service();
+    check(simNvsWriteCount() - writes == 2, "idle", "service() writes pos, then clean");
+    cp.service();
+    idleFor(cp, 100, 70000);
+    cp.service();
+    check(simNvsWriteCount() - writes == 2, "idle", "nothing more while the position is unchanged");
+    check(rebootAndRestore() == 70000, "idle", "position restored after a reboot");
+}
+
+static void scenarioLeaveIdle() {
+    freshFlash();
+    PositionCheckpoint cp;
+    cp.begin();
+    idleFor(cp, CHECKPOINT_IDLE_MS + 10, 70000);
+    cp.service();
+    uint32_t writes = simNvsWriteCount();
+    cp.update(false, 70500, 1500);
+    check(simNvsWriteCount() == writes, "leave idle", "update() does not clear clean itself");
+    cp.service();
+    check(simNvsWriteCount() - writes == 1, "leave idle", "service() clears clean");
+    check(rebootAndRestore() == -1, "leave idle", "no warm start after leaving idle");
+}
+
+static void scenarioHandoff() {
+    freshFlash();
+    PositionCheckpoint cp;
+    cp.begin();
+    idleFor(cp, CHECKPOINT_IDLE_MS + 10, 70000); // 记录 A 已交出，网络任务还没写
+    cp.update(false, 80000, 11000);
+    idleFor(cp, CHECKPOINT_IDLE_MS + 10, 150000); // 停在 B：A 还在等，B 暂不交接
+    cp.service();                                 // 写 A，clean 保持请求
+    idleFor(cp, 10, 150000);                      // 现在交出 B
+    cp.service();
+    check(rebootAndRestore() == 150000, "handoff", "the later position wins");
+}
+
+int main() {
+    simSerialQuiet(true);
+    printf("checkpoint: idle %lu ms before writing\n", (unsigned long)CHECKPOINT_IDLE_MS);
+    scenarioIdle();
+    scenarioLeaveIdle();
+    scenarioHandoff();
+    unlink(NVS_FILE);
+    printf("%s (%d failed)\n", s_failures ? "FAIL" : "PASS", s_failures);
+    return s_failures ? 1 : 0;
+}
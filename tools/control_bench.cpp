@@ -0,0 +1,77 @@
+/*
+ * 控制路径基准的主机版
+ * 在仿真硬件 + 虚拟时钟上跑几段行程攒出运行历史，然后在 IDLE 时调用固件同一个 ControlBenchmark::run()，
+ * 输出与串口 'B' 相同的表。计时用主机 CPU 的周期计数 (与 profile_bench 一样)，数值是主机上的周期数，
+ * 用来比较改动前后的相对变化；预算是按 240MHz 的 ESP32 定的，主机上的 PASS / FAIL 只作参考。
+ *
+ * 另外检查基准本身的约束：运行中必须拒绝执行，执行前后状态机的状态、位置、队列不变。
+ *
+ * 编译：make -C sim          (生成 sim/build/control_bench)
+ * 用法：control_bench [--trips N] [--strict]
+ *   --strict  有任何一项超出预算时退出码为 1
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "../sim/SimRig.h"
+#include "../ControlBenchmark.h"
+
+TelemetryLog telemetry;
+
+static SimRig rig;
+static ControlBenchmark benchmark;
+
+int main(int argc, char** argv) {
+#if !ENABLE_CONTROL_BENCHMARK
+    printf("ENABLE_CONTROL_BENCHMARK = 0, nothing to measure\n");
+    return 0;
+#endif
+    int trips = 6;
+    bool strict = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--trips") && i + 1 < argc) trips = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--strict")) strict = true;
+        else {
+            fprintf(stderr, "usage: %s [--trips N] [--strict]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    simSerialQuiet(true);
+    rig.begin(simDefaultParams());
+    bool ok = rig.runUntilSettled(MAX_SAFE_POSITION_MS * 2) >= 0;
+    // 底 -> 顶 才记一次全程运行，来回跑攒历史
+    for (int i = 0; ok && i < trips; i++) {
+        rig.goFloor(i % 2 ? FLOOR_TOP : FLOOR_BOTTOM);
+        ok = rig.runUntilSettled(MAX_SAFE_POSITION_MS * 2) >= 0 && rig.hoist.getState() == STATE_IDLE;
+    }
+    if (!ok) {
+        fprintf(stderr, "trip failed (state %s)\n", rig.hoist.getStateName());
+        return 1;
+    }
+
+    // 运行中：必须拒绝，不能停掉控制周期
+    rig.goFloor(FLOOR_BOTTOM);
+    for (int i = 0; i < 100; i++) rig.cycle();
+    bool refused = !benchmark.run(rig.hoist, rig.maintenance) && rig.hoist.getState() == STATE_MOVING_DOWN;
+    rig.runUntilSettled(MAX_SAFE_POSITION_MS * 2);
+
+    // 静止时执行，前后状态机不能有任何变化
+    SystemState state = rig.hoist.getState();
+    long position = rig.hoist.getCurrentPosition();
+    uint8_t pending = rig.hoist.getPendingStops();
+    printf("%d trips, %lu full runs in history, host %lu MHz\n", trips,
+           (unsigned long)rig.maintenance.getRunCount(WINDOW_ALL), (unsigned long)simCpuMhz());
+    fflush(stdout);
+    simSerialQuiet(false);
+    bool pass = benchmark.run(rig.hoist, rig.maintenance);
+    simSerialQuiet(true);
+    bool unchanged = rig.hoist.getState() == state && rig.hoist.getCurrentPosition() == position &&
+                     rig.hoist.getPendingStops() == pending;
+
+    printf("refused while moving: %s\n", refused ? "ok" : "FAIL");
+    printf("hoist unchanged by the benchmark: %s\n", unchanged ? "ok" : "FAIL");
+    if (!refused || !unchanged) return 1;
+    return strict && !pass ? 1 : 0;
+}
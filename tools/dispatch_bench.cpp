@@ -0,0 +1,66 @@
+/*
+ * 状态分派基准：转移表 (成员函数指针) vs switch (HoistStateMachine::update() 用的写法)
+ * 用 ControlBenchmark.h 里的 DispatchModel，逐个状态各调用 N 次，主机 CPU 周期计数 (与 profile_bench 一样)
+ * 取每次调用的平均值；两种写法跑同样的序列，最后检查结果一致 (处理函数确实都被调用了)。
+ * 数值是主机上的周期数，ESP32 上的对照见串口 'B' 的 “dispatch table / switch x6” 两行。
+ *
+ * 编译：make -C sim          (生成 sim/build/dispatch_bench)
+ * 用法：dispatch_bench [--iterations N]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "../ControlBenchmark.h"
+
+TelemetryLog telemetry;
+
+#if ENABLE_CONTROL_BENCHMARK
+
+static DispatchModel s_table, s_switch;
+static volatile uint8_t s_state; // 运行时才知道的状态，与 update() 读 _currentState 一样
+
+// 每次调用的平均周期数 (含循环本身)
+template <typename F>
+static double cyclesPerCall(long iterations, F fn) {
+    uint32_t start = simCycleCount();
+    for (long i = 0; i < iterations; i++) fn((unsigned long)i);
+    return (double)(uint32_t)(simCycleCount() - start) / iterations;
+}
+
+#endif
+
+int main(int argc, char** argv) {
+#if !ENABLE_CONTROL_BENCHMARK
+    printf("ENABLE_CONTROL_BENCHMARK = 0, nothing to measure\n");
+    return 0;
+#else
+    long iterations = 1000000;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--iterations") && i + 1 < argc) iterations = atol(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--iterations N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (iterations <= 0) return 2;
+
+    printf("dispatch: %ld calls per state, host %lu MHz, cycles per call\n", iterations,
+           (unsigned long)simCpuMhz());
+    printf("  %-12s %8s %8s\n", "state", "table", "switch");
+    double tableTotal = 0, switchTotal = 0;
+    for (int s = 0; s < STATE_COUNT; s++) {
+        s_state = (uint8_t)s;
+        double t = cyclesPerCall(iterations, [](unsigned long now) { s_table.tickTable((SystemState)s_state, now); });
+        double w = cyclesPerCall(iterations, [](unsigned long now) { s_switch.tickSwitch((SystemState)s_state, now); });
+        printf("  %-12s %8.2f %8.2f\n", telemetryStateName(s), t, w);
+        tableTotal += t;
+        switchTotal += w;
+    }
+    printf("  %-12s %8.2f %8.2f\n", "mean", tableTotal / STATE_COUNT, switchTotal / STATE_COUNT);
+
+    bool same = s_table.sameAs(s_switch);
+    printf("same result: %s\n", same ? "ok" : "FAIL");
+    return same ? 0 : 1;
+#endif
+}
@@ -0,0 +1,205 @@
+/*
+ * 超声波回波回放测试 (主机端)
+ * 把 Echo 引脚的边沿时间按顺序回放进固件的 EchoCapture + UltrasonicFilter (与 hardware_controller.cpp
+ * 的中断 / 触发定时器同样的调用顺序)，检查每个测量周期的分类、滤波距离、健康状态和到顶判断。
+ *
+ * 不给文件时运行内置场景并断言结果 (失败时退出码为 1)：
+ *   - 匀速接近顶部：进入限位后几个周期内判到顶，之前不误判
+ *   - 停在顶部时夹一个远处的尖峰回波：滤波距离不动，到顶判断最多断开尖峰那一个周期
+ *   - 远处时夹一个近处的尖峰回波：不误判到顶
+ *   - 拔掉传感器 (触发后没有任何边沿)：判为 SENSOR_DEAD，不判到顶
+ *   - 前方没有物体 (脉宽超量程 / 一直为高)：判为 SENSOR_FAR
+ * 给文件时逐周期打印回放结果。文件每行一个事件 (逻辑分析仪导出后整理)：
+ *   <时间 us> T     触发脉冲 (一个测量周期的开始)
+ *   <时间 us> R     Echo 上升沿
+ *   <时间 us> F     Echo 下降沿
+ *
+ * 编译：make -C sim          (生成 sim/build/echo_replay_test)
+ * 用法：echo_replay_test [边沿文件]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../UltrasonicFilter.h"
+
+struct EdgeEvent {
+    int64_t us;
+    char kind; // 'T' / 'R' / 'F'
+};
+
+struct CycleResult {
+    EchoKind kind;
+    UltrasonicState state;
+    bool atTop;
+};
+
+// 与 triggerUltrasonic() / onEchoEdge() 相同的顺序：触发时先结算上一周期，再开始新周期
+static std::vector<CycleResult> replay(const std::vector<EdgeEvent>& events) {
+    EchoCapture capture;
+    UltrasonicFilter filter;
+    std::vector<CycleResult> out;
+    bool triggered = false;
+    for (const EdgeEvent& e : events) {
+        if (e.kind == 'R' || e.kind == 'F') {
+            capture.onEdge(e.kind == 'R', e.us);
+            continue;
+        }
+        uint32_t width;
+        EchoKind kind = capture.finishCycle(width);
+        if (triggered) {
+            filter.push(kind, width, (unsigned long)(e.us / 1000));
+            out.push_back({ kind, filter.state(), UltrasonicFilter::isAtTop(filter.state()) });
+        }
+        triggered = true;
+    }
+    return out;
+}
+
+// --- 场景生成：每个周期一个触发，回波按距离算脉宽 ---
+
+static uint32_t mmToEchoUs(double mm) { return (uint32_t)(mm * 2000 / 343); }
+
+struct TraceBuilder {
+    std::vector<EdgeEvent> events;
+    int64_t t = 0;
+
+    // 一个周期：触发后 echoDelay 出现上升沿，宽度 widthUs；widthUs 为 0 表示没有回波，
+    // 为负表示只有上升沿 (一直为高直到下个周期)
+    void cycle(int64_t widthUs, int64_t echoDelayUs = 450) {
+        events.push_back({ t, 'T' });
+        if (widthUs != 0) {
+            events.push_back({ t + echoDelayUs, 'R' });
+            if (widthUs > 0) events.push_back({ t + echoDelayUs + widthUs, 'F' });
+        }
+        t += ULTRASONIC_PERIOD_US;
+    }
+
+    void distance(double mm) { cycle(mmToEchoUs(mm)); }
+
+    void finish() { events.push_back({ t, 'T' }); } // 结算最后一个周期
+};
+
+static int s_failures = 0;
+
+static void check(bool ok, const char* scenario, const char* what) {
+    printf("  %-4s %-24s %s\n", ok ? "ok" : "FAIL", scenario, what);
+    if (!ok) s_failures++;
+}
+
+static int firstTop(const std::vector<CycleResult>& r, size_t from = 0) {
+    for (size_t i = from; i < r.size(); i++) {
+        if (r[i].atTop) return (int)i;
+    }
+    return -1;
+}
+
+static void scenarioApproach() {
+    // 以 300 mm/s 从 900mm 接近到 400mm，之后停住；限位为 SENSOR_DISTANCE_LIMIT
+    TraceBuilder b;
+    double limitMm = SENSOR_DISTANCE_LIMIT * 10;
+    double mm = 900;
+    int crossCycle = -1;
+    for (int i = 0; i < 60; i++) {
+        if (crossCycle < 0 && mm <= limitMm) crossCycle = i;
+        b.distance(mm);
+        if (mm > 400) mm -= 300.0 * ULTRASONIC_PERIOD_US / 1e6;
+    }
+    b.finish();
+    std::vector<CycleResult> r = replay(b.events);
+    int top = firstTop(r);
+    check(top >= crossCycle, "approach", "no top before crossing the limit");
+    check(top >= 0 && top - crossCycle <= 3, "approach", "top within 3 cycles of crossing");
+    check(r.back().state.health == SENSOR_OK && r.back().atTop, "approach", "holds top while parked");
+}
+
+static void scenarioSpikeAtTop() {
+    TraceBuilder b;
+    for (int i = 0; i < 10; i++) b.distance(420);
+    b.distance(950); // 单个远处尖峰 (多径反射)
+    for (int i = 0; i < 10; i++) b.distance(420);
+    b.finish();
+    std::vector<CycleResult> r = replay(b.events);
+    // 尖峰那一周期记为离群 (NOISY)，但中值距离不动，下一周期恢复到顶
+    int top = firstTop(r);
+    bool held = top >= 0;
+    int gaps = 0;
+    for (size_t i = top >= 0 ? top : r.size(); i < r.size(); i++) {
+        held = held && r[i].state.distanceMm <= (int32_t)(SENSOR_DISTANCE_LIMIT * 10);
+        if (!r[i].atTop) gaps++;
+    }
+    check(held, "spike at top", "filtered distance stays inside the limit");
+    check(top >= 0 && gaps <= 1 && r.back().atTop, "spike at top", "top drops for at most the spike cycle");
+}
+
+static void scenarioSpikeFar() {
+    TraceBuilder b;
+    for (int i = 0; i < 10; i++) b.distance(900);
+    b.distance(300); // 单个近处尖峰
+    for (int i = 0; i < 10; i++) b.distance(900);
+    b.finish();
+    check(firstTop(replay(b.events)) < 0, "spike far", "single near spike does not trip top");
+}
+
+static void scenarioUnplugged() {
+    TraceBuilder b;
+    for (int i = 0; i < 10; i++) b.distance(420);
+    for (int i = 0; i < ULTRASONIC_DEAD_CYCLES + 2; i++) b.cycle(0);
+    b.finish();
+    std::vector<CycleResult> r = replay(b.events);
+    check(r.back().kind == ECHO_NONE, "unplugged", "no edges classified as ECHO_NONE");
+    check(r.back().state.health == SENSOR_DEAD && !r.back().atTop, "unplugged", "SENSOR_DEAD, top released");
+}
+
+static void scenarioFar() {
+    TraceBuilder b;
+    for (int i = 0; i < 5; i++) b.distance(900);
+    for (int i = 0; i < 3; i++) b.cycle(ULTRASONIC_ECHO_TIMEOUT_US + 2000); // 超量程脉宽
+    for (int i = 0; i < 3; i++) b.cycle(-1);                                // 一直为高
+    b.finish();
+    std::vector<CycleResult> r = replay(b.events);
+    check(r[6].kind == ECHO_OUT_OF_RANGE && r.back().kind == ECHO_OUT_OF_RANGE, "far",
+          "long / unfinished pulse is out of range");
+    check(r.back().state.health == SENSOR_FAR && !r.back().atTop, "far", "SENSOR_FAR, no top");
+}
+
+static const char* healthName(SensorHealth h) {
+    static const char* const names[] = { "ok", "far", "noisy", "dead" };
+    return names[h];
+}
+
+static int replayFile(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return 2;
+    }
+    std::vector<EdgeEvent> events;
+    long long us;
+    char kind;
+    while (fscanf(f, "%lld %c", &us, &kind) == 2) events.push_back({ us, kind });
+    fclose(f);
+
+    std::vector<CycleResult> r = replay(events);
+    printf("cycle  kind  echo_us  dist_mm  vel_mm_s  conf  health  top\n");
+    for (size_t i = 0; i < r.size(); i++) {
+        const UltrasonicState& s = r[i].state;
+        printf("%5zu  %4d  %7lu  %7ld  %8ld  %4u  %-6s  %s\n", i, r[i].kind, (unsigned long)s.echoUs,
+               (long)s.distanceMm, (long)s.velocityMmS, s.confidence, healthName(s.health),
+               r[i].atTop ? "TOP" : "-");
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) return replayFile(argv[1]);
+
+    printf("echo replay: period %lu us, limit %.0f mm\n", ULTRASONIC_PERIOD_US, SENSOR_DISTANCE_LIMIT * 10);
+    scenarioApproach();
+    scenarioSpikeAtTop();
+    scenarioSpikeFar();
+    scenarioUnplugged();
+    scenarioFar();
+    printf("%s (%d failed)\n", s_failures ? "FAIL" : "PASS", s_failures);
+    return s_failures ? 1 : 0;
+}
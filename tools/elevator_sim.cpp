@@ -0,0 +1,311 @@
+/*
+ * 升降机主机仿真
+ * 在虚拟时钟上运行真实的状态机、维护管理器和调度器，电机/绳索/超声波由 hardware_sim.cpp 的模型代替。
+ * 每天按固定日历自动运行 (调度器的 NTP 日历跟着虚拟墙上时间走)，行程之间的空闲时间快进，
+ * 一天的定时运行在一秒之内跑完，可以在 CI 里扫负载、噪声、电机参数。
+ *
+ * 报告：行程数、故障数 (按原因)、每层停点误差 (模型真实位置与楼层位置之差，以最近一次归零的停点为 0；
+ *       顶层是相邻两次归零停点之差)、
+ *       全程耗时的均值与老化斜率。有故障时退出码为 1。
+ *
+ * 编译：make -C sim          (生成 sim/build/elevator_sim)
+ * 用法：elevator_sim [--days N] [--load KG] [--noise CM] [--speed CM_S] [--deadband PWM] [--seed S]
+ *                    [--nvs 文件] [--telemetry 文件 [--record]] [--verbose]
+ *       elevator_sim --sweep [--days N]       负载 × 噪声 参数表，每组一个子进程
+ *       elevator_sim --faults [--load KG] [--noise CM]
+ *                                             运行中注入打滑 / 卡死，报告停机原因和从注入到停机的时间
+ *   --nvs 把 NVS 落到文件，下一次运行从同一个文件“上电” (可以连续跑很多天)
+ *   --telemetry 把二进制遥测写到文件，用 tools/telemetry_decode 解码
+ *   --record 同时录制状态机输入 (InputRecorder.h)，文件可以交给 tools/replay_runner 回放核对；
+ *            --faults 也可以录制
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../sim/SimRig.h"
+#include "../SchedulerManager.h"
+
+TelemetryLog telemetry;
+
+static SimRig rig;
+static SchedulerManager scheduler;
+static float s_zeroCm = 0;       // 最近一次归零停下的真实位置：位置 0 就是这里
+static bool s_zeroFromBoot = true; // 上电时已在顶部，停点比正常归零高，不算进顶层的误差
+
+struct SimOptions {
+    int days = 1;
+    SimParams params = simDefaultParams();
+    uint32_t seed = 1;
+    const char* nvsPath = nullptr;
+    const char* telemetryPath = nullptr;
+    bool record = false;
+    bool verbose = false;
+};
+
+// 故障注入：从 from 层出发去 to 层，位置越过 atMs 时注入
+struct FaultScenario {
+    const char* name;
+    bool jam;                 // true = 卡死 (堵转电流)，false = 打滑 (电流正常，吊篮不动)
+    uint8_t from, to;
+    long atMs;
+    bool detectable;          // 量程外的下降打滑本段没有任何实测可比，下一次上升进量程时才发现 (tools/fault_test)
+};
+
+struct FloorError {
+    int stops = 0;
+    double sumCm = 0;
+    double maxCm = 0;
+};
+
+struct SimReport {
+    int trips = 0;
+    int faults[REASON_COUNT] = {};
+    FloorError floors[FLOOR_COUNT];
+    long longestTripMs = 0;
+};
+
+// 每天的日历 (本地时间)：与 V10-V12 写进去的定时一样，只是多用了几个槽位
+static void installCalendar() {
+    static const struct {
+        int hour, minute;
+        ScheduleAction action;
+    } calendar[MAX_SCHEDULE_ENTRIES] = {
+        { 6, 0, SCHED_DOWN },   { 7, 0, SCHED_UP },    { 9, 30, SCHED_MIDDLE }, { 11, 0, SCHED_UP },
+        { 13, 0, SCHED_DOWN },  { 15, 0, SCHED_MIDDLE }, { 17, 0, SCHED_DOWN }, { 18, 0, SCHED_UP },
+    };
+    for (int i = 0; i < MAX_SCHEDULE_ENTRIES; i++) {
+        scheduler.setEntry(i, calendar[i].hour * 3600L + calendar[i].minute * 60, WEEKDAYS_ALL,
+                           calendar[i].action);
+    }
+}
+
+// 网络任务里调度器的那一段 (SmartElevator.ino networkLoop)
+static bool serviceScheduler() {
+    int action = scheduler.checkTrigger();
+    if (action == SCHED_NONE || rig.hoist.getState() != STATE_IDLE) return false;
+    if (action == SCHED_UP) {
+        if (isTopLimitPressed()) return false;
+        rig.goFloor(FLOOR_TOP);
+    } else {
+        rig.goFloor(action == SCHED_DOWN ? FLOOR_BOTTOM : FLOOR_MIDDLE);
+    }
+    return true;
+}
+
+// 一段行程结束：记录停点误差或故障原因
+static void finishTrip(SimReport& report, long tripMs) {
+    report.trips++;
+    if (tripMs > report.longestTripMs) report.longestTripMs = tripMs;
+    if (rig.hoist.getState() == STATE_ERROR) {
+        report.faults[rig.hoist.getLastReason()]++;
+        rig.goFloor(FLOOR_TOP); // 人工恢复：重新归零
+        return;
+    }
+    uint8_t floor = rig.hoist.getTargetFloor();
+    if (floor >= FLOOR_COUNT) return;
+    // 顶层靠传感器停：误差是相邻两次归零停点之差 (重复性)，之后的楼层都以这里为 0
+    double err = fabs(simGetPositionCm() - s_zeroCm - simFloorCm(floor));
+    if (floor == FLOOR_TOP) {
+        s_zeroCm = simGetPositionCm();
+        if (s_zeroFromBoot) {
+            s_zeroFromBoot = false;
+            return;
+        }
+    }
+    FloorError& f = report.floors[floor];
+    f.stops++;
+    f.sumCm += err;
+    if (err > f.maxCm) f.maxCm = err;
+}
+
+static int runOnce(const SimOptions& opt, bool tableRow) {
+    simRandomSeed(opt.seed);
+    simSerialQuiet(!opt.verbose);
+    FILE* capture = opt.telemetryPath ? fopen(opt.telemetryPath, "wb") : nullptr;
+    simSerialCapture(capture);
+    if (opt.nvsPath) simNvsOpen(opt.nvsPath);
+    // 虚拟时间 0 = 本地 (UTC+8) 2026-01-01 00:00
+    simSetWallClock(1767225600 - 8 * 3600);
+
+    scheduler.begin();
+    installCalendar();
+    rig.inputs.setEnabled(opt.record);
+    rig.begin(opt.params);
+
+    SimReport report;
+    long boot = rig.runUntilSettled(MAX_SAFE_POSITION_MS * 2);
+    if (boot < 0 || rig.hoist.getState() != STATE_IDLE) {
+        fprintf(stderr, "boot calibration failed (state %s)\n", rig.hoist.getStateName());
+        return 1;
+    }
+    s_zeroCm = simGetPositionCm();
+
+    unsigned long endMs = (unsigned long)opt.days * 86400UL * 1000UL;
+    while (millis() < endMs) {
+        if (serviceScheduler()) {
+            finishTrip(report, rig.runUntilSettled(MAX_SAFE_POSITION_MS * 2));
+            if (!rig.settled()) finishTrip(report, rig.runUntilSettled(MAX_SAFE_POSITION_MS * 2));
+        } else {
+            rig.idleFor(1000);
+        }
+    }
+    if (capture) fclose(capture);
+
+    int faults = 0;
+    for (int r = 0; r < REASON_COUNT; r++) faults += report.faults[r];
+    double meanMs = rig.maintenance.getMeanDuration(WINDOW_ALL).toFloat();
+    double slope = rig.maintenance.calculateSlope(WINDOW_ALL).toFloat();
+
+    if (tableRow) {
+        double worst = 0;
+        for (int f = 0; f < FLOOR_COUNT; f++) worst = std::max(worst, report.floors[f].maxCm);
+        printf("%6.1f %6.1f %6d %7d %9.2f %10.0f %9.2f\n", opt.params.loadKg, opt.params.sensorNoiseCm,
+               report.trips, faults, worst, meanMs, slope);
+        return faults ? 1 : 0;
+    }
+
+    printf("simulated %d day(s): load %.1f kg, noise ±%.1f cm, %.1f cm/s @255, deadband %d\n", opt.days,
+           opt.params.loadKg, opt.params.sensorNoiseCm, opt.params.fullSpeedCmS, opt.params.pwmDeadband);
+    printf("trips %d, longest %.1f s, faults %d\n", report.trips, report.longestTripMs / 1000.0, faults);
+    for (int r = 0; r < REASON_COUNT; r++) {
+        if (report.faults[r]) printf("  fault %-16s %d\n", telemetryReasonName(r), report.faults[r]);
+    }
+    printf("stop error (cm)      stops     mean      max\n");
+    for (int f = 0; f < FLOOR_COUNT; f++) {
+        const FloorError& e = report.floors[f];
+        if (e.stops == 0) continue;
+        printf("  %-16s %8d %8.2f %8.2f\n", floorSpec(f).name, e.stops, e.sumCm / e.stops, e.maxCm);
+    }
+    printf("full runs %lu, mean %.0f ms, slope %.3f ms/run, NVS writes %lu\n",
+           (unsigned long)rig.maintenance.getRunCount(WINDOW_ALL), meanMs, slope,
+           (unsigned long)simNvsWriteCount());
+    return faults ? 1 : 0;
+}
+
+// 只等 ERROR (或行程正常结束)：返回从注入到停机的时间，-1 表示没有停机
+static long runUntilFault(unsigned long timeoutMs) {
+    unsigned long start = millis();
+    do {
+        rig.cycle();
+        if (rig.hoist.getState() == STATE_ERROR) return (long)(millis() - start);
+    } while (!rig.settled() && millis() - start < timeoutMs);
+    return -1;
+}
+
+static int runFaults(const SimOptions& opt) {
+    static const FaultScenario scenarios[] = {
+        { "slip down, in range",   false, FLOOR_TOP,    FLOOR_MIDDLE, 8000,   true },
+        { "slip up, in range",     false, FLOOR_MIDDLE, FLOOR_TOP,    15000,  true },
+        { "slip homing, at top",   false, FLOOR_MIDDLE, FLOOR_TOP,    3000,   true },
+        { "slip up, far",          false, FLOOR_BOTTOM, FLOOR_TOP,    100000, true },
+        { "slip down, far",        false, FLOOR_TOP,    FLOOR_BOTTOM, 60000,  false },
+        { "jam down, far",         true,  FLOOR_TOP,    FLOOR_BOTTOM, 60000,  true },
+    };
+
+    simRandomSeed(opt.seed);
+    simSerialQuiet(!opt.verbose);
+    FILE* capture = opt.telemetryPath ? fopen(opt.telemetryPath, "wb") : nullptr;
+    simSerialCapture(capture);
+    simSetWallClock(1767225600 - 8 * 3600);
+    rig.inputs.setEnabled(opt.record);
+    rig.begin(opt.params);
+    if (rig.runUntilSettled(MAX_SAFE_POSITION_MS * 2) < 0 || rig.hoist.getState() != STATE_IDLE) {
+        fprintf(stderr, "boot calibration failed (state %s)\n", rig.hoist.getStateName());
+        return 1;
+    }
+    // 先从已知位置归零一次，学到超声波读数和位置的换算
+    rig.goFloor(FLOOR_MIDDLE);
+    rig.runUntilSettled(MAX_SAFE_POSITION_MS * 2);
+    rig.goFloor(FLOOR_TOP);
+    rig.runUntilSettled(MAX_SAFE_POSITION_MS * 2);
+
+    printf("load %.1f kg, noise ±%.1f cm\n", opt.params.loadKg, opt.params.sensorNoiseCm);
+    printf("  %-22s %-14s %10s\n", "scenario", "reason", "latency_s");
+    int missed = 0;
+    for (const FaultScenario& s : scenarios) {
+        rig.goFloor(s.from);
+        rig.runUntilSettled(MAX_SAFE_POSITION_MS * 2);
+        rig.goFloor(s.to);
+
+        // 走到注入点
+        int direction = floorPositionMs(s.to) > floorPositionMs(s.from) ? 1 : -1;
+        while (!rig.settled() && (rig.hoist.getCurrentPosition() - s.atMs) * direction < 0) rig.cycle();
+        if (s.jam) setMockJam(true);
+        else setMockSlip(true);
+
+        long latency = runUntilFault(MAX_SAFE_POSITION_MS * 2);
+        bool stopped = latency >= 0;
+        if (!stopped && s.detectable) missed++;
+        printf("  %-22s %-14s %10.1f\n", s.name,
+               stopped ? telemetryReasonName(rig.hoist.getLastReason()) : (s.detectable ? "MISSED" : "undetected"),
+               stopped ? latency / 1000.0 : -1.0);
+
+        setMockJam(false);
+        setMockSlip(false);
+        rig.goFloor(FLOOR_TOP); // 人工恢复：重新归零
+        rig.runUntilSettled(MAX_SAFE_POSITION_MS * 2);
+    }
+    if (capture) fclose(capture);
+    return missed ? 1 : 0;
+}
+
+// 每组参数放进子进程：仿真硬件和定时器都是进程内的全局状态
+static int runSweep(SimOptions opt) {
+    static const float loads[] = { 0, 2, 5, 10 };
+    static const float noises[] = { 0.5f, 1, 3, 5 };
+    printf("  load  noise  trips  faults  maxerr_cm  mean_ms  slope_ms\n");
+    fflush(stdout);
+    int failed = 0;
+    for (float load : loads) {
+        for (float noise : noises) {
+            opt.params.loadKg = load;
+            opt.params.sensorNoiseCm = noise;
+            pid_t pid = fork();
+            if (pid == 0) {
+                int rc = runOnce(opt, true);
+                fflush(stdout);
+                _exit(rc);
+            }
+            int status = 0;
+            waitpid(pid, &status, 0);
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) failed++;
+        }
+    }
+    printf("%d parameter set(s) with faults\n", failed);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    SimOptions opt;
+    bool sweep = false;
+    bool faults = false;
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(a, "--sweep")) sweep = true;
+        else if (!strcmp(a, "--faults")) faults = true;
+        else if (!strcmp(a, "--verbose")) opt.verbose = true;
+        else if (!strcmp(a, "--days") && hasValue) opt.days = atoi(argv[++i]);
+        else if (!strcmp(a, "--load") && hasValue) opt.params.loadKg = atof(argv[++i]);
+        else if (!strcmp(a, "--noise") && hasValue) opt.params.sensorNoiseCm = atof(argv[++i]);
+        else if (!strcmp(a, "--speed") && hasValue) opt.params.fullSpeedCmS = atof(argv[++i]);
+        else if (!strcmp(a, "--deadband") && hasValue) opt.params.pwmDeadband = atoi(argv[++i]);
+        else if (!strcmp(a, "--seed") && hasValue) opt.seed = strtoul(argv[++i], nullptr, 0);
+        else if (!strcmp(a, "--nvs") && hasValue) opt.nvsPath = argv[++i];
+        else if (!strcmp(a, "--telemetry") && hasValue) opt.telemetryPath = argv[++i];
+        else if (!strcmp(a, "--record")) opt.record = true;
+        else {
+            fprintf(stderr, "usage: %s [--days N] [--load KG] [--noise CM] [--speed CM_S] [--deadband PWM]\n"
+                            "          [--seed S] [--nvs FILE] [--telemetry FILE [--record]] [--verbose]\n"
+                            "          [--sweep] [--faults]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+    if (faults) return runFaults(opt);
+    return sweep ? runSweep(opt) : runOnce(opt, false);
+}
@@ -0,0 +1,123 @@
+/*
+ * 故障与恢复的仿真测试 (仿真硬件 + 虚拟时钟，与 elevator_sim 同一个台架)
+ *   - 恢复归零：打滑让积分位置和实际位置对不上，之后从 ERROR 归零；
+ *     这次归零的起点不可信，不能改动短期异常基准、上升速度比和全程运行统计
+ *   - 量程外下降打滑：本段发现不了 (电流正常、传感器一直报“远”)，积分位置停在底层；
+ *     下一次上升时吊篮比学到的进量程位置提前进入量程，在撞顶之前按卡滞停机
+ * 失败时退出码为 1。
+ *
+ * 编译：make -C sim          (生成 sim/build/fault_test)
+ * 用法：fault_test [--verbose]
+ */
+
+#include <cstdio>
+#include <cstring>
+#include "../sim/SimRig.h"
+
+TelemetryLog telemetry;
+
+static SimRig rig;
+static int s_failures = 0;
+
+static void check(bool ok, const char* scenario, const char* what) {
+    printf("  %-4s %-16s %s\n", ok ? "ok" : "FAIL", scenario, what);
+    if (!ok) s_failures++;
+}
+
+static bool travel(uint8_t floor) {
+    rig.goFloor(floor);
+    return rig.runUntilSettled(MAX_SAFE_POSITION_MS * 2) >= 0;
+}
+
+// 维护管理器学到的东西：各起点区间的归零阈值、上升速度比、全程运行次数
+struct Learned {
+    long acuteLimitMs[BASELINE_POS_BUCKETS];
+    uint32_t upRateQ16;
+    uint32_t runs;
+
+    static Learned of(MaintenanceManager& m) {
+        Learned l;
+        for (int b = 0; b < BASELINE_POS_BUCKETS; b++) {
+            long from = (long)MAX_SAFE_POSITION_MS * (2 * b + 1) / (2 * BASELINE_POS_BUCKETS);
+            m.beginRun(-1, from, from); // 只算阈值，静止时调用不影响别的
+            l.acuteLimitMs[b] = m.getAcuteLimitMs();
+        }
+        l.upRateQ16 = m.getUpRateQ16(PWM_SPEED_UP);
+        l.runs = m.getRunCount(WINDOW_ALL);
+        return l;
+    }
+};
+
+static void scenarioRecoveryHoming() {
+    const char* name = "recovery homing";
+    // 先攒够样本：底 -> 顶的全程归零学到基准和速度比
+    bool ok = true;
+    for (int i = 0; ok && i < ACUTE_MIN_SAMPLES + 1; i++) ok = travel(FLOOR_BOTTOM) && travel(FLOOR_TOP);
+    check(ok && rig.maintenance.isUpRateLearned(), name, "baseline and up rate learned");
+
+    // 下行快到底时打滑：积分位置继续走，吊篮停在上面；不管是否被发现，急停后都是 ERROR 且位置是错的
+    rig.goFloor(FLOOR_BOTTOM);
+    long slipAt = floorPositionMs(FLOOR_COUNT - 1) - 3000;
+    while (!rig.settled() && rig.hoist.getCurrentPosition() < slipAt) rig.cycle();
+    setMockSlip(true);
+    rig.runUntilSettled(MAX_SAFE_POSITION_MS * 2);
+    setMockSlip(false);
+    if (rig.hoist.getState() != STATE_ERROR) rig.hoist.emergencyStop();
+    check(rig.hoist.getState() == STATE_ERROR, name, "in ERROR with a drifted position");
+
+    Learned before = Learned::of(rig.maintenance);
+    bool homed = travel(FLOOR_TOP) && rig.hoist.getState() == STATE_IDLE && rig.hoist.getCurrentPosition() == 0;
+    Learned after = Learned::of(rig.maintenance);
+    check(homed, name, "homes from ERROR");
+    check(!memcmp(before.acuteLimitMs, after.acuteLimitMs, sizeof(before.acuteLimitMs)), name,
+          "acute baseline unchanged");
+    check(before.upRateQ16 == after.upRateQ16, name, "up rate unchanged");
+    check(before.runs == after.runs, name, "no full run recorded");
+
+    // 之后正常的全程归零照常学习
+    ok = travel(FLOOR_BOTTOM) && travel(FLOOR_TOP);
+    check(ok && rig.maintenance.getRunCount(WINDOW_ALL) == after.runs + 1, name, "next trusted homing still learns");
+}
+
+static void scenarioFarDownSlip() {
+    const char* name = "far down slip";
+    bool ok = travel(FLOOR_TOP) && travel(FLOOR_BOTTOM) && travel(FLOOR_TOP);
+    check(ok && rig.hoist.getState() == STATE_IDLE, name, "normal trips learn the range entry");
+
+    rig.goFloor(FLOOR_BOTTOM);
+    while (!rig.settled() && rig.hoist.getCurrentPosition() < floorPositionMs(FLOOR_MIDDLE)) rig.cycle();
+    setMockSlip(true);
+    rig.runUntilSettled(MAX_SAFE_POSITION_MS * 2);
+    setMockSlip(false);
+    check(rig.hoist.getState() == STATE_IDLE &&
+              rig.hoist.getCurrentPosition() >= floorPositionMs(FLOOR_BOTTOM) - (long)floorSpec(FLOOR_BOTTOM).toleranceMs,
+          name, "slip run ends at the bottom by position (not detectable)");
+
+    rig.goFloor(FLOOR_TOP);
+    unsigned long start = millis();
+    bool hitTop = false;
+    while (!rig.settled()) {
+        rig.cycle();
+        hitTop = hitTop || isTopLimitPressed();
+    }
+    char what[96];
+    snprintf(what, sizeof(what), "next up run stops on stall before the top (%.1f s)", (millis() - start) / 1000.0);
+    check(rig.hoist.getState() == STATE_ERROR && rig.hoist.getLastReason() == REASON_STALL && !hitTop, name, what);
+
+    check(travel(FLOOR_TOP) && rig.hoist.getState() == STATE_IDLE, name, "recovery homing");
+}
+
+int main(int argc, char** argv) {
+    bool verbose = argc > 1 && !strcmp(argv[1], "--verbose");
+    simSerialQuiet(!verbose);
+    rig.begin(simDefaultParams());
+    if (rig.runUntilSettled(MAX_SAFE_POSITION_MS * 2) < 0 || rig.hoist.getState() != STATE_IDLE) {
+        fprintf(stderr, "boot calibration failed (state %s)\n", rig.hoist.getStateName());
+        return 1;
+    }
+    printf("fault and recovery scenarios\n");
+    scenarioRecoveryHoming();
+    scenarioFarDownSlip();
+    printf("%s (%d failed)\n", s_failures ? "FAIL" : "PASS", s_failures);
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,167 @@
+/*
+ * 定点统计 (FixedPoint.h / RunStatistics.h / AcuteBaseline.h) 与浮点参考实现的等价性测试
+ * 随机生成运行历史，检查：
+ *   - 各窗口的回归斜率 slope() 与原来的浮点公式 slopeReference() 相差不超过半个 Q16 最低位 × 10ms
+ *   - 全历史均值 mean() 与 double 均值相差不超过半个 Q8 最低位
+ *   - 前后耗时相差悬殊时斜率饱和在 ±32767 ms/次，不回绕、符号正确
+ *   - 卡滞阈值 (AcuteBaseline 的 Q16 / Q24 EWMA) 与同一公式的 double 版相差不超过 ACUTE_TOLERANCE_MS
+ * 失败时退出码为 1。
+ *
+ * 编译：make -C sim          (生成 sim/build/fixed_point_test)
+ * 用法：fixed_point_test
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include "../RunStatistics.h"
+#include "../AcuteBaseline.h"
+
+static int s_failures = 0;
+
+static void check(bool ok, const char* scenario, const char* what) {
+    printf("  %-4s %-14s %s\n", ok ? "ok" : "FAIL", scenario, what);
+    if (!ok) s_failures++;
+}
+
+// 换算误差：斜率在 10ms 单位下四舍五入到 Q16，乘回 ms 后最多差半个最低位 × 10
+static const double SLOPE_TOLERANCE = 0.5 / Q16::ONE * STATS_UNIT_MS + 1e-9;
+static const double MEAN_TOLERANCE = 0.5 / Q8::ONE + 1e-9;
+static const double ACUTE_TOLERANCE_MS = 50;
+
+// toFloat() 是单精度，100 s 量级时最低位就有 8ms，比较时按 double 换算
+template <int F>
+static double toDouble(Fixed<F> v) {
+    return (double)v.raw / Fixed<F>::ONE;
+}
+
+static double doubleMean(const RegressionSums& s) {
+    return s.n ? (double)s.sumY / s.n * STATS_UNIT_MS : 0.0;
+}
+
+static void scenarioSlope() {
+    std::mt19937 rng(12345);
+    const StatsWindow windows[] = { WINDOW_SHORT, WINDOW_MEDIUM, WINDOW_ALL };
+    const char* const names[] = { "short", "medium", "all" };
+    double worstSlope[WINDOW_COUNT] = {}, worstMean = 0;
+
+    // 几种历史：平稳、慢慢变慢、噪声很大
+    const double drifts[] = { 0.0, 3.0, -1.5 };
+    const double noises[] = { 200.0, 800.0, 5000.0 };
+    for (int h = 0; h < 3; h++) {
+        RunStatistics stats;
+        std::normal_distribution<double> noise(0.0, noises[h]);
+        for (int i = 0; i < 30000; i++) {
+            stats.add(lround(100000 + drifts[h] * i + noise(rng)));
+            if (i % 97 != 0) continue; // 抽查，全历史窗口的 n 覆盖 1..30000
+            for (int w = 0; w < WINDOW_COUNT; w++) {
+                double ds = fabs(toDouble(stats.slope(windows[w])) - stats.slopeReference(windows[w]));
+                if (ds > worstSlope[w]) worstSlope[w] = ds;
+            }
+            double dm = fabs(toDouble(stats.mean(WINDOW_ALL)) - doubleMean(stats.allTime()));
+            if (dm > worstMean) worstMean = dm;
+        }
+    }
+    for (int w = 0; w < WINDOW_COUNT; w++) {
+        char what[96];
+        snprintf(what, sizeof(what), "slope(%s) within %.1e ms/run of double (worst %.1e)", names[w],
+                 SLOPE_TOLERANCE, worstSlope[w]);
+        check(worstSlope[w] <= SLOPE_TOLERANCE, "slope", what);
+    }
+    char what[96];
+    snprintf(what, sizeof(what), "mean(all) within %.1e ms of double (worst %.1e)", MEAN_TOLERANCE, worstMean);
+    check(worstMean <= MEAN_TOLERANCE, "mean", what);
+}
+
+static void scenarioSaturation() {
+    // 两次运行：10 s 和 50 s -> 40000 ms/次，超出 Q16
+    RegressionSums up = {};
+    up.add(RunStatistics::toUnits(10000));
+    up.add(RunStatistics::toUnits(50000));
+    check(up.slope().raw == INT32_MAX, "saturation", "+40000 ms/run saturates at +32767");
+
+    RegressionSums down = {};
+    down.add(RunStatistics::toUnits(50000));
+    down.add(RunStatistics::toUnits(10000));
+    check(down.slope().raw == INT32_MIN, "saturation", "-40000 ms/run saturates at -32768");
+
+    // 量程两端：0 -> 655 s
+    RegressionSums extreme = {};
+    extreme.add(0);
+    extreme.add(0xFFFF);
+    check(extreme.slope().raw == INT32_MAX, "saturation", "0 -> 655 s does not wrap");
+
+    // 刚好在范围内的不受影响
+    RegressionSums inRange = {};
+    inRange.add(RunStatistics::toUnits(10000));
+    inRange.add(RunStatistics::toUnits(42000));
+    check(fabs(toDouble(inRange.slope()) - 32000.0) <= SLOPE_TOLERANCE, "saturation",
+          "+32000 ms/run is exact");
+}
+
+// AcuteBaseline 同一公式的 double 版
+struct AcuteReference {
+    double mean = 0, variance = 0;
+    int samples = 0;
+
+    void learn(long distanceMs, long durationMs) {
+        double ratio = (double)durationMs / distanceMs;
+        if (samples == 0) {
+            mean = ratio;
+            variance = 0;
+        } else {
+            double diff = ratio - mean;
+            double incr = ACUTE_EWMA_ALPHA * diff;
+            mean += incr;
+            variance = (1 - ACUTE_EWMA_ALPHA) * (variance + diff * incr);
+        }
+        samples++;
+    }
+
+    long limit(long distanceMs) const {
+        long limit = lround(distanceMs * (mean + ACUTE_SIGMA_K * sqrt(variance))) + ACUTE_MARGIN_MS;
+        long fallback = (long)(MAINTENANCE_BASELINE_MS * ACUTE_THRESHOLD_RATIO);
+        return limit < fallback ? limit : fallback;
+    }
+};
+
+static void scenarioAcute() {
+    std::mt19937 rng(777);
+    std::normal_distribution<double> jitter(0.0, 0.01);
+    std::uniform_int_distribution<long> start(ACUTE_MIN_DISTANCE_MS, MAX_SAFE_POSITION_MS);
+    AcuteBaseline baseline;
+    baseline.begin();
+    AcuteReference refs[BASELINE_POS_BUCKETS];
+    long worst = 0;
+    bool adaptive = false;
+
+    for (int i = 0; i < 2000; i++) {
+        // 上升归零：行程 = 起点
+        long from = start(rng);
+        long duration = lround(from * (1.08 + jitter(rng)));
+        int bucket = (int)(from * BASELINE_POS_BUCKETS / (long)MAX_SAFE_POSITION_MS);
+        if (bucket >= BASELINE_POS_BUCKETS) bucket = BASELINE_POS_BUCKETS - 1;
+
+        baseline.beginRun(-1, from, from);
+        if (refs[bucket].samples >= ACUTE_MIN_SAMPLES) {
+            long diff = labs(baseline.getLimitMs() - refs[bucket].limit(from));
+            if (diff > worst) worst = diff;
+            adaptive = adaptive || baseline.getLimitMs() < (long)(MAINTENANCE_BASELINE_MS * ACUTE_THRESHOLD_RATIO);
+        }
+        baseline.learn(-1, from, from, duration);
+        refs[bucket].learn(from, duration);
+    }
+    char what[96];
+    snprintf(what, sizeof(what), "limit within %.0f ms of double (worst %ld ms)", ACUTE_TOLERANCE_MS, worst);
+    check(worst <= ACUTE_TOLERANCE_MS, "acute", what);
+    check(adaptive, "acute", "adaptive limit actually used");
+}
+
+int main() {
+    printf("fixed point vs double reference\n");
+    scenarioSlope();
+    scenarioSaturation();
+    scenarioAcute();
+    printf("%s (%d failed)\n", s_failures ? "FAIL" : "PASS", s_failures);
+    return s_failures ? 1 : 0;
+}
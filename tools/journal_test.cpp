@@ -0,0 +1,183 @@
+/*
+ * 运行日志 (RunJournal.h) 记录格式的主机测试
+ * 用 sim/ 的文件模拟 Preferences：每个场景写到一个临时 NVS 文件，“重启”时从文件重新读入，
+ * 再用新的 RunJournal 恢复，检查：
+ *   - 成批提交后重启，最近的记录按序号连续恢复
+ *   - append() 本身从不写 Flash，换页时写满的页留到下一次 flush()
+ *   - 脏页还没落盘时 readRecent() 读到的是 RAM 里的内容
+ *   - 换页后头指针没来得及写 (掉电)，恢复时跟到下一页
+ *   - 页内一条记录损坏，它和之后的记录被丢弃
+ *   - 写满所有页后循环覆盖，只保留最近 JOURNAL_CAPACITY 条
+ *   - MaintenanceManager：recordRun() / update() (控制任务) 从不写 Flash，
+ *     service() (网络任务) 在运行中也不写，空闲后才提交，重启后运行次数完整
+ * 失败时退出码为 1。
+ *
+ * 编译：make -C sim          (生成 sim/build/journal_test)
+ * 用法：journal_test
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include "../RunJournal.h"
+#include "../MaintenanceManager.h"
+
+TelemetryLog telemetry;
+
+static const char* NVS_FILE = "/tmp/journal_test.nvs";
+static int s_failures = 0;
+
+static void check(bool ok, const char* scenario, const char* what) {
+    printf("  %-4s %-20s %s\n", ok ? "ok" : "FAIL", scenario, what);
+    if (!ok) s_failures++;
+}
+
+// 一次“上电”：从文件读回 Flash，打开命名空间
+struct Device {
+    Preferences prefs;
+    RunJournal journal;
+
+    void boot() {
+        simNvsOpen(NVS_FILE);
+        prefs.begin("journal_test", false);
+        journal.begin(&prefs);
+    }
+
+    // 与 MaintenanceManager::service() 相同的成批提交
+    void appendRuns(uint32_t firstDuration, int n, int batch) {
+        for (int i = 0; i < n; i++) {
+            journal.append(firstDuration + i, i);
+            if (journal.getPendingCount() >= batch) journal.flush();
+        }
+    }
+};
+
+static void freshFlash() {
+    unlink(NVS_FILE);
+    simNvsOpen(NVS_FILE);
+}
+
+// 最近 n 条应是 lastSeq-n+1 .. lastSeq，时长与序号一一对应 (duration = seq + offset)
+static bool recentConsecutive(RunJournal& journal, int n, int32_t offset) {
+    JournalRecord recs[JOURNAL_CAPACITY];
+    int got = journal.readRecent(recs, n);
+    if (got != n) return false;
+    for (int i = 0; i < got; i++) {
+        uint32_t seq = journal.getLastSeq() - got + 1 + i;
+        if (recs[i].seq != seq || recs[i].durationMs != (int32_t)seq + offset) return false;
+    }
+    return true;
+}
+
+static void scenarioRestart() {
+    freshFlash();
+    Device a;
+    a.boot();
+    a.appendRuns(1000, 40, JOURNAL_BATCH_SIZE);
+    a.journal.flush();
+
+    Device b;
+    b.boot();
+    check(b.journal.getLastSeq() == 40, "restart", "last sequence restored");
+    check(recentConsecutive(b.journal, 40, 999), "restart", "40 records read back in order");
+}
+
+static void scenarioAppendNoWrite() {
+    freshFlash();
+    Device a;
+    a.boot();
+    uint32_t writes = simNvsWriteCount();
+    a.appendRuns(1000, JOURNAL_RECORDS_PER_PAGE + 3, JOURNAL_CAPACITY); // 跨页，不提交
+    check(simNvsWriteCount() == writes, "append", "append never writes flash, even across a page");
+    check(a.journal.getPendingCount() == JOURNAL_RECORDS_PER_PAGE + 3, "append", "full page counted as pending");
+    check(recentConsecutive(a.journal, JOURNAL_RECORDS_PER_PAGE + 3, 999), "append",
+          "readRecent sees the unflushed full page");
+
+    a.journal.flush();
+    check(simNvsWriteCount() - writes == 3, "append", "flush writes full page, head page, head pointer");
+    Device b;
+    b.boot();
+    check(recentConsecutive(b.journal, JOURNAL_RECORDS_PER_PAGE + 3, 999), "append", "both pages survive a reboot");
+}
+
+static void scenarioLaggingHead() {
+    freshFlash();
+    Device a;
+    a.boot();
+    a.appendRuns(1000, JOURNAL_RECORDS_PER_PAGE + 2, 1);
+    // 掉电：新页已写入，但头指针还指着上一页
+    a.prefs.putUChar("j_head", 0);
+
+    Device b;
+    b.boot();
+    check(b.journal.getLastSeq() == JOURNAL_RECORDS_PER_PAGE + 2, "lagging head", "recovery follows to the next page");
+}
+
+static void scenarioCorrupt() {
+    freshFlash();
+    Device a;
+    a.boot();
+    a.appendRuns(1000, 10, 1);
+    JournalRecord page[JOURNAL_RECORDS_PER_PAGE];
+    a.prefs.getBytes("jp0", page, sizeof(page));
+    page[6].durationMs ^= 0x40; // CRC 不再匹配
+    a.prefs.putBytes("jp0", page, sizeof(page));
+
+    Device b;
+    b.boot();
+    check(b.journal.getLastSeq() == 6, "corrupt", "records from the damaged one on are dropped");
+    check(recentConsecutive(b.journal, 6, 999), "corrupt", "records before it are intact");
+}
+
+static void scenarioWrap() {
+    freshFlash();
+    Device a;
+    a.boot();
+    a.appendRuns(5000, JOURNAL_CAPACITY * 2 + 5, JOURNAL_BATCH_SIZE);
+    a.journal.flush();
+
+    Device b;
+    b.boot();
+    JournalRecord recs[JOURNAL_CAPACITY];
+    int got = b.journal.readRecent(recs, JOURNAL_CAPACITY);
+    check(b.journal.getLastSeq() == JOURNAL_CAPACITY * 2 + 5, "wrap", "last sequence after wrapping");
+    // 头页只写了一部分，它覆盖掉的最老一页读不到了
+    check(got > JOURNAL_CAPACITY - JOURNAL_RECORDS_PER_PAGE && recentConsecutive(b.journal, got, 4999), "wrap",
+          "newest pages read back in order");
+}
+
+static void scenarioMaintenanceHandoff() {
+    freshFlash();
+    MaintenanceManager a;
+    a.begin();
+    uint32_t writes = simNvsWriteCount();
+    a.update(false);
+    for (int i = 0; i < JOURNAL_BATCH_SIZE; i++) a.recordRun(8000 + i);
+    a.update(false);
+    check(simNvsWriteCount() == writes, "handoff", "recordRun and update never write flash");
+    a.service();
+    check(simNvsWriteCount() == writes, "handoff", "a full batch waits while the hoist moves");
+    a.update(true);
+    a.service();
+    check(simNvsWriteCount() > writes, "handoff", "service commits once the hoist is idle");
+
+    simNvsOpen(NVS_FILE);
+    MaintenanceManager b;
+    b.begin();
+    check(b.getRunCount(WINDOW_ALL) == JOURNAL_BATCH_SIZE, "handoff", "all runs survive a reboot");
+}
+
+int main() {
+    simSerialQuiet(true);
+    printf("journal: %d pages x %d records, batch %d\n", JOURNAL_PAGE_COUNT, JOURNAL_RECORDS_PER_PAGE,
+           JOURNAL_BATCH_SIZE);
+    scenarioRestart();
+    scenarioAppendNoWrite();
+    scenarioLaggingHead();
+    scenarioCorrupt();
+    scenarioWrap();
+    scenarioMaintenanceHandoff();
+    unlink(NVS_FILE);
+    printf("%s (%d failed)\n", s_failures ? "FAIL" : "PASS", s_failures);
+    return s_failures ? 1 : 0;
+}
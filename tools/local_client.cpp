@@ -0,0 +1,258 @@
+/*
+ * 局域网控制客户端 (主机端)
+ * 通过 UDP 直接给设备下发楼层 / 急停指令，订阅并打印状态推送 (协议见 LocalProtocol.h)。
+ *
+ * latency 模式测量“指令 -> 电机动作”的延迟：等电梯空闲后下发楼层指令，
+ * 收到电机输出不为 0 的推送即为启动；随后下发急停，收到 ERROR 推送即为停止。
+ * 加 --cloud 时指令改走 Blynk 云端 (HTTP API 写 V20 / V1)，仍由局域网推送观察结果，
+ * 两条路径用同样的方法测量，可以直接对比。
+ * 注意：latency 会真实地启动并急停电梯，建议在 USE_SIMULATED_HARDWARE 固件上运行，
+ * 或者连主机上的假设备 tools/local_device (make -C sim test 就这样跑一遍回环测试)。
+ * 有任何一次没看到启动或停止时退出码为 1。
+ *
+ * 编译：make -C sim          (生成 sim/build/local_client)
+ *       或 g++ -std=c++17 -O2 -o local_client tools/local_client.cpp
+ * 用法：local_client [--key K] [--port P] <设备 IP> go <楼层下标>
+ *       local_client [...] <设备 IP> stop
+ *       local_client [...] <设备 IP> watch
+ *       local_client [...] [--cloud TOKEN] <设备 IP> latency [次数]
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../Config.h"
+#include "../TelemetryFormat.h"
+#include "../LocalProtocol.h"
+
+static int s_sock = -1;
+static sockaddr_in s_device = {};
+static uint32_t s_key = 0;
+static uint8_t s_seq = 0;
+static const char* s_cloudToken = nullptr;
+static const char* s_cloudHost = "blynk.cloud";
+
+static double nowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+static uint8_t sendCommand(uint8_t type, int16_t arg = 0) {
+    LocalCommand cmd;
+    localHeader(cmd.header, type, ++s_seq);
+    cmd.key = s_key;
+    cmd.arg = arg;
+    sendto(s_sock, &cmd, sizeof(cmd), 0, (const sockaddr*)&s_device, sizeof(s_device));
+    return s_seq;
+}
+
+// 等一个包，超时返回 0，否则返回长度
+static int receive(uint8_t* buf, size_t size, int timeoutMs) {
+    pollfd pfd = { s_sock, POLLIN, 0 };
+    if (poll(&pfd, 1, timeoutMs) <= 0) return 0;
+    ssize_t n = recv(s_sock, buf, size, 0);
+    return n > 0 ? (int)n : 0;
+}
+
+static bool asStatus(const uint8_t* buf, int len, LocalStatusPush& out) {
+    if (len != (int)sizeof(out)) return false;
+    memcpy(&out, buf, sizeof(out));
+    return localHeaderValid(out.header) && out.header.type == LOCAL_STATUS;
+}
+
+static bool asAck(const uint8_t* buf, int len, LocalAck& out) {
+    if (len != (int)sizeof(out)) return false;
+    memcpy(&out, buf, sizeof(out));
+    return localHeaderValid(out.header) && out.header.type == LOCAL_ACK;
+}
+
+static void printStatus(const LocalStatusPush& s) {
+    printf("[%8u ms] #%-3u %-7s target=%-6s pending=%u top=%u duty=%3u pos=%ld\n",
+           s.deviceMs, s.header.seq, telemetryStateName(s.state),
+           s.targetFloor < FLOOR_COUNT ? FLOOR_TABLE[s.targetFloor].name : "-",
+           s.pendingStops, s.topLimit, s.duty, (long)s.positionMs);
+}
+
+// 发一条指令并等应答 (重试 3 次)
+static bool command(uint8_t type, int16_t arg, LocalAck* ackOut = nullptr) {
+    for (int attempt = 0; attempt < 3; attempt++) {
+        uint8_t seq = sendCommand(type, arg);
+        double deadline = nowMs() + 500;
+        uint8_t buf[64];
+        while (nowMs() < deadline) {
+            LocalAck ack;
+            int len = receive(buf, sizeof(buf), (int)(deadline - nowMs()) + 1);
+            if (asAck(buf, len, ack) && ack.header.seq == seq) {
+                if (ack.result != LOCAL_OK) fprintf(stderr, "device: %s\n", localResultName(ack.result));
+                if (ackOut) *ackOut = ack;
+                return ack.result == LOCAL_OK;
+            }
+        }
+    }
+    fprintf(stderr, "no reply from device\n");
+    return false;
+}
+
+// Blynk HTTP API：GET /external/api/update?token=..&Vn=value，只看是否 200
+static bool cloudWrite(int pin, int value) {
+    addrinfo hints = {}, *res = nullptr;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(s_cloudHost, "80", &hints, &res) != 0) return false;
+    int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    bool ok = fd >= 0 && connect(fd, res->ai_addr, res->ai_addrlen) == 0;
+    freeaddrinfo(res);
+    if (ok) {
+        char req[256];
+        int n = snprintf(req, sizeof(req),
+                         "GET /external/api/update?token=%s&V%d=%d HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n",
+                         s_cloudToken, pin, value, s_cloudHost);
+        ok = send(fd, req, n, 0) == n;
+        char resp[64] = {};
+        ok = ok && recv(fd, resp, sizeof(resp) - 1, 0) > 0 && strstr(resp, " 200 ") != nullptr;
+    }
+    if (fd >= 0) close(fd);
+    return ok;
+}
+
+// 等到满足条件的推送，返回主机收到的时刻，超时返回 < 0
+template <typename Pred>
+static double waitStatus(Pred pred, int timeoutMs, LocalStatusPush* out = nullptr) {
+    double deadline = nowMs() + timeoutMs;
+    double lastSubscribe = nowMs();
+    uint8_t buf[64];
+    while (nowMs() < deadline) {
+        if (nowMs() - lastSubscribe > LOCAL_SUBSCRIBE_TIMEOUT_MS / 2) {
+            sendCommand(LOCAL_SUBSCRIBE);
+            lastSubscribe = nowMs();
+        }
+        LocalStatusPush s;
+        int len = receive(buf, sizeof(buf), 100);
+        if (len && asStatus(buf, len, s) && pred(s)) {
+            if (out) *out = s;
+            return nowMs();
+        }
+    }
+    return -1;
+}
+
+struct Samples {
+    std::vector<double> v;
+    void print(const char* name) {
+        if (v.empty()) {
+            printf("%-30s n=0\n", name);
+            return;
+        }
+        std::sort(v.begin(), v.end());
+        printf("%-30s n=%-3zu min=%7.1f  median=%7.1f  max=%7.1f ms\n", name, v.size(), v.front(),
+               v[v.size() / 2], v.back());
+    }
+};
+
+static int runLatency(int runs) {
+    if (FLOOR_COUNT < 2) return 1;
+    bool cloud = s_cloudToken != nullptr;
+    Samples start, stop, deviceStart, ackRtt;
+
+    if (!command(LOCAL_SUBSCRIBE, 0)) return 1;
+    for (int i = 0; i < runs; i++) {
+        // 在最低层和它上面一层之间来回，不去顶层 (顶层是归零行程)
+        uint8_t floor = (i % 2 == 0) ? FLOOR_COUNT - 1 : FLOOR_COUNT - 2;
+        if (floor == FLOOR_TOP) floor = FLOOR_COUNT - 1;
+
+        LocalStatusPush before;
+        if (waitStatus([](const LocalStatusPush& s) { return s.duty == 0 && s.state != STATE_MOVING_UP &&
+                                                             s.state != STATE_MOVING_DOWN &&
+                                                             s.state != STATE_CALIBRATING; },
+                       300000, &before) < 0) {
+            fprintf(stderr, "hoist never came to rest\n");
+            return 1;
+        }
+        if (before.state == STATE_POS_UNKNOWN) {
+            fprintf(stderr, "position unknown, home the hoist first ('go 0')\n");
+            return 1;
+        }
+
+        double t0 = nowMs();
+        LocalAck ack = {};
+        bool sent = cloud ? cloudWrite(20, FLOOR_COUNT - floor) : command(LOCAL_GO_FLOOR, floor, &ack);
+        if (!sent) return 1;
+        if (!cloud) ackRtt.v.push_back(nowMs() - t0);
+
+        LocalStatusPush moving;
+        double t1 = waitStatus([](const LocalStatusPush& s) { return s.duty != 0; }, 10000, &moving);
+        if (t1 < 0) {
+            printf("run %d: no motor start seen (already at %s?)\n", i, FLOOR_TABLE[floor].name);
+            continue;
+        }
+        start.v.push_back(t1 - t0);
+        if (!cloud) deviceStart.v.push_back((double)(moving.deviceMs - ack.deviceMs));
+
+        double t2 = nowMs();
+        sent = cloud ? cloudWrite(1, 1) : command(LOCAL_EMERGENCY_STOP, 0);
+        if (!sent) return 1;
+        double t3 = waitStatus([](const LocalStatusPush& s) { return s.state == STATE_ERROR && s.duty == 0; }, 10000);
+        if (t3 >= 0) stop.v.push_back(t3 - t2);
+        printf("run %d: %s start %.1f ms, stop %.1f ms\n", i, FLOOR_TABLE[floor].name, t1 - t0,
+               t3 >= 0 ? t3 - t2 : -1.0);
+    }
+    command(LOCAL_UNSUBSCRIBE, 0);
+
+    printf("\n=== %s path, %d runs ===\n", cloud ? "Cloud (Blynk HTTP API)" : "Local (UDP)", runs);
+    if (!cloud) ackRtt.print("command -> ack (RTT)");
+    start.print("command -> motor start");
+    if (!cloud) deviceStart.print("  of which on device");
+    stop.print("e-stop -> motor stopped");
+    return (int)start.v.size() == runs && (int)stop.v.size() == runs ? 0 : 1;
+}
+
+static int usage() {
+    fprintf(stderr, "usage: local_client [--key K] [--port P] [--cloud TOKEN] [--cloud-host H] <ip> "
+                    "go <floor> | stop | watch | latency [runs]\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    uint16_t port = LOCAL_CONTROL_PORT;
+    int i = 1;
+    for (; i + 1 < argc && strncmp(argv[i], "--", 2) == 0; i += 2) {
+        if (!strcmp(argv[i], "--key")) s_key = (uint32_t)strtoul(argv[i + 1], nullptr, 0);
+        else if (!strcmp(argv[i], "--port")) port = (uint16_t)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--cloud")) s_cloudToken = argv[i + 1];
+        else if (!strcmp(argv[i], "--cloud-host")) s_cloudHost = argv[i + 1];
+        else return usage();
+    }
+    if (argc - i < 2) return usage();
+
+    s_device.sin_family = AF_INET;
+    s_device.sin_port = htons(port);
+    if (inet_pton(AF_INET, argv[i], &s_device.sin_addr) != 1) return usage();
+    s_sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (s_sock < 0) return 1;
+
+    std::string mode = argv[i + 1];
+    if (mode == "go" && argc - i >= 3) {
+        int floor = atoi(argv[i + 2]);
+        if (floor < 0 || floor >= FLOOR_COUNT) return usage();
+        return command(LOCAL_GO_FLOOR, floor) ? 0 : 1;
+    }
+    if (mode == "stop") return command(LOCAL_EMERGENCY_STOP, 0) ? 0 : 1;
+    if (mode == "watch") {
+        if (!command(LOCAL_SUBSCRIBE, 0)) return 1;
+        LocalStatusPush s;
+        for (;;) {
+            if (waitStatus([](const LocalStatusPush&) { return true; }, 60000, &s) >= 0) printStatus(s);
+        }
+    }
+    if (mode == "latency") return runLatency(argc - i >= 3 ? atoi(argv[i + 2]) : 10);
+    return usage();
+}
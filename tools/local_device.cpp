@@ -0,0 +1,89 @@
+/*
+ * 局域网控制的假设备 (主机端)
+ * 仿真硬件 + 真实的状态机，外加固件同一个 LocalControl (UDP 走 sim/WiFiUdp.h 的主机 socket)。
+ * 控制周期按墙上时间推进，tools/local_client 可以像连真设备一样连上来：
+ *   local_device &
+ *   local_client --key 0x51A7E5ED 127.0.0.1 latency
+ * 启动时先在虚拟时间里归零 (不占墙上时间)，之后每个主循环按 SmartElevator.ino 的顺序跑：
+ * 控制任务 (急停 -> 队列指令 -> update -> 发布状态) 补到当前时刻，再跑一次网络任务的 LocalControl。
+ * 端口是固件的 LOCAL_CONTROL_PORT，密钥固定为 LOCAL_DEVICE_KEY。
+ *
+ * 编译：make -C sim          (生成 sim/build/local_device)
+ * 用法：local_device [--seconds N]
+ *   --seconds  运行 N 秒后退出 (默认一直运行)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#define LOCAL_DEVICE_KEY 0x51A7E5EDUL
+#define LOCAL_CONTROL_KEY LOCAL_DEVICE_KEY
+
+#include "../sim/SimRig.h"
+#include "../LocalControl.h"
+
+TelemetryLog telemetry;
+ControlChannel controlChannel;
+
+static SimRig rig;
+static LocalControl local;
+
+// SmartElevator.ino 控制任务的指令 / 状态部分
+static void controlCycle() {
+    bool stopped = controlChannel.takeEmergencyStop();
+    if (stopped) rig.hoist.emergencyStop();
+    HoistCommand cmd;
+    while (controlChannel.take(cmd)) {
+        if (cmd.type == CMD_GO_FLOOR && !stopped) rig.goFloor((uint8_t)cmd.arg);
+    }
+
+    rig.cycle();
+
+    HoistStatus status = {};
+    status.state = rig.hoist.getState();
+    status.stateName = rig.hoist.getStateName();
+    status.positionMs = rig.hoist.getCurrentPosition();
+    status.topLimit = isTopLimitPressed();
+    status.pendingStops = rig.hoist.getPendingStops();
+    status.targetFloor = rig.hoist.getTargetFloor();
+    status.duty = (uint8_t)motionGetAppliedDuty();
+    controlChannel.publishStatus(status);
+}
+
+int main(int argc, char** argv) {
+    long seconds = -1;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--seconds") && i + 1 < argc) seconds = atol(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--seconds N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    simSerialQuiet(true);
+    rig.begin(simDefaultParams());
+    if (rig.runUntilSettled(MAX_SAFE_POSITION_MS * 2) < 0 || rig.hoist.getState() != STATE_IDLE) {
+        fprintf(stderr, "homing failed (state %s)\n", rig.hoist.getStateName());
+        return 1;
+    }
+    controlCycle();
+    simSerialQuiet(false);
+
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point wallStart = Clock::now();
+    unsigned long simStart = millis();
+    for (;;) {
+        long elapsedMs = (long)std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - wallStart).count();
+        if (seconds >= 0 && elapsedMs >= seconds * 1000) break;
+        while ((long)millis() - (long)simStart < elapsedMs) controlCycle();
+
+        HoistStatus status;
+        if (controlChannel.readStatus(status)) local.service(status, true);
+        fflush(stdout);
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+    return 0;
+}
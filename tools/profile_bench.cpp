@@ -0,0 +1,111 @@
+/*
+ * 主循环分段耗时的主机基准
+ * 在仿真硬件 + 虚拟时钟上按固件的两个任务的顺序交替运行：控制周期 (STAGE_HOIST) 和
+ * 网络循环 (调度器、1s 状态块、整圈)，用固件同一个 LoopProfiler 统计，输出与串口 'L' 相同的表。
+ * 计时用主机 CPU 的周期计数，数值是主机上的耗时，用来比较改动前后的相对变化，不代表 ESP32 上的绝对值。
+ *
+ * 先跑一段预热，请求清零 (与 'L' 相同的 requestReset)，再跑 N 个行程做统计；
+ * 同时检查清零后每个阶段都从零开始计数。
+ *
+ * 编译：make -C sim          (生成 sim/build/profile_bench)
+ * 用法：profile_bench [行程数]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include "../sim/SimRig.h"
+#include "../SchedulerManager.h"
+#include "../LoopProfiler.h"
+
+TelemetryLog telemetry;
+LoopProfiler profiler;
+
+static SimRig rig;
+static SchedulerManager scheduler;
+
+// 控制任务一个周期 (SmartElevator.ino controlTask 的主体)
+static void controlCycle() {
+    PROFILE_BEGIN(STAGE_HOIST);
+    isTopLimitPressed();
+    UltrasonicState sensor;
+    getUltrasonicState(sensor);
+    rig.hoist.update();
+    SystemState state = rig.hoist.getState();
+    rig.maintenance.update(state == STATE_IDLE || state == STATE_POS_UNKNOWN);
+    PROFILE_END(STAGE_HOIST);
+}
+
+// 网络任务一圈 (没有 Blynk，只有调度器、状态帧和 1s 状态块)
+static void networkLoop() {
+    static unsigned long lastLog = 0;
+    PROFILE_BEGIN(STAGE_LOOP);
+
+    PROFILE_BEGIN(STAGE_SCHEDULER);
+    scheduler.checkTrigger();
+    PROFILE_END(STAGE_SCHEDULER);
+
+    rig.maintenance.service();
+    telemetry.drain();
+    if (millis() - lastLog > 1000) {
+        PROFILE_BEGIN(STAGE_STATUS);
+        UltrasonicState sensor = {};
+        bool haveSensor = getUltrasonicState(sensor);
+        telemetry.status(rig.hoist.getState(), isTopLimitPressed(), rig.hoist.getPendingStops(),
+                         haveSensor ? sensor.health : SENSOR_DEAD, rig.hoist.getCurrentPosition(),
+                         haveSensor ? sensor.distanceMm : -1);
+        rig.maintenance.calculateSlope();
+        lastLog = millis();
+        PROFILE_END(STAGE_STATUS);
+    }
+
+    PROFILE_END(STAGE_LOOP);
+}
+
+// 一段行程：每 1ms 一个控制周期，中间穿插一圈网络循环
+static bool runTrip(uint8_t floor) {
+    rig.hoist.commandGoFloor(floor);
+    unsigned long start = millis();
+    do {
+        controlCycle();
+        networkLoop();
+        simAdvanceUs((int64_t)CONTROL_TASK_PERIOD_MS * 1000);
+    } while (!rig.settled() && millis() - start < MAX_SAFE_POSITION_MS * 2);
+    return rig.settled() && rig.hoist.getState() == STATE_IDLE;
+}
+
+int main(int argc, char** argv) {
+#if !ENABLE_LOOP_PROFILER
+    printf("ENABLE_LOOP_PROFILER = 0, nothing to measure\n");
+    return 0;
+#endif
+    int trips = argc > 1 ? atoi(argv[1]) : 6;
+    static const uint8_t route[] = { FLOOR_BOTTOM, FLOOR_MIDDLE, FLOOR_TOP };
+
+    simSerialQuiet(true);
+    scheduler.begin();
+    profiler.begin();
+    rig.begin(simDefaultParams());
+    bool ok = runTrip(FLOOR_TOP); // 上电归零当作预热
+
+    profiler.requestReset();
+    for (int i = 0; ok && i < trips; i++) ok = runTrip(route[i % 3]);
+    if (!ok) {
+        fprintf(stderr, "trip failed (state %s)\n", rig.hoist.getStateName());
+        return 1;
+    }
+
+    simSerialQuiet(false);
+    printf("%d trips, %.0f s simulated, host %lu MHz\n", trips, millis() / 1000.0, (unsigned long)simCpuMhz());
+    profiler.dump();
+
+    // 清零请求由写者在下一次记录时执行：只记录一次后计数必须回到 1
+    profiler.requestReset();
+    controlCycle();
+    networkLoop();
+    bool resetOk = true;
+    for (ProfileStage s : { STAGE_HOIST, STAGE_SCHEDULER, STAGE_LOOP }) {
+        resetOk = resetOk && profiler.getCount(s) == 1;
+    }
+    printf("reset request: %s\n", resetOk ? "ok" : "FAIL (stage not cleared by its writer)");
+    return resetOk ? 0 : 1;
+}
@@ -0,0 +1,328 @@
+/*
+ * 录制回放 (主机端)
+ * 读入录制模式下的遥测 (串口 'R'，或 elevator_sim --telemetry 文件 --record)，把其中的 TLM_INPUT 帧
+ * 按原来的时间戳喂给当前代码里的 HoistStateMachine / MaintenanceManager。硬件抽象层换成
+ * sim/hardware_replay.cpp：到顶判断、超声波样本、电流全部取自录制，位置照常由运动定时器积分。
+ * 与控制任务一样，同一毫秒里先应用传感器输入、再应用指令、再跑 update()。
+ *
+ * 报告录制和回放两边的停机延迟、停点偏差 (过冲)、状态切换次数，并逐条比对状态帧：
+ * 同一份代码回放应当完全一致；改了状态机之后，差异就是这次改动的效果。
+ *
+ * 起点：录制里有 TLM_BOOT 时从那次上电开始 (NVS 为空，与 elevator_sim 不带 --nvs 时一致)；
+ *       否则从第一个输入开始，位置取此前最后一个停在 IDLE 的状态帧 (warm start)。
+ *       学到的运行历史不在录制里，这种情况下耗时检查的阈值用默认值，与现场可能不同。
+ *
+ * 编译：make -C sim          (生成 sim/build/replay_runner)
+ * 用法：replay_runner [--check] [--trips] [--out 文件] [--verbose] 录制文件
+ *   --check   状态帧有任何不一致时退出码为 1 (CI 用)
+ *   --trips   逐段打印两边的行程
+ *   --out     回放产生的遥测写到文件，可以再交给 telemetry_decode
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <Arduino.h>
+#include "../Config.h"
+#include "../motion_timer.h"
+#include "../HoistStateMachine.h"
+#include "../MaintenanceManager.h"
+#include "../ControlChannel.h"
+#include "../Telemetry.h"
+#include "../sim/ReplayHardware.h"
+#include "CaptureReport.h"
+
+TelemetryLog telemetry;
+
+static HoistStateMachine hoist;
+static MaintenanceManager maintenance;
+
+struct Frame {
+    uint8_t type;
+    uint8_t seq;
+    uint32_t ts;
+    uint8_t len;
+    uint8_t payload[TLM_MAX_PAYLOAD];
+};
+
+struct RecordedInput {
+    uint32_t ts;
+    TelemetryInput in;
+};
+
+struct ReplayOptions {
+    const char* path = nullptr;
+    const char* outPath = nullptr;
+    bool check = false;
+    bool trips = false;
+    bool verbose = false;
+};
+
+// 读出文件里全部有效帧，其余字节 (文本日志) 跳过
+static std::vector<Frame> readFrames(FILE* in, unsigned long& seqGaps) {
+    std::vector<uint8_t> buf;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0) buf.insert(buf.end(), chunk, chunk + n);
+
+    std::vector<Frame> frames;
+    bool haveSeq = false;
+    uint8_t lastSeq = 0;
+    seqGaps = 0;
+    size_t i = 0;
+    while (i < buf.size()) {
+        uint32_t size = telemetryFrameSize(&buf[i], (uint32_t)(buf.size() - i));
+        if (size == 0) {
+            i++;
+            continue;
+        }
+        Frame f;
+        f.len = buf[i + 1];
+        f.type = buf[i + 2];
+        f.seq = buf[i + 3];
+        memcpy(&f.ts, &buf[i + 4], sizeof(f.ts));
+        memcpy(f.payload, &buf[i + TLM_HEADER_SIZE], f.len);
+        i += size;
+        if (f.type == TLM_FLIGHT_HEADER || f.type == TLM_FLIGHT_SAMPLE) continue;
+        if (f.type == TLM_BOOT) haveSeq = false;
+        if (haveSeq && f.seq != (uint8_t)(lastSeq + 1)) seqGaps += (uint8_t)(f.seq - lastSeq - 1);
+        lastSeq = f.seq;
+        haveSeq = true;
+        frames.push_back(f);
+    }
+    return frames;
+}
+
+// 与 SmartElevator.ino 的 applyCommand 一致；录制开关和基准测试不影响状态机
+static void applyCommand(uint8_t type, int16_t arg) {
+    switch (type) {
+        case CMD_GO_FLOOR:       hoist.commandGoFloor((uint8_t)arg); break;
+        case CMD_EMERGENCY_STOP: hoist.emergencyStop(); break;
+        case CMD_DEMO_START:
+            maintenance.resetHistory();
+            maintenance.generateDemoData();
+            break;
+        case CMD_DEMO_INJECT:    maintenance.injectDemoData(arg); break;
+        default: break;
+    }
+}
+
+static void applyInput(const RecordedInput& r) {
+    const TelemetryInput& in = r.in;
+    // 回放的遥测里也带上输入 (在它引起的状态帧之前)，两边用同样的方式分析
+    telemetry.input((TelemetryInputKind)in.kind, in.a, in.arg, in.value);
+    switch (in.kind) {
+        case INPUT_COMMAND:
+            applyCommand(in.a, in.arg);
+            break;
+        case INPUT_TOP_LIMIT:
+            replaySetTopLimit(in.a != 0);
+            break;
+        case INPUT_SENSOR: {
+            UltrasonicState s = {};
+            s.distanceMm = in.value;
+            s.health = (SensorHealth)in.a;
+            s.confidence = 100;
+            s.timestampMs = r.ts - in.arg;
+            replaySetSensor(s);
+            break;
+        }
+        case INPUT_CURRENT: {
+            MotorCurrentState c = {};
+            c.rmsMa = (uint32_t)in.arg;
+            c.peakMa = (uint32_t)in.value;
+            c.overCurrent = (in.a & 2) != 0;
+            c.timestampMs = r.ts;
+            replaySetCurrent((in.a & 1) != 0, c);
+            break;
+        }
+    }
+}
+
+static bool settled() {
+    SystemState s = hoist.getState();
+    return s != STATE_CALIBRATING && s != STATE_MOVING_UP && s != STATE_MOVING_DOWN &&
+           hoist.getPendingStops() == 0 && !motionIsRunning();
+}
+
+static void printState(const char* side, const StateRecord& r) {
+    printf("    %-8s %10.3f %-7s -> %-7s %-15s floor=%-6s pos=%ld detail=%ld\n", side, r.ts / 1000.0,
+           telemetryStateName(r.st.from), telemetryStateName(r.st.to), telemetryReasonName(r.st.reason),
+           floorName(r.st.floor), (long)r.st.positionMs, (long)r.st.detail);
+}
+
+// 逐条比对状态帧，返回不一致的条数 (多出来 / 缺少的也算)
+static size_t compareStates(const std::vector<StateRecord>& recorded, const std::vector<StateRecord>& replayed) {
+    size_t count = recorded.size() > replayed.size() ? recorded.size() : replayed.size();
+    size_t differ = 0;
+    for (size_t i = 0; i < count; i++) {
+        bool haveRec = i < recorded.size(), haveRep = i < replayed.size();
+        if (haveRec && haveRep && recorded[i].ts == replayed[i].ts &&
+            memcmp(&recorded[i].st, &replayed[i].st, sizeof(TelemetryState)) == 0) {
+            continue;
+        }
+        if (differ++ < 5) {
+            printf("  #%zu differs:\n", i);
+            if (haveRec) printState("recorded", recorded[i]);
+            if (haveRep) printState("replayed", replayed[i]);
+        }
+    }
+    return differ;
+}
+
+static int replay(const ReplayOptions& opt) {
+    FILE* in = fopen(opt.path, "rb");
+    if (!in) {
+        perror(opt.path);
+        return 2;
+    }
+    unsigned long seqGaps = 0;
+    std::vector<Frame> frames = readFrames(in, seqGaps);
+    fclose(in);
+
+    // 起点：第一个输入之前最后一次上电；没有的话从第一个输入开始 warm start。
+    // 之后再有上电 (时间戳从 0 重新开始) 就到此为止
+    size_t first = 0;
+    while (first < frames.size() && frames[first].type != TLM_INPUT) first++;
+    if (first == frames.size()) {
+        fprintf(stderr, "%s: no input frames (record with serial 'R' or elevator_sim --record)\n", opt.path);
+        return 2;
+    }
+    size_t begin = first;
+    bool coldBoot = false;
+    long warmPositionMs = -1;
+    for (size_t i = 0; i < first; i++) {
+        if (frames[i].type == TLM_BOOT) {
+            begin = i;
+            coldBoot = true;
+            warmPositionMs = -1;
+        } else if (frames[i].type == TLM_STATE && frames[i].len >= sizeof(TelemetryState)) {
+            TelemetryState st;
+            memcpy(&st, frames[i].payload, sizeof(st));
+            warmPositionMs = st.to == STATE_IDLE ? st.positionMs : -1;
+        }
+    }
+    if (!coldBoot) begin = first;
+    size_t end = begin + 1;
+    while (end < frames.size() && frames[end].type != TLM_BOOT) end++;
+
+    uint32_t startMs = frames[begin].ts;
+    uint32_t endMs = frames[end - 1].ts;
+    std::vector<RecordedInput> inputs;
+    CaptureReport recorded;
+    recorded.verbose = opt.trips;
+    if (opt.trips) printf("--- recorded trips ---\n");
+    for (size_t i = begin; i < end; i++) {
+        const Frame& f = frames[i];
+        recorded.frame(f.type, f.ts, f.payload, f.len);
+        if (f.type != TLM_INPUT || f.len < sizeof(TelemetryInput)) continue;
+        RecordedInput r;
+        r.ts = f.ts;
+        memcpy(&r.in, f.payload, sizeof(r.in));
+        inputs.push_back(r);
+    }
+
+    // 回放：与 SimRig / 控制任务相同的上电顺序，只是硬件换成录制
+    simSerialQuiet(!opt.verbose);
+    char* outBuf = nullptr;
+    size_t outSize = 0;
+    FILE* out = open_memstream(&outBuf, &outSize);
+    simSerialCapture(out);
+    simSkipUs((int64_t)startMs * 1000);
+    setupHardware();
+    setupMotionTimer();
+    telemetry.begin();
+    maintenance.begin();
+    hoist.bindMaintenanceManager(&maintenance);
+    hoist.begin();
+    if (!coldBoot && warmPositionMs >= 0) hoist.warmStart(warmPositionMs, 0);
+
+    size_t next = 0;
+    const unsigned long tailMs = MAX_SAFE_POSITION_MS * 2; // 最后一个输入之后，最多再等这么久停稳
+    for (;;) {
+        uint32_t now = millis();
+        while (next < inputs.size() && inputs[next].ts <= now) applyInput(inputs[next++]);
+        hoist.update();
+        SystemState state = hoist.getState();
+        maintenance.update(state == STATE_IDLE || state == STATE_POS_UNKNOWN);
+        maintenance.service();
+        telemetry.drain();
+
+        bool idle = settled();
+        long afterEnd = (long)now - (long)endMs;
+        if (next >= inputs.size() && ((idle && afterEnd >= 0) || afterEnd > (long)tailMs)) break;
+        simAdvanceUs((int64_t)CONTROL_TASK_PERIOD_MS * 1000);
+        // 静止时快进到下一个输入 (最多 1s 跑一个周期)，与 SimRig::idleFor 一样
+        if (idle) {
+            uint32_t target = next < inputs.size() ? inputs[next].ts : endMs;
+            long gap = (long)target - (long)millis();
+            if (gap > 0) simSkipUs((int64_t)(gap < 1000 ? gap : 1000) * 1000);
+        }
+    }
+    fclose(out);
+
+    CaptureReport replayed;
+    std::vector<uint8_t> stream(outBuf, outBuf + outSize);
+    free(outBuf);
+    if (opt.outPath) {
+        FILE* f = fopen(opt.outPath, "wb");
+        if (f) {
+            fwrite(stream.data(), 1, stream.size(), f);
+            fclose(f);
+        }
+    }
+    if (opt.trips) printf("--- replayed trips ---\n");
+    replayed.verbose = opt.trips;
+    for (size_t i = 0; i < stream.size();) {
+        uint32_t size = telemetryFrameSize(&stream[i], (uint32_t)(stream.size() - i));
+        if (size == 0) {
+            i++;
+            continue;
+        }
+        uint32_t ts;
+        memcpy(&ts, &stream[i + 4], sizeof(ts));
+        replayed.frame(stream[i + 2], ts, &stream[i + TLM_HEADER_SIZE], stream[i + 1]);
+        i += size;
+    }
+    // warm start 的那一条是回放自己的起点，录制里没有
+    if (!coldBoot && !replayed.states.empty() && replayed.states.front().st.reason == REASON_WARM_START) {
+        replayed.states.erase(replayed.states.begin());
+    }
+
+    printf("replay %s: %zu inputs, %.1f s, start %s", opt.path, inputs.size(), (endMs - startMs) / 1000.0,
+           coldBoot ? "at boot" : (warmPositionMs >= 0 ? "warm" : "position unknown"));
+    if (!coldBoot && warmPositionMs >= 0) printf(" at %ld ms", warmPositionMs);
+    printf("\n");
+    if (end < frames.size()) printf("note: the capture reboots at frame %zu; replayed up to there\n", end);
+    if (seqGaps) printf("warning: capture lost %lu frame(s); the replay may diverge\n", seqGaps);
+    recorded.print("Recorded");
+    replayed.print("Replayed");
+
+    printf("\n=== State frames: recorded %zu, replayed %zu ===\n", recorded.states.size(), replayed.states.size());
+    size_t differ = compareStates(recorded.states, replayed.states);
+    if (differ) printf("  %zu frame(s) differ\n", differ);
+    else printf("  identical\n");
+    return opt.check && differ ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    ReplayOptions opt;
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        if (!strcmp(a, "--check")) opt.check = true;
+        else if (!strcmp(a, "--trips")) opt.trips = true;
+        else if (!strcmp(a, "--verbose")) opt.verbose = true;
+        else if (!strcmp(a, "--out") && i + 1 < argc) opt.outPath = argv[++i];
+        else if (a[0] != '-' && !opt.path) opt.path = a;
+        else {
+            opt.path = nullptr;
+            break;
+        }
+    }
+    if (!opt.path) {
+        fprintf(stderr, "usage: %s [--check] [--trips] [--out FILE] [--verbose] CAPTURE\n", argv[0]);
+        return 2;
+    }
+    return replay(opt);
+}
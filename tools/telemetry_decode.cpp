@@ -0,0 +1,291 @@
+/*
+ * 遥测解码工具 (主机端)
+ * 把固件串口输出的二进制遥测帧 (TelemetryFormat.h) 还原成文本或 CSV。
+ * 不是遥测帧的字节 (启动日志、printf 文本) 原样按行输出，CRC 不对的帧跳过并计数。
+ * 飞行记录 (串口 'F' 导出) 按采样逐行输出，文本模式下附带位置条形图，便于直接看出卡滞/过冲。
+ *
+ * --report 分析录制模式 (串口 'R') 下的输入与状态切换：每段行程的启动延迟、耗时、停点偏差，
+ * 急停/到顶判断到停机的延迟，以及各状态切换的次数 (CaptureReport.h)。
+ * 要在改过的状态机上重新跑同一份录制做对比，用 tools/replay_runner。
+ *
+ * 编译：g++ -std=c++17 -O2 -o telemetry_decode tools/telemetry_decode.cpp
+ * 用法：telemetry_decode [--csv | --report] [文件]      (不给文件时读 stdin)
+ *   例：stty -F /dev/ttyUSB0 115200 raw && telemetry_decode --csv < /dev/ttyUSB0 > trace.csv
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <vector>
+#include <map>
+#include <string>
+#include "../Config.h"
+#include "../TelemetryFormat.h"
+#include "CaptureReport.h"
+
+struct DecodeStats {
+    unsigned long frames = 0;
+    unsigned long crcErrors = 0;
+    unsigned long seqGaps = 0;   // 丢失的帧 (按 seq 推算)
+    unsigned long dropped = 0;   // 固件上报的缓冲区满丢帧
+};
+
+static bool g_csv = false;
+static bool g_report = false;
+static CaptureReport g_rep;
+
+static DecodeStats g_stats;
+static std::vector<char> g_text; // 当前文本行
+
+static void flushText() {
+    if (g_text.empty()) return;
+    if (!g_csv && !g_report) printf("# %.*s\n", (int)g_text.size(), g_text.data());
+    g_text.clear();
+}
+
+static void textByte(uint8_t c) {
+    if (c == '\n') {
+        flushText();
+    } else if (c != '\r') {
+        g_text.push_back((char)c);
+    }
+}
+
+// 位置条形图：0 (顶) 在左，MAX_SAFE_POSITION_MS 在右
+static void positionBar(long positionMs, char* out, int width) {
+    for (int i = 0; i < width; i++) out[i] = ' ';
+    out[width] = '\0';
+    if (positionMs < 0) {
+        out[0] = '?';
+        return;
+    }
+    long col = positionMs * (width - 1) / (long)MAX_SAFE_POSITION_MS;
+    if (col >= width) col = width - 1;
+    for (int f = 0; f < FLOOR_COUNT; f++) {
+        out[FLOOR_TABLE[f].positionMs * (width - 1) / MAX_SAFE_POSITION_MS] = '|';
+    }
+    out[col] = '#';
+}
+
+static void printFrame(uint8_t type, uint32_t ts, const uint8_t* payload, uint8_t len) {
+    switch (type) {
+        case TLM_BOOT: {
+            if (len < sizeof(TelemetryBoot)) break;
+            TelemetryBoot p;
+            memcpy(&p, payload, sizeof(p));
+            if (g_csv) printf("%lu,boot,%u,%u\n", (unsigned long)ts, p.resetReason, p.floorCount);
+            else printf("%10.3f BOOT reset_reason=%u floors=%u\n", ts / 1000.0, p.resetReason, p.floorCount);
+            return;
+        }
+        case TLM_STATE: {
+            if (len < sizeof(TelemetryState)) break;
+            TelemetryState p;
+            memcpy(&p, payload, sizeof(p));
+            if (g_csv) {
+                printf("%lu,state,%s,%s,%s,%s,%ld,%ld\n", (unsigned long)ts,
+                       telemetryStateName(p.from), telemetryStateName(p.to),
+                       telemetryReasonName(p.reason), floorName(p.floor),
+                       (long)p.positionMs, (long)p.detail);
+            } else {
+                printf("%10.3f STATE %-7s -> %-7s %-15s floor=%-6s pos=%ld ms detail=%ld\n", ts / 1000.0,
+                       telemetryStateName(p.from), telemetryStateName(p.to),
+                       telemetryReasonName(p.reason), floorName(p.floor),
+                       (long)p.positionMs, (long)p.detail);
+            }
+            return;
+        }
+        case TLM_STATUS: {
+            if (len < sizeof(TelemetryStatus)) break;
+            TelemetryStatus p;
+            memcpy(&p, payload, sizeof(p));
+            g_stats.dropped += p.dropped;
+            if (g_csv) {
+                printf("%lu,status,%s,%u,%u,%u,%ld,%d,%u\n", (unsigned long)ts,
+                       telemetryStateName(p.state), p.topLimit, p.pendingStops, p.sensorHealth,
+                       (long)p.positionMs, p.distanceMm, p.dropped);
+            } else {
+                printf("%10.3f STATUS %-7s pos=%ld ms limit=%s dist=%d mm health=%u queue=%u%s\n", ts / 1000.0,
+                       telemetryStateName(p.state), (long)p.positionMs, p.topLimit ? "HIT" : "OPEN",
+                       p.distanceMm, p.sensorHealth, p.pendingStops, p.dropped ? " (frames dropped)" : "");
+            }
+            return;
+        }
+        case TLM_RUN: {
+            if (len < sizeof(TelemetryRun)) break;
+            TelemetryRun p;
+            memcpy(&p, payload, sizeof(p));
+            if (g_csv) {
+                printf("%lu,run,%ld,%lu,%ld,%ld\n", (unsigned long)ts, (long)p.durationMs,
+                       (unsigned long)p.runCount, (long)p.acuteLimitMs, (long)p.currentMa);
+            } else {
+                printf("%10.3f RUN duration=%ld ms runs=%lu acute_limit=%ld ms current=%ld mA\n", ts / 1000.0,
+                       (long)p.durationMs, (unsigned long)p.runCount, (long)p.acuteLimitMs, (long)p.currentMa);
+            }
+            return;
+        }
+        case TLM_WEAR: {
+            if (len < sizeof(TelemetryWear)) break;
+            TelemetryWear p;
+            memcpy(&p, payload, sizeof(p));
+            if (g_csv) {
+                printf("%lu,wear,%lu,%u,%ld,%u,%.3f,%u,%ld,%u,%.3f,%ld\n", (unsigned long)ts,
+                       (unsigned long)p.runCount, p.shortCount, (long)p.meanShortMs, p.stddevShortMs,
+                       p.slopeShortQ16 / 65536.0, p.mediumCount, (long)p.meanMediumMs, p.stddevMediumMs,
+                       p.slopeMediumQ16 / 65536.0, (long)p.meanAllMs);
+            } else {
+                printf("%10.3f WEAR runs=%lu last%u: mean=%ld sd=%u slope=%.2f ms/run"
+                       " last%u: mean=%ld sd=%u slope=%.2f ms/run all: mean=%ld ms\n", ts / 1000.0,
+                       (unsigned long)p.runCount, p.shortCount, (long)p.meanShortMs, p.stddevShortMs,
+                       p.slopeShortQ16 / 65536.0, p.mediumCount, (long)p.meanMediumMs, p.stddevMediumMs,
+                       p.slopeMediumQ16 / 65536.0, (long)p.meanAllMs);
+            }
+            return;
+        }
+        case TLM_INPUT: {
+            if (len < sizeof(TelemetryInput)) break;
+            TelemetryInput p;
+            memcpy(&p, payload, sizeof(p));
+            const char* kind = telemetryInputName(p.kind);
+            if (g_csv) {
+                printf("%lu,input,%s,%u,%d,%ld\n", (unsigned long)ts, kind, p.a, p.arg, (long)p.value);
+            } else if (p.kind == INPUT_COMMAND) {
+                printf("%10.3f INPUT %s %s arg=%d\n", ts / 1000.0, kind, commandName(p.a), p.arg);
+            } else {
+                printf("%10.3f INPUT %s %u arg=%d value=%ld\n", ts / 1000.0, kind, p.a, p.arg, (long)p.value);
+            }
+            return;
+        }
+        case TLM_EVENT: {
+            if (len < sizeof(TelemetryEvent)) break;
+            TelemetryEvent p;
+            memcpy(&p, payload, sizeof(p));
+            if (g_csv) {
+                printf("%lu,event,%s,%u,%d,%ld\n", (unsigned long)ts, telemetryEventName(p.kind), p.a, p.arg,
+                       (long)p.value);
+                return;
+            }
+            printf("%10.3f EVENT %s ", ts / 1000.0, telemetryEventName(p.kind));
+            switch (p.kind) {
+                case EVENT_TRANSITION_REJECTED:
+                    printf("%s -> %s\n", telemetryStateName(p.a), telemetryStateName(p.arg));
+                    break;
+                case EVENT_REHOME_FIRST:
+                    printf("floor=%s travel=%ld ms\n", floorName(p.a), (long)p.value);
+                    break;
+                case EVENT_STOP_ON_THE_WAY:
+                    printf("floor=%s was=%s\n", floorName(p.a), floorName(p.arg));
+                    break;
+                case EVENT_UP_RATE:
+                    printf("pwm=%u rate=%.3f\n", p.a, p.value / 65536.0);
+                    break;
+                case EVENT_FLIGHT_SAVED:
+                    printf("reason=%s samples=%d\n", telemetryReasonName(p.a), p.arg);
+                    break;
+                case EVENT_CURRENT_LOST:
+                    printf("state=%s after=%ld ms\n", telemetryStateName(p.a), (long)p.value);
+                    break;
+                default:
+                    printf("a=%u arg=%d value=%ld\n", p.a, p.arg, (long)p.value);
+                    break;
+            }
+            return;
+        }
+        case TLM_FLIGHT_HEADER: {
+            if (len < sizeof(FlightHeader)) break;
+            FlightHeader p;
+            memcpy(&p, payload, sizeof(p));
+            if (g_csv) {
+                printf("%lu,flight_header,%s,%s,%u,%u\n", (unsigned long)p.triggerMs,
+                       telemetryReasonName(p.reason), telemetryStateName(p.fromState), p.count, p.strideCycles);
+            } else {
+                printf("=== Flight record: %s -> ERROR (%s) at %.3f s, %u samples every %u cycles ===\n",
+                       telemetryStateName(p.fromState), telemetryReasonName(p.reason),
+                       p.triggerMs / 1000.0, p.count, p.strideCycles);
+            }
+            return;
+        }
+        case TLM_FLIGHT_SAMPLE: {
+            if (len < sizeof(FlightSample)) break;
+            FlightSample p;
+            memcpy(&p, payload, sizeof(p));
+            if (g_csv) {
+                printf("%lu,flight,%s,%ld,%d,%u\n", (unsigned long)p.timestampMs,
+                       telemetryStateName(p.state), (long)p.positionMs, p.distanceMm, p.duty);
+            } else {
+                char bar[41];
+                positionBar(p.positionMs, bar, 40);
+                printf("%10.3f %-7s pos=%7ld dist=%5d duty=%3u [%s]\n", p.timestampMs / 1000.0,
+                       telemetryStateName(p.state), (long)p.positionMs, p.distanceMm, p.duty, bar);
+            }
+            return;
+        }
+    }
+    if (!g_csv) printf("%10.3f UNKNOWN type=%u len=%u\n", ts / 1000.0, type, len);
+}
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--csv") == 0) g_csv = true;
+        else if (strcmp(argv[i], "--report") == 0) g_report = true;
+        else path = argv[i];
+    }
+    FILE* in = path ? fopen(path, "rb") : stdin;
+    if (!in) {
+        perror(path);
+        return 1;
+    }
+
+    if (g_csv) printf("timestamp_ms,type,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10\n");
+
+    // 读入全部字节，逐个位置尝试解析帧；不是帧的字节按文本处理
+    std::vector<uint8_t> buf;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0) buf.insert(buf.end(), chunk, chunk + n);
+    if (in != stdin) fclose(in);
+
+    bool haveSeq = false;
+    uint8_t lastSeq = 0;
+    size_t i = 0;
+    while (i < buf.size()) {
+        if (buf[i] != TLM_SYNC || i + TLM_HEADER_SIZE + 1 > buf.size()) {
+            textByte(buf[i++]);
+            continue;
+        }
+        uint8_t len = buf[i + 1];
+        size_t size = TLM_HEADER_SIZE + len + 1;
+        if (len > TLM_MAX_PAYLOAD || i + size > buf.size() ||
+            telemetryCrc8(&buf[i + 1], (uint32_t)(size - 2)) != buf[i + size - 1]) {
+            // 同步字节后面不是一个完整的有效帧
+            if (len <= TLM_MAX_PAYLOAD && i + size <= buf.size()) g_stats.crcErrors++;
+            textByte(buf[i++]);
+            continue;
+        }
+
+        flushText();
+        uint8_t type = buf[i + 2];
+        uint8_t seq = buf[i + 3];
+        // 飞行记录导出有自己的序号，不参与实时流的丢帧统计
+        if (type != TLM_FLIGHT_HEADER && type != TLM_FLIGHT_SAMPLE) {
+            if (type == TLM_BOOT) haveSeq = false; // 重启后 seq 从 0 开始
+            if (haveSeq && seq != (uint8_t)(lastSeq + 1)) g_stats.seqGaps += (uint8_t)(seq - lastSeq - 1);
+            lastSeq = seq;
+            haveSeq = true;
+        }
+
+        uint32_t ts;
+        memcpy(&ts, &buf[i + 4], sizeof(ts));
+        if (g_report) g_rep.frame(type, ts, &buf[i + TLM_HEADER_SIZE], len);
+        else printFrame(type, ts, &buf[i + TLM_HEADER_SIZE], len);
+        g_stats.frames++;
+        i += size;
+    }
+    flushText();
+    if (g_report) g_rep.print("Replay report");
+
+    fprintf(stderr, "frames=%lu crc_errors=%lu seq_gaps=%lu dropped_on_device=%lu\n",
+            g_stats.frames, g_stats.crcErrors, g_stats.seqGaps, g_stats.dropped);
+    return 0;
+}
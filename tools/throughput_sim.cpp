@@ -0,0 +1,236 @@
+/*
+ * 运货吞吐量仿真 (主机端)：FIFO vs SCAN
+ * 在仿真硬件上按泊松过程随机产生楼层请求 (每个请求是一次运货：把吊篮叫到某一层)，比较两种派发方式：
+ *   FIFO  原来的用法：外部按到达顺序排队，吊篮停下后才发下一条，每条单独跑一趟
+ *   SCAN  请求到达即交给状态机 (TripPlanner)：重复请求合并、顺路先停、按扫描方向排序
+ * 吊篮在某层停稳时，已交给状态机的该层请求都算完成。
+ * 报告每小时完成的请求数 (moves/h)、每小时运行段数和平均 / 最大等待时间 (到达 -> 完成)。
+ * 每种方式放进一个子进程 (仿真硬件和定时器是进程内的全局状态)，两者用同一串请求。
+ * 负载没到饱和时两种方式都跟得上，moves/h 就是到达率，差别在运行段数和等待时间；
+ * 80 次/h 时 FIFO 跟不上，队列越积越长，跑得越久 SCAN 多完成的比例越大 (2 h 约 +3%，4 h 约 +16%)。
+ *
+ * 编译：make -C sim          (生成 sim/build/throughput_sim)
+ * 用法：throughput_sim [--hours H] [--seed S] [--load KG] [--check] [--verbose]
+ *   --check  判定 (make -C sim test 用，默认 4 h、种子 1)：每档 SCAN 完成数不少于 FIFO、运行段数不多于 FIFO；
+ *            最高一档 SCAN 多完成至少 THROUGHPUT_MIN_GAIN_PCT，平均等待更短
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <deque>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../sim/SimRig.h"
+
+TelemetryLog telemetry;
+
+// --check 时最高一档 (FIFO 已饱和) 要求的最小增益
+static const double THROUGHPUT_MIN_GAIN_PCT = 10;
+
+static SimRig rig;
+
+enum Dispatch { DISPATCH_FIFO, DISPATCH_SCAN };
+
+struct Request {
+    unsigned long arriveMs;
+    uint8_t floor;
+};
+
+struct ThroughputOptions {
+    double hours = 4;
+    uint32_t seed = 1;
+    SimParams params = simDefaultParams();
+    bool check = false;
+    bool verbose = false;
+};
+
+struct ThroughputResult {
+    int served = 0;
+    int stops = 0;
+    int faults = 0;
+    double sumWaitS = 0;
+    double maxWaitS = 0;
+};
+
+// 泊松到达，楼层均匀分布；两种方式用同一个种子，请求序列完全相同
+static std::vector<Request> makeRequests(double perHour, double hours, uint32_t seed) {
+    std::vector<Request> out;
+    simRandomSeed(seed);
+    double t = 0;
+    for (;;) {
+        double u = (random(1, 1000001)) / 1000001.0;
+        t += -log(u) * 3600.0 / perHour;
+        if (t >= hours * 3600) break;
+        out.push_back({ (unsigned long)(t * 1000), (uint8_t)random(FLOOR_COUNT) });
+    }
+    return out;
+}
+
+// 吊篮停在 floor 了吗 (顶层靠传感器停，位置即 0)
+static bool stoppedAt(uint8_t floor) {
+    long pos = rig.hoist.getCurrentPosition();
+    return pos >= 0 && labs(pos - (long)floorPositionMs(floor)) <= (long)floorSpec(floor).toleranceMs * 2;
+}
+
+static ThroughputResult runDispatch(Dispatch mode, const std::vector<Request>& requests,
+                                    const ThroughputOptions& opt) {
+    simSerialQuiet(!opt.verbose);
+    rig.begin(opt.params);
+    rig.runUntilSettled(MAX_SAFE_POSITION_MS * 2);
+    // 先跑一趟下去再回来，学到上升速度比 (与现场运行一段时间后的状态一致)
+    rig.hoist.commandGoFloor(FLOOR_BOTTOM);
+    rig.runUntilSettled(MAX_SAFE_POSITION_MS * 2);
+    rig.hoist.commandGoFloor(FLOOR_TOP);
+    rig.runUntilSettled(MAX_SAFE_POSITION_MS * 2);
+
+    ThroughputResult result;
+    std::deque<Request> waiting;  // FIFO：还没发给状态机的
+    std::deque<Request> issued;   // 已发给状态机、等待完成的
+    size_t next = 0;
+    unsigned long base = millis();
+    unsigned long endMs = base + (unsigned long)(opt.hours * 3600 * 1000);
+    uint8_t lastTarget = rig.hoist.getTargetFloor();
+    bool lastMoving = false;
+
+    auto complete = [&](uint8_t floor) {
+        result.stops++;
+        for (auto it = issued.begin(); it != issued.end();) {
+            if (it->floor != floor) {
+                ++it;
+                continue;
+            }
+            double waitS = (millis() - base - it->arriveMs) / 1000.0;
+            result.served++;
+            result.sumWaitS += waitS;
+            if (waitS > result.maxWaitS) result.maxWaitS = waitS;
+            it = issued.erase(it);
+        }
+    };
+
+    while (millis() < endMs) {
+        // 到达的请求
+        while (next < requests.size() && requests[next].arriveMs <= millis() - base) {
+            if (mode == DISPATCH_SCAN) {
+                issued.push_back(requests[next]);
+                rig.hoist.commandGoFloor(requests[next].floor);
+            } else {
+                waiting.push_back(requests[next]);
+            }
+            next++;
+        }
+        // FIFO：停稳后才发下一条
+        if (mode == DISPATCH_FIFO && rig.settled() && issued.empty() && !waiting.empty()) {
+            issued.push_back(waiting.front());
+            waiting.pop_front();
+            rig.hoist.commandGoFloor(issued.back().floor);
+        }
+
+        bool moving = !rig.settled();
+        if (moving || !issued.empty()) {
+            rig.cycle();
+        } else {
+            rig.idleFor(1000); // 空闲时快进，按秒检查到达
+        }
+
+        if (rig.hoist.getState() == STATE_ERROR) {
+            result.faults++;
+            issued.clear();
+            rig.hoist.commandGoFloor(FLOOR_TOP); // 人工恢复：重新归零
+            continue;
+        }
+        // 一段运行结束：停稳，或者停下后立即出发去了下一个目标 (同一个周期内)
+        uint8_t target = rig.hoist.getTargetFloor();
+        bool nowMoving = !rig.settled();
+        if (lastMoving && !nowMoving && stoppedAt(target)) {
+            complete(target);
+        } else if (lastMoving && target != lastTarget && lastTarget < FLOOR_COUNT && stoppedAt(lastTarget)) {
+            complete(lastTarget);
+        } else if (!lastMoving && !nowMoving && !issued.empty() && stoppedAt(issued.front().floor) &&
+                   rig.hoist.getPendingStops() == 0) {
+            complete(issued.front().floor); // 已经在该层：原地完成
+        }
+        lastTarget = target;
+        lastMoving = nowMoving;
+    }
+    return result;
+}
+
+static void printResult(const char* name, const ThroughputResult& r, double hours) {
+    printf("  %-5s %9.1f %9.1f %10.1f %10.1f %7d\n", name, r.served / hours, r.stops / hours,
+           r.served ? r.sumWaitS / r.served : 0.0, r.maxWaitS, r.faults);
+}
+
+// 子进程里跑一种方式，结果通过管道传回
+static bool runInChild(Dispatch mode, const std::vector<Request>& requests, const ThroughputOptions& opt,
+                       ThroughputResult& out) {
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        ThroughputResult r = runDispatch(mode, requests, opt);
+        ssize_t written = write(fds[1], &r, sizeof(r));
+        _exit(written == (ssize_t)sizeof(r) ? 0 : 1);
+    }
+    close(fds[1]);
+    ssize_t got = read(fds[0], &out, sizeof(out));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return got == (ssize_t)sizeof(out) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, char** argv) {
+    ThroughputOptions opt;
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(a, "--verbose")) opt.verbose = true;
+        else if (!strcmp(a, "--check")) opt.check = true;
+        else if (!strcmp(a, "--hours") && hasValue) opt.hours = atof(argv[++i]);
+        else if (!strcmp(a, "--seed") && hasValue) opt.seed = strtoul(argv[++i], nullptr, 0);
+        else if (!strcmp(a, "--load") && hasValue) opt.params.loadKg = atof(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--hours H] [--seed S] [--load KG] [--check] [--verbose]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    static const double rates[] = { 10, 20, 40, 80 };
+    const int rateCount = sizeof(rates) / sizeof(rates[0]);
+    printf("throughput: %.1f h per run, load %.1f kg, seed %lu\n", opt.hours, opt.params.loadKg,
+           (unsigned long)opt.seed);
+    int failed = 0;
+    for (int r = 0; r < rateCount; r++) {
+        double rate = rates[r];
+        std::vector<Request> requests = makeRequests(rate, opt.hours, opt.seed);
+        ThroughputResult fifo, scan;
+        if (!runInChild(DISPATCH_FIFO, requests, opt, fifo) || !runInChild(DISPATCH_SCAN, requests, opt, scan)) {
+            fprintf(stderr, "simulation failed at %.0f requests/h\n", rate);
+            return 1;
+        }
+        printf("%.0f requests/h (%zu offered)\n", rate, requests.size());
+        printf("  mode   moves/h   stops/h  mean_wait_s  max_wait_s  faults\n");
+        printResult("FIFO", fifo, opt.hours);
+        printResult("SCAN", scan, opt.hours);
+        double gainPct = fifo.served ? (scan.served - fifo.served) * 100.0 / fifo.served : 0;
+        if (fifo.served) printf("  SCAN/FIFO moves: %+.0f%%\n", gainPct);
+        if (fifo.faults || scan.faults) failed++;
+        if (!opt.check) continue;
+
+        bool ok = scan.served >= fifo.served && scan.stops <= fifo.stops;
+        if (r == rateCount - 1) {
+            ok = ok && gainPct >= THROUGHPUT_MIN_GAIN_PCT && scan.stops < fifo.stops &&
+                 scan.sumWaitS / scan.served < fifo.sumWaitS / fifo.served;
+            printf("  check: moves gain >= %.0f%%, fewer runs, shorter mean wait: %s\n", THROUGHPUT_MIN_GAIN_PCT,
+                   ok ? "ok" : "FAIL");
+        } else {
+            printf("  check: moves >= FIFO, runs <= FIFO: %s\n", ok ? "ok" : "FAIL");
+        }
+        if (!ok) failed++;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,188 @@
+/*
+ * 超声波管线基准 (主机端)
+ * 按噪声模型生成带噪声的回波序列，分别送进原来的单样本判断 (有回波且距离 <= 限位即到顶)
+ * 和 UltrasonicFilter，统计：
+ *   - 误触发：真实距离在限位之外时判到顶的次数，折算成每小时次数 (停在限位外 PARK_MM 处)
+ *   - 检测延迟：以接近速度穿过限位后到第一次判到顶的时间 (均值 / 最大)，以及没判到的次数
+ *   - 拔掉传感器后判为 SENSOR_DEAD 的时间
+ * 噪声模型：有效回波叠加高斯噪声；一定比例的周期替换成量程内随机位置的尖峰 (多径反射)，
+ * 一定比例的周期没有回波。每行参数用同一个种子，结果可复现。
+ *
+ * 编译：make -C sim          (生成 sim/build/ultrasonic_bench)
+ * 用法：ultrasonic_bench [--hours H] [--trials N] [--seed S]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include "../UltrasonicFilter.h"
+
+static const double LIMIT_MM = SENSOR_DISTANCE_LIMIT * 10;
+static const double PARK_MM = LIMIT_MM + 150;   // 停在限位外 15 cm
+static const double APPROACH_MM_S = 30;         // 接近速度 (接近 PWM 下约 1.5-3 cm/s)
+static const double CYCLE_S = ULTRASONIC_PERIOD_US / 1e6;
+
+struct NoiseModel {
+    double sigmaMm;
+    double spikeRate;   // 每周期出现尖峰的概率
+    double dropRate;    // 每周期没有回波的概率
+};
+
+struct BenchOptions {
+    double hours = 2;
+    int trials = 200;
+    uint32_t seed = 1;
+};
+
+// 一个测量周期的分类和脉宽 (与 EchoCapture::finishCycle 的输出一致)
+struct Echo {
+    EchoKind kind;
+    uint32_t us;
+};
+
+class EchoSource {
+private:
+    std::mt19937 _rng;
+    NoiseModel _noise;
+
+    double uniform() { return std::uniform_real_distribution<double>(0, 1)(_rng); }
+
+public:
+    EchoSource(const NoiseModel& noise, uint32_t seed) : _rng(seed), _noise(noise) {}
+
+    Echo sample(double trueMm) {
+        if (uniform() < _noise.dropRate) return { ECHO_NONE, 0 };
+        double mm = uniform() < _noise.spikeRate ? 100 + uniform() * 900
+                                                 : trueMm + std::normal_distribution<double>(0, _noise.sigmaMm)(_rng);
+        if (mm < 20) mm = 20;
+        uint32_t us = (uint32_t)(mm * 2000 / 343);
+        if (us > ULTRASONIC_ECHO_TIMEOUT_US) return { ECHO_OUT_OF_RANGE, us };
+        return { ECHO_VALID, us };
+    }
+};
+
+// 原来的 isTopLimitPressed()：单个样本，pulseIn 超时 (返回 0) 视为没到顶
+static bool rawAtTop(const Echo& e) {
+    return e.kind == ECHO_VALID && UltrasonicFilter::echoToMm(e.us) <= LIMIT_MM;
+}
+
+struct Result {
+    double rawTripsPerHour = 0, filtTripsPerHour = 0;
+    double rawMeanMs = 0, rawMaxMs = 0, filtMeanMs = 0, filtMaxMs = 0;
+    int rawMissed = 0, filtMissed = 0;
+    double deadMs = 0;
+};
+
+// 停在限位外：每次从“未到顶”变为“到顶”算一次误触发
+static void benchParked(const NoiseModel& noise, const BenchOptions& opt, Result& r) {
+    EchoSource src(noise, opt.seed);
+    UltrasonicFilter filter;
+    long cycles = (long)(opt.hours * 3600 / CYCLE_S);
+    bool rawPrev = false, filtPrev = false;
+    long rawTrips = 0, filtTrips = 0;
+    for (long i = 0; i < cycles; i++) {
+        Echo e = src.sample(PARK_MM);
+        filter.push(e.kind, e.us, (unsigned long)(i * ULTRASONIC_PERIOD_US / 1000));
+        bool raw = rawAtTop(e);
+        bool filt = UltrasonicFilter::isAtTop(filter.state());
+        if (raw && !rawPrev) rawTrips++;
+        if (filt && !filtPrev) filtTrips++;
+        rawPrev = raw;
+        filtPrev = filt;
+    }
+    r.rawTripsPerHour = rawTrips / opt.hours;
+    r.filtTripsPerHour = filtTrips / opt.hours;
+}
+
+// 从限位外 300mm 匀速接近，穿过限位后最多等 3 秒
+static void benchApproach(const NoiseModel& noise, const BenchOptions& opt, Result& r) {
+    const int timeoutCycles = (int)(3 / CYCLE_S);
+    double rawSum = 0, filtSum = 0;
+    int rawHits = 0, filtHits = 0;
+    for (int t = 0; t < opt.trials; t++) {
+        EchoSource src(noise, opt.seed + 1 + t);
+        UltrasonicFilter filter;
+        double mm = LIMIT_MM + 300;
+        int crossed = -1, rawAt = -1, filtAt = -1;
+        for (int i = 0; crossed < 0 || i - crossed < timeoutCycles; i++) {
+            if (crossed < 0 && mm <= LIMIT_MM) crossed = i;
+            Echo e = src.sample(mm);
+            filter.push(e.kind, e.us, (unsigned long)(i * ULTRASONIC_PERIOD_US / 1000));
+            // 穿过之前的判到顶属于误触发，由 benchParked 统计，这里只看穿过之后
+            if (crossed >= 0 && rawAt < 0 && rawAtTop(e)) rawAt = i;
+            if (crossed >= 0 && filtAt < 0 && UltrasonicFilter::isAtTop(filter.state())) filtAt = i;
+            if (rawAt >= 0 && filtAt >= 0) break;
+            mm -= APPROACH_MM_S * CYCLE_S;
+        }
+        double rawMs = (rawAt - crossed) * CYCLE_S * 1000;
+        double filtMs = (filtAt - crossed) * CYCLE_S * 1000;
+        if (rawAt < 0) {
+            r.rawMissed++;
+        } else {
+            rawSum += rawMs;
+            rawHits++;
+            if (rawMs > r.rawMaxMs) r.rawMaxMs = rawMs;
+        }
+        if (filtAt < 0) {
+            r.filtMissed++;
+        } else {
+            filtSum += filtMs;
+            filtHits++;
+            if (filtMs > r.filtMaxMs) r.filtMaxMs = filtMs;
+        }
+    }
+    r.rawMeanMs = rawHits ? rawSum / rawHits : 0;
+    r.filtMeanMs = filtHits ? filtSum / filtHits : 0;
+}
+
+// 停在顶部时拔掉传感器：多久判为 SENSOR_DEAD
+static void benchUnplug(const NoiseModel& noise, const BenchOptions& opt, Result& r) {
+    EchoSource src(noise, opt.seed);
+    UltrasonicFilter filter;
+    int i = 0;
+    for (; i < 50; i++) {
+        Echo e = src.sample(LIMIT_MM - 80);
+        filter.push(e.kind, e.us, (unsigned long)(i * ULTRASONIC_PERIOD_US / 1000));
+    }
+    int unplugged = i;
+    while (filter.state().health != SENSOR_DEAD && i < unplugged + 100) {
+        filter.push(ECHO_NONE, 0, (unsigned long)(i * ULTRASONIC_PERIOD_US / 1000));
+        i++;
+    }
+    r.deadMs = (i - unplugged) * CYCLE_S * 1000;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions opt;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--hours") && hasValue) opt.hours = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--trials") && hasValue) opt.trials = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && hasValue) opt.seed = strtoul(argv[++i], nullptr, 0);
+        else {
+            fprintf(stderr, "usage: %s [--hours H] [--trials N] [--seed S]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    static const NoiseModel models[] = {
+        { 5, 0, 0 },          { 20, 0, 0.01 },      { 50, 0, 0.01 },
+        { 20, 0.02, 0.01 },   { 20, 0.10, 0.05 },   { 50, 0.10, 0.05 },
+    };
+
+    printf("ultrasonic bench: limit %.0f mm, parked at %.0f mm for %.1f h, %d approaches at %.0f mm/s\n",
+           LIMIT_MM, PARK_MM, opt.hours, opt.trials, APPROACH_MM_S);
+    printf("                         false trips/h       latency raw (ms)       latency filtered (ms)  dead\n");
+    printf(" sigma  spike  drop      raw   filtered    mean    max  missed     mean    max  missed   (ms)\n");
+    for (const NoiseModel& m : models) {
+        Result r;
+        benchParked(m, opt, r);
+        benchApproach(m, opt, r);
+        benchUnplug(m, opt, r);
+        printf("%6.0f %6.2f %5.2f %8.1f %10.1f %7.0f %6.0f %7d %8.0f %6.0f %7d %6.0f\n", m.sigmaMm, m.spikeRate,
+               m.dropRate, r.rawTripsPerHour, r.filtTripsPerHour, r.rawMeanMs, r.rawMaxMs, r.rawMissed,
+               r.filtMeanMs, r.filtMaxMs, r.filtMissed, r.deadMs);
+    }
+    return 0;
+}